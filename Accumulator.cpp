@@ -0,0 +1,119 @@
+#include "Accumulator.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+Accumulator::Accumulator(int width, int height) {
+    reset(width, height) ;
+}
+
+void Accumulator::reset(int width, int height) {
+    width_ = width ;
+    height_ = height ;
+    sum_.assign(3 * static_cast<size_t>(width) * height, 0.0f) ;
+    count_.assign(static_cast<size_t>(width) * height, 0) ;
+    sum_lum_.assign(static_cast<size_t>(width) * height, 0.0) ;
+    sum_lum2_.assign(static_cast<size_t>(width) * height, 0.0) ;
+    converged_.assign(static_cast<size_t>(width) * height, 0) ;
+    nb_active_ = width * height ;
+    nb_passes_ = 0 ;
+}
+
+void Accumulator::add_sample(int x, int y, const Material & color) {
+    size_t i = x + static_cast<size_t>(y) * width_ ;
+    sum_[3 * i] += color.get_r() ;
+    sum_[3 * i + 1] += color.get_g() ;
+    sum_[3 * i + 2] += color.get_b() ;
+    // Luminance de l'échantillon (coefficients Rec. 709), pour l'estimation de la variance
+    double lum = 0.2126 * color.get_r() + 0.7152 * color.get_g() + 0.0722 * color.get_b() ;
+    sum_lum_[i] += lum ;
+    sum_lum2_[i] += lum * lum ;
+    count_[i]++ ;
+}
+
+long long Accumulator::get_nb_samples() const {
+    long long total = 0 ;
+    for (size_t i = 0 ; i < count_.size() ; i++) {
+        total += count_[i] ;
+    }
+    return total ;
+}
+
+float Accumulator::get_error(int x, int y) const {
+    size_t i = x + static_cast<size_t>(y) * width_ ;
+    int n = count_[i] ;
+    if (n < 2) {
+        return std::numeric_limits<float>::infinity() ;
+    }
+    double moyenne = sum_lum_[i] / n ;
+    // Variance non biaisée des échantillons, puis variance de leur moyenne
+    double variance = std::max(0.0, (sum_lum2_[i] - moyenne * sum_lum_[i]) / (n - 1)) ;
+    double erreur = std::sqrt(variance / n) ;
+    // L'erreur est ramenée à l'image affichée, après correction gamma v = m^(1/2.2) :
+    // dv = dm * v / (2.2 m), c'est donc un écart en niveaux de 0 à 255
+    moyenne = std::max(moyenne, 1.0) ;
+    return static_cast<float>(erreur * std::pow(moyenne, 1 / 2.2) / (2.2 * moyenne)) ;
+}
+
+int Accumulator::retire_converged(float threshold, int min_samples, int tile_size) {
+    RT_TRACE("convergence") ;
+    for (int y0 = 0 ; y0 < height_ ; y0 += tile_size) {
+        for (int x0 = 0 ; x0 < width_ ; x0 += tile_size) {
+            int x1 = std::min(x0 + tile_size, width_) ;
+            int y1 = std::min(y0 + tile_size, height_) ;
+
+            // L'erreur de la tuile est la moyenne quadratique de l'erreur de ses pixels actifs :
+            // la variance d'un seul pixel, estimée sur peu d'échantillons, est trop peu fiable
+            double somme = 0.0 ;
+            int nb_pixels = 0 ;
+            bool pret = true ;
+            for (int y = y0 ; y < y1 && pret ; y++) {
+                for (int x = x0 ; x < x1 ; x++) {
+                    size_t i = x + static_cast<size_t>(y) * width_ ;
+                    if (converged_[i]) {
+                        continue ;
+                    }
+                    if (count_[i] < min_samples) {
+                        pret = false ;
+                        break ;
+                    }
+                    float erreur = get_error(x, y) ;
+                    somme += static_cast<double>(erreur) * erreur ;
+                    nb_pixels++ ;
+                }
+            }
+            if (!pret || nb_pixels == 0 || std::sqrt(somme / nb_pixels) >= threshold) {
+                continue ;
+            }
+
+            for (int y = y0 ; y < y1 ; y++) {
+                for (int x = x0 ; x < x1 ; x++) {
+                    size_t i = x + static_cast<size_t>(y) * width_ ;
+                    if (!converged_[i]) {
+                        converged_[i] = 1 ;
+                        nb_active_-- ;
+                    }
+                }
+            }
+        }
+    }
+    return nb_active_ ;
+}
+
+void Accumulator::resolve(Framebuffer & image) const {
+    RT_TRACE("moyenne des échantillons") ;
+    if (image.get_width() != width_ || image.get_height() != height_) {
+        image.resize(width_, height_) ;
+    }
+    for (int y = 0 ; y < height_ ; y++) {
+        for (int x = 0 ; x < width_ ; x++) {
+            size_t i = x + static_cast<size_t>(y) * width_ ;
+            float inv = (count_[i] > 0) ? 1.0f / count_[i] : 0.0f ;
+            float * p = image.get_pixel(x, y) ;
+            p[0] = sum_[3 * i] * inv ;
+            p[1] = sum_[3 * i + 1] * inv ;
+            p[2] = sum_[3 * i + 2] * inv ;
+        }
+    }
+}
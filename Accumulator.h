@@ -0,0 +1,177 @@
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+#include "Material.h"
+#include "Framebuffer.h"
+#include <vector>
+
+/**
+ * @brief La classe Accumulator accumule les échantillons successifs de chaque pixel pour le rendu progressif
+ * 
+ * Pour chaque pixel, on garde la somme des couleurs de ses échantillons et leur nombre, en flottants.
+ * L'image affichée est la moyenne des échantillons : elle s'affine à chaque passe, et on peut s'arrêter
+ * (ou reprendre) à n'importe quel nombre d'échantillons sans recommencer le calcul.
+ * 
+ * On garde aussi la somme de la luminance et de son carré, ce qui donne la variance de chaque pixel.
+ * En échantillonnage adaptatif, les tuiles dont l'erreur estimée est sous le seuil sont retirées et
+ * ne reçoivent plus d'échantillons : l'effort se concentre sur les pixels encore bruités.
+ * 
+ * @see Framebuffer
+*/
+class Accumulator {
+    private :
+        /**
+         * @brief La largeur de l'image
+        */
+        int width_ ;
+        /**
+         * @brief La hauteur de l'image
+        */
+        int height_ ;
+        /**
+         * @brief La somme des couleurs des échantillons de chaque pixel, 3 flottants par pixel
+        */
+        std::vector<float> sum_ ;
+        /**
+         * @brief Le nombre d'échantillons de chaque pixel
+        */
+        std::vector<int> count_ ;
+        /**
+         * @brief La somme de la luminance des échantillons de chaque pixel, en double pour le calcul de la variance
+        */
+        std::vector<double> sum_lum_ ;
+        /**
+         * @brief La somme du carré de la luminance des échantillons de chaque pixel
+        */
+        std::vector<double> sum_lum2_ ;
+        /**
+         * @brief Pour chaque pixel, 1 s'il a convergé et ne reçoit plus d'échantillons, 0 sinon
+        */
+        std::vector<unsigned char> converged_ ;
+        /**
+         * @brief Le nombre de pixels qui n'ont pas encore convergé
+        */
+        int nb_active_ ;
+        /**
+         * @brief Le nombre de passes complètes ajoutées depuis la dernière remise à zéro
+        */
+        int nb_passes_ ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         * 
+         * Crée un accumulateur vide de la taille donnée
+         * 
+         * @param width : la largeur de l'image
+         * @param height : la hauteur de l'image
+        */
+        Accumulator(int width = 0, int height = 0) ;
+
+        /**
+         * @brief Getter de l'attribut width_
+         * 
+         * @return L'attribut width_ de la classe
+        */
+        int get_width() const { return width_ ; }
+        /**
+         * @brief Getter de l'attribut height_
+         * 
+         * @return L'attribut height_ de la classe
+        */
+        int get_height() const { return height_ ; }
+        /**
+         * @brief Getter de l'attribut nb_passes_
+         * 
+         * @return L'attribut nb_passes_ de la classe
+        */
+        int get_nb_passes() const { return nb_passes_ ; }
+        /**
+         * @brief Donne le nombre d'échantillons du pixel (x, y)
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * 
+         * @return Le nombre d'échantillons du pixel
+        */
+        int get_count(int x, int y) const { return count_[x + static_cast<size_t>(y) * width_] ; }
+        /**
+         * @brief Indique si le pixel (x, y) a convergé
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * 
+         * @return true si le pixel est retiré et ne doit plus recevoir d'échantillons
+        */
+        bool is_converged(int x, int y) const { return converged_[x + static_cast<size_t>(y) * width_] != 0 ; }
+        /**
+         * @brief Getter de l'attribut nb_active_
+         * 
+         * @return Le nombre de pixels qui n'ont pas encore convergé
+        */
+        int get_nb_active() const { return nb_active_ ; }
+        /**
+         * @brief Donne le nombre total d'échantillons accumulés, tous pixels confondus
+         * 
+         * @return La somme du nombre d'échantillons de chaque pixel
+        */
+        long long get_nb_samples() const ;
+        /**
+         * @brief Estime l'erreur de la moyenne du pixel (x, y), telle qu'elle se voit dans l'image affichée
+         * 
+         * C'est l'écart type de la moyenne de la luminance, ramené après correction gamma en niveaux de 0 à 255.
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * 
+         * @return L'erreur estimée, infinie si le pixel a moins de deux échantillons
+        */
+        float get_error(int x, int y) const ;
+
+        /**
+         * @brief Remet l'accumulateur à zéro, avec une nouvelle taille
+         * 
+         * @param width : la largeur de l'image
+         * @param height : la hauteur de l'image
+        */
+        void reset(int width, int height) ;
+        /**
+         * @brief Ajoute un échantillon au pixel (x, y)
+         * 
+         * Deux threads ne doivent pas ajouter en même temps un échantillon au même pixel.
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * @param color : référence vers la couleur de l'échantillon
+         * @see Material
+        */
+        void add_sample(int x, int y, const Material & color) ;
+        /**
+         * @brief Indique qu'une passe complète (un échantillon de plus par pixel) vient d'être ajoutée
+        */
+        void end_pass() { nb_passes_++ ; }
+        /**
+         * @brief Retire les tuiles dont l'erreur est passée sous le seuil
+         * 
+         * L'erreur d'une tuile est la moyenne quadratique de l'erreur de ses pixels, plus fiable que celle
+         * d'un pixel seul. Un pixel retiré le reste jusqu'à la prochaine remise à zéro.
+         * 
+         * @param threshold : l'erreur, en niveaux de 0 à 255, en dessous de laquelle une tuile a convergé
+         * @param min_samples : le nombre d'échantillons minimum avant de faire confiance à la variance
+         * @param tile_size : le côté des tuiles, en pixels
+         * @see get_error
+         * 
+         * @return Le nombre de pixels qui n'ont pas encore convergé
+        */
+        int retire_converged(float threshold, int min_samples, int tile_size) ;
+
+        /**
+         * @brief Calcule l'image moyenne des échantillons accumulés
+         * 
+         * @param image : référence vers l'image qui reçoit la moyenne de chaque pixel (noir s'il n'a pas d'échantillon)
+         * @see Framebuffer
+        */
+        void resolve(Framebuffer & image) const ;
+} ;
+
+#endif
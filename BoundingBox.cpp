@@ -0,0 +1,39 @@
+#include "BoundingBox.h"
+#include <algorithm>
+#include <limits>
+
+BoundingBox::BoundingBox() {
+    float inf = std::numeric_limits<float>::infinity() ;
+    min_ = Vector3f(inf) ;
+    max_ = Vector3f(-inf) ;
+}
+
+BoundingBox::BoundingBox(const Vector3f & a, const Vector3f & b) {
+    min_ = Vector3f(std::min(a.get_x(), b.get_x()), std::min(a.get_y(), b.get_y()), std::min(a.get_z(), b.get_z())) ;
+    max_ = Vector3f(std::max(a.get_x(), b.get_x()), std::max(a.get_y(), b.get_y()), std::max(a.get_z(), b.get_z())) ;
+}
+
+Vector3f BoundingBox::get_center() const {
+    return 0.5f * (min_ + max_) ;
+}
+
+float BoundingBox::surface_area() const {
+    if (is_empty()) {
+        return 0.0f ;
+    }
+    Vector3f d = max_ - min_ ;
+    return 2.0f * (d.get_x() * d.get_y() + d.get_y() * d.get_z() + d.get_z() * d.get_x()) ;
+}
+
+int BoundingBox::largest_axis() const {
+    Vector3f d = max_ - min_ ;
+    if (d.get_x() >= d.get_y() && d.get_x() >= d.get_z()) {
+        return 0 ;
+    }
+    return (d.get_y() >= d.get_z()) ? 1 : 2 ;
+}
+
+std::ostream & operator << (std::ostream & st, const BoundingBox & b) {
+    st << "BoundingBox : [ min : " << b.get_min() << ", max : " << b.get_max() << " ]" ;
+    return st ;
+}
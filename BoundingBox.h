@@ -0,0 +1,142 @@
+#ifndef BOUNDINGBOX_H
+#define BOUNDINGBOX_H
+
+#include "Vector3f.h"
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+/**
+ * @brief La classe BoundingBox définit une boîte englobante alignée sur les axes
+ *
+ * Elle est définie par son coin minimal et son coin maximal. Elle sert à construire
+ * la hiérarchie de volumes englobants (BVH) de la scène.
+ * Une boîte vide a un coin minimal à +infini et un coin maximal à -infini, de sorte que
+ * l'agrandir avec n'importe quel point ou boîte donne ce point ou cette boîte.
+ *
+ * @see Bvh
+*/
+class BoundingBox {
+    private :
+        /**
+         * @brief Le coin minimal de la boîte
+         * @see Vector3f
+        */
+        Vector3f min_ ;
+        /**
+         * @brief Le coin maximal de la boîte
+         * @see Vector3f
+        */
+        Vector3f max_ ;
+
+    public :
+        /**
+         * @brief Constructeur par défaut
+         *
+         * Crée une boîte vide
+        */
+        BoundingBox() ;
+        /**
+         * @brief Constructeur paramétré
+         *
+         * Crée une boîte à partir de ses deux coins. Les coins peuvent être donnés dans n'importe
+         * quel ordre, la boîte prend le minimum et le maximum composante par composante
+         *
+         * @param a : un premier coin de la boîte
+         * @param b : le coin opposé de la boîte
+         * @see Vector3f
+        */
+        BoundingBox(const Vector3f & a, const Vector3f & b) ;
+
+        /**
+         * @brief Getter de l'attribut min_
+         *
+         * @return L'attribut min_ de la classe
+        */
+        Vector3f get_min() const { return min_ ; }
+        /**
+         * @brief Getter de l'attribut max_
+         *
+         * @return L'attribut max_ de la classe
+        */
+        Vector3f get_max() const { return max_ ; }
+
+        /**
+         * @brief Agrandit la boîte pour qu'elle contienne le point donné
+         *
+         * @param p : référence vers le point à inclure
+        */
+        void expand(const Vector3f & p) {
+            min_ = Vector3f(std::min(min_.get_x(), p.get_x()), std::min(min_.get_y(), p.get_y()), std::min(min_.get_z(), p.get_z())) ;
+            max_ = Vector3f(std::max(max_.get_x(), p.get_x()), std::max(max_.get_y(), p.get_y()), std::max(max_.get_z(), p.get_z())) ;
+        }
+        /**
+         * @brief Agrandit la boîte pour qu'elle contienne la boîte donnée
+         *
+         * @param b : référence vers la boîte à inclure
+        */
+        void expand(const BoundingBox & b) {
+            if (b.is_empty()) {
+                return ;
+            }
+            expand(b.get_min()) ;
+            expand(b.get_max()) ;
+        }
+
+        /**
+         * @brief Donne le centre de la boîte
+         *
+         * @return Le point au centre de la boîte
+        */
+        Vector3f get_center() const ;
+        /**
+         * @brief Donne l'aire de la surface de la boîte, utilisée par l'heuristique SAH du BVH
+         *
+         * @return L'aire de la boîte, 0 si la boîte est vide
+        */
+        float surface_area() const ;
+        /**
+         * @brief Donne l'axe selon lequel la boîte est la plus étendue
+         *
+         * @return 0 pour x, 1 pour y, 2 pour z
+        */
+        int largest_axis() const ;
+        /**
+         * @brief Permet de savoir si la boîte est vide
+         *
+         * @return true si la boîte ne contient aucun point, false sinon
+        */
+        bool is_empty() const {
+            return min_.get_x() > max_.get_x() || min_.get_y() > max_.get_y() || min_.get_z() > max_.get_z() ;
+        }
+} ;
+
+/**
+ * @brief Donne une composante d'un vecteur à partir de son indice
+ *
+ * @param v : référence vers le vecteur
+ * @param axis : 0 pour x, 1 pour y, 2 pour z
+ *
+ * @return La composante voulue du vecteur
+*/
+inline float get_axis(const Vector3f & v, int axis) {
+    if (axis == 0) {
+        return v.get_x() ;
+    }
+    return (axis == 1) ? v.get_y() : v.get_z() ;
+}
+
+/**
+ * @brief L'opérateur << pour afficher les informations de la boîte
+ *
+ * Affiche les informations de la boîte donnée sous le format suivant :
+ * BoundingBox : [min : min_, max : max_]
+ *
+ * @param st : le flux sur lequel on veut afficher la boîte
+ * @param b : référence de la boîte dont on veut afficher les informations
+ *
+ * @return la référence vers le flux modifié
+*/
+std::ostream & operator << (std::ostream & st, const BoundingBox & b) ;
+
+#endif
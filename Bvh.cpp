@@ -0,0 +1,256 @@
+#include "Bvh.h"
+#include "Trace.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+// Nombre d'intervalles sur lesquels on évalue l'heuristique de surface
+const int NB_INTERVALLES = 16 ;
+// Nombre maximal de primitives dans une feuille (sauf si elles sont impossibles à séparer)
+const int FEUILLE_MAX = 4 ;
+// Profondeur maximale, limitée par la taille de la pile de Bvh::traverse (TAILLE_PILE_BVH)
+const int PROFONDEUR_MAX = 60 ;
+// Coût d'un test de boîte relativement au coût d'un test de primitive
+const float COUT_NOEUD = 1.0f ;
+// Nombre de primitives à partir duquel les sous-arbres sont construits en parallèle
+const int SEUIL_PARALLELE = 1 << 16 ;
+// Nombre de sous-arbres construits en parallèle par thread
+const int TACHES_PAR_THREAD = 8 ;
+
+Bvh::Bvh() {
+}
+
+Bvh::Bvh(MappedArray<BvhNode> nodes, MappedArray<int> indices) : nodes_(std::move(nodes)), indices_(std::move(indices)) {
+}
+
+// Une primitive en cours de rangement : sa boîte, son centre et son indice sont déplacés ensemble, pour que
+// chaque passe sur un intervalle lise la mémoire dans l'ordre au lieu de sauter d'une boîte à l'autre
+struct PrimitiveBvh {
+    BoundingBox box_ ;
+    Vector3f center_ ;
+    int index_ ;
+} ;
+
+// Calcule la boîte du noeud des primitives [begin, end[ et cherche sa meilleure coupe. Si le noeud doit être
+// coupé, les primitives sont réordonnées : celles de l'enfant gauche sont dans [begin, *mid[
+static bool split_node(std::vector<PrimitiveBvh> & prims, int begin, int end, int depth, BvhNode * node, int * mid) {
+    // Boîte du noeud et boîte des centres de ses primitives
+    BoundingBox bounds, center_bounds ;
+    for (int i = begin ; i < end ; i++) {
+        bounds.expand(prims[i].box_) ;
+        center_bounds.expand(prims[i].center_) ;
+    }
+    Vector3f bmin = bounds.get_min() ;
+    Vector3f bmax = bounds.get_max() ;
+    node->min_[0] = bmin.get_x() ; node->min_[1] = bmin.get_y() ; node->min_[2] = bmin.get_z() ;
+    node->max_[0] = bmax.get_x() ; node->max_[1] = bmax.get_y() ; node->max_[2] = bmax.get_z() ;
+    node->first_ = begin ;
+    node->count_ = end - begin ;
+
+    int count = end - begin ;
+    int axis = center_bounds.largest_axis() ;
+    float cmin = get_axis(center_bounds.get_min(), axis) ;
+    float extent = get_axis(center_bounds.get_max(), axis) - cmin ;
+
+    // Si les centres sont tous confondus, on ne peut pas séparer les primitives : on garde une feuille
+    if (count <= 1 || depth >= PROFONDEUR_MAX || !(extent > 0.0f)) {
+        return false ;
+    }
+
+    // -- Heuristique de surface (SAH) sur des intervalles réguliers de l'axe le plus étendu
+    int counts[NB_INTERVALLES] = {0} ;
+    BoundingBox bin_bounds[NB_INTERVALLES] ;
+    float scale = NB_INTERVALLES / extent ;
+    auto bin_of = [&](const PrimitiveBvh & prim) {
+        int b = static_cast<int>((get_axis(prim.center_, axis) - cmin) * scale) ;
+        return std::min(std::max(b, 0), NB_INTERVALLES - 1) ;
+    } ;
+    for (int i = begin ; i < end ; i++) {
+        int b = bin_of(prims[i]) ;
+        counts[b]++ ;
+        bin_bounds[b].expand(prims[i].box_) ;
+    }
+
+    // Balayage de droite à gauche pour connaître l'aire et le nombre de primitives à droite de chaque coupe
+    float right_area[NB_INTERVALLES] ;
+    int right_count[NB_INTERVALLES] ;
+    BoundingBox acc ;
+    int n = 0 ;
+    for (int b = NB_INTERVALLES - 1 ; b > 0 ; b--) {
+        acc.expand(bin_bounds[b]) ;
+        n += counts[b] ;
+        right_area[b] = acc.surface_area() ;
+        right_count[b] = n ;
+    }
+
+    // Balayage de gauche à droite pour trouver la coupe la moins chère
+    float best_cost = 0.0f ;
+    int best_split = -1 ;
+    acc = BoundingBox() ;
+    n = 0 ;
+    for (int b = 0 ; b < NB_INTERVALLES - 1 ; b++) {
+        acc.expand(bin_bounds[b]) ;
+        n += counts[b] ;
+        if (n == 0 || right_count[b + 1] == 0) {
+            continue ;
+        }
+        float cost = acc.surface_area() * n + right_area[b + 1] * right_count[b + 1] ;
+        if (best_split < 0 || cost < best_cost) {
+            best_cost = cost ;
+            best_split = b ;
+        }
+    }
+
+    float area = bounds.surface_area() ;
+    float leaf_cost = area * count ;
+    float split_cost = COUT_NOEUD * area + best_cost ;
+    if (count <= FEUILLE_MAX && (best_split < 0 || leaf_cost <= split_cost)) {
+        return false ;
+    }
+
+    if (best_split >= 0) {
+        *mid = static_cast<int>(std::partition(prims.begin() + begin, prims.begin() + end,
+            [&](const PrimitiveBvh & prim) { return bin_of(prim) <= best_split ; }) - prims.begin()) ;
+    }
+    else {
+        // Toutes les primitives tombent dans le même intervalle : on coupe à la médiane
+        *mid = begin + count / 2 ;
+        std::nth_element(prims.begin() + begin, prims.begin() + *mid, prims.begin() + end,
+            [&](const PrimitiveBvh & a, const PrimitiveBvh & b) { return get_axis(a.center_, axis) < get_axis(b.center_, axis) ; }) ;
+    }
+    return true ;
+}
+
+// Construit récursivement le sous-arbre des primitives [begin, end[ à la suite de nodes, et donne l'indice de sa
+// racine. L'enfant gauche est construit juste après le noeud, on ne stocke que l'indice de l'enfant droit
+static int build_node(std::vector<PrimitiveBvh> & prims, int begin, int end, int depth, std::vector<BvhNode> & nodes) {
+    int id = static_cast<int>(nodes.size()) ;
+    BvhNode node ;
+    int mid ;
+    bool coupe = split_node(prims, begin, end, depth, &node, &mid) ;
+    nodes.push_back(node) ;
+    if (!coupe) {
+        return id ;
+    }
+    build_node(prims, begin, mid, depth + 1, nodes) ;
+    int right = build_node(prims, mid, end, depth + 1, nodes) ;
+    nodes[id].first_ = right ;
+    nodes[id].count_ = 0 ;
+    return id ;
+}
+
+// Un morceau du haut de la hiérarchie : un noeud coupé avant la construction en parallèle, ou un sous-arbre
+// construit par une tâche dans son propre tableau de noeuds
+struct MorceauBvh {
+    BvhNode node_ ;
+    // Les morceaux enfants d'un noeud coupé, -1 pour un sous-arbre
+    int left_, right_ ;
+    int begin_, end_, depth_ ;
+    std::vector<BvhNode> nodes_ ;
+} ;
+
+// Coupe le haut de la hiérarchie jusqu'à des sous-arbres d'au plus taille_tache primitives, rangés dans taches
+static int split_top(std::vector<PrimitiveBvh> & prims, int begin, int end, int depth, int taille_tache,
+                     std::vector<MorceauBvh> & morceaux, std::vector<int> & taches) {
+    int id = static_cast<int>(morceaux.size()) ;
+    morceaux.push_back(MorceauBvh()) ;
+    morceaux[id].left_ = -1 ;
+    morceaux[id].right_ = -1 ;
+    morceaux[id].begin_ = begin ;
+    morceaux[id].end_ = end ;
+    morceaux[id].depth_ = depth ;
+    BvhNode node ;
+    int mid ;
+    if (end - begin <= taille_tache || !split_node(prims, begin, end, depth, &node, &mid)) {
+        taches.push_back(id) ;
+        return id ;
+    }
+    morceaux[id].node_ = node ;
+    int left = split_top(prims, begin, mid, depth + 1, taille_tache, morceaux, taches) ;
+    int right = split_top(prims, mid, end, depth + 1, taille_tache, morceaux, taches) ;
+    morceaux[id].left_ = left ;
+    morceaux[id].right_ = right ;
+    return id ;
+}
+
+// Recopie les morceaux en profondeur d'abord, comme build_node les aurait rangés : les enfants droits des
+// sous-arbres sont décalés de la place du sous-arbre dans nodes
+static int emit(const std::vector<MorceauBvh> & morceaux, int id, std::vector<BvhNode> & nodes) {
+    const MorceauBvh & morceau = morceaux[id] ;
+    int position = static_cast<int>(nodes.size()) ;
+    if (morceau.left_ < 0) {
+        for (BvhNode node : morceau.nodes_) {
+            if (node.count_ == 0) {
+                node.first_ += position ;
+            }
+            nodes.push_back(node) ;
+        }
+        return position ;
+    }
+    nodes.push_back(morceau.node_) ;
+    emit(morceaux, morceau.left_, nodes) ;
+    int right = emit(morceaux, morceau.right_, nodes) ;
+    nodes[position].first_ = right ;
+    nodes[position].count_ = 0 ;
+    return position ;
+}
+
+void Bvh::build(const std::vector<BoundingBox> & boxes, int nb_threads) {
+    RT_TRACE("construction du Bvh") ;
+    nodes_ = MappedArray<BvhNode>() ;
+    indices_ = MappedArray<int>() ;
+    if (boxes.empty()) {
+        return ;
+    }
+
+    int nb = static_cast<int>(boxes.size()) ;
+    std::vector<PrimitiveBvh> prims(boxes.size()) ;
+    for (int i = 0 ; i < nb ; i++) {
+        prims[i].box_ = boxes[i] ;
+        prims[i].center_ = boxes[i].get_center() ;
+        prims[i].index_ = i ;
+    }
+
+    // Un arbre binaire à n feuilles a au plus 2n - 1 noeuds
+    std::vector<BvhNode> nodes ;
+    nodes.reserve(2 * boxes.size()) ;
+    if (nb < SEUIL_PARALLELE) {
+        build_node(prims, 0, nb, 0, nodes) ;
+    }
+    else {
+        // Le haut de la hiérarchie est coupé sur ce thread, puis les sous-arbres, indépendants, sont construits
+        // en parallèle : plusieurs par thread, pour que le vol de tâches équilibre leurs tailles inégales.
+        // Les coupes sont les mêmes que sur un seul thread, la hiérarchie aussi
+        ThreadPool pool(nb_threads) ;
+        int taille_tache = std::max(nb / (TACHES_PAR_THREAD * pool.get_nb_threads()), SEUIL_PARALLELE / 4) ;
+        std::vector<MorceauBvh> morceaux ;
+        std::vector<int> taches ;
+        split_top(prims, 0, nb, 0, taille_tache, morceaux, taches) ;
+        pool.parallel_for(static_cast<int>(taches.size()), [&](int t) {
+            RT_TRACE("sous-arbre du Bvh") ;
+            MorceauBvh & morceau = morceaux[taches[t]] ;
+            morceau.nodes_.reserve(2 * (morceau.end_ - morceau.begin_)) ;
+            build_node(prims, morceau.begin_, morceau.end_, morceau.depth_, morceau.nodes_) ;
+        }) ;
+        emit(morceaux, 0, nodes) ;
+    }
+
+    std::vector<int> indices(boxes.size()) ;
+    for (int i = 0 ; i < nb ; i++) {
+        indices[i] = prims[i].index_ ;
+    }
+    nodes_ = MappedArray<BvhNode>(std::move(nodes)) ;
+    indices_ = MappedArray<int>(std::move(indices)) ;
+}
+
+BoundingBox Bvh::get_bounds() const {
+    if (nodes_.empty()) {
+        return BoundingBox() ;
+    }
+    const BvhNode & root = nodes_[0] ;
+    return BoundingBox(Vector3f(root.min_[0], root.min_[1], root.min_[2]), Vector3f(root.max_[0], root.max_[1], root.max_[2])) ;
+}
+
+std::ostream & operator << (std::ostream & st, const Bvh & b) {
+    st << "Bvh : [ nodes : " << b.get_nodes().size() << ", primitives : " << b.get_nb_primitives() << " ]" ;
+    return st ;
+}
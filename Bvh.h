@@ -0,0 +1,375 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "BoundingBox.h"
+#include "Ray3f.h"
+#include "Packet.h"
+#include "MappedArray.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+// Nombre de places de la pile des parcours du Bvh, qui empilent au plus un noeud par niveau de l'arbre
+const int TAILLE_PILE_BVH = 64 ;
+
+/**
+ * @brief Un noeud de la hiérarchie de volumes englobants
+ *
+ * Les noeuds sont rangés à plat dans un tableau, en profondeur d'abord : l'enfant gauche d'un noeud
+ * interne est toujours le noeud qui le suit dans le tableau, seul l'indice de l'enfant droit est stocké.
+ * Un noeud tient sur 32 octets, soit deux noeuds par ligne de cache.
+*/
+struct BvhNode {
+    /**
+     * @brief Le coin minimal de la boîte englobante du noeud
+    */
+    float min_[3] ;
+    /**
+     * @brief Le coin maximal de la boîte englobante du noeud
+    */
+    float max_[3] ;
+    /**
+     * @brief Pour une feuille, l'indice de la première primitive dans Bvh::indices_.
+     * Pour un noeud interne, l'indice de l'enfant droit
+    */
+    int first_ ;
+    /**
+     * @brief Le nombre de primitives de la feuille, 0 pour un noeud interne
+    */
+    int count_ ;
+} ;
+
+/**
+ * @brief La classe Bvh est une hiérarchie de volumes englobants (Bounding Volume Hierarchy)
+ *
+ * Elle est construite une seule fois, avant le rendu, à partir des boîtes englobantes des primitives,
+ * avec l'heuristique de surface (SAH) évaluée sur des intervalles (binning).
+ * Elle permet de ne tester qu'un nombre logarithmique de primitives par rayon au lieu de toutes.
+ *
+ * @see BoundingBox, BvhNode
+*/
+class Bvh {
+    private :
+        /**
+         * @brief Les noeuds de la hiérarchie, à plat, la racine étant le noeud 0
+         * @see BvhNode
+        */
+        MappedArray<BvhNode> nodes_ ;
+        /**
+         * @brief Les indices des primitives, réordonnés pour que chaque feuille en référence un intervalle contigu
+        */
+        MappedArray<int> indices_ ;
+
+        /**
+         * @brief Teste l'intersection d'un rayon avec la boîte d'un noeud (méthode des "slabs")
+         *
+         * @param node : le noeud à tester
+         * @param origin : l'origine du rayon
+         * @param inv_dir : l'inverse de chaque composante de la direction du rayon
+         * @param t_max : la distance maximale au-delà de laquelle l'intersection ne nous intéresse plus
+         * @param t_near : pointeur vers la distance d'entrée dans la boîte
+         *
+         * @return true si le rayon traverse la boîte avant t_max, false sinon
+        */
+        static bool hit_node(const BvhNode & node, const float origin[3], const float inv_dir[3], float t_max, float * t_near) {
+            float tx1 = (node.min_[0] - origin[0]) * inv_dir[0] ;
+            float tx2 = (node.max_[0] - origin[0]) * inv_dir[0] ;
+            float ty1 = (node.min_[1] - origin[1]) * inv_dir[1] ;
+            float ty2 = (node.max_[1] - origin[1]) * inv_dir[1] ;
+            float tz1 = (node.min_[2] - origin[2]) * inv_dir[2] ;
+            float tz2 = (node.max_[2] - origin[2]) * inv_dir[2] ;
+            float t_min = std::max(std::min(tx1, tx2), std::max(std::min(ty1, ty2), std::min(tz1, tz2))) ;
+            // On agrandit légèrement la sortie pour ne pas rater les intersections rasantes à cause des arrondis
+            float t_out = std::min(std::max(tx1, tx2), std::min(std::max(ty1, ty2), std::max(tz1, tz2))) * 1.0000004f ;
+            *t_near = t_min ;
+            return t_min <= t_out && t_out >= 0.0f && t_min <= t_max ;
+        }
+
+        /**
+         * @brief Teste l'intersection de tous les rayons d'un paquet avec la boîte d'un noeud
+         *
+         * Chaque voie fait exactement le calcul de hit_node.
+         *
+         * @param node : le noeud à tester
+         * @param packet : référence vers le paquet de rayons
+         * @param t_max : les distances maximales de chaque rayon
+         * @param t_near : pointeur vers la plus petite distance d'entrée dans la boîte des rayons qui la traversent
+         *
+         * @return Le masque des rayons actifs qui traversent la boîte avant leur t_max, un bit par voie
+         * @see RayPacket
+        */
+        static int hit_node_packet(const BvhNode & node, const RayPacket & packet, PacketFloat t_max, float * t_near) {
+            PacketFloat tx1 = (PacketFloat(node.min_[0]) - packet.ox_) * packet.inv_dx_ ;
+            PacketFloat tx2 = (PacketFloat(node.max_[0]) - packet.ox_) * packet.inv_dx_ ;
+            PacketFloat ty1 = (PacketFloat(node.min_[1]) - packet.oy_) * packet.inv_dy_ ;
+            PacketFloat ty2 = (PacketFloat(node.max_[1]) - packet.oy_) * packet.inv_dy_ ;
+            PacketFloat tz1 = (PacketFloat(node.min_[2]) - packet.oz_) * packet.inv_dz_ ;
+            PacketFloat tz2 = (PacketFloat(node.max_[2]) - packet.oz_) * packet.inv_dz_ ;
+            PacketFloat t_min = packet_max(packet_min(tx1, tx2), packet_max(packet_min(ty1, ty2), packet_min(tz1, tz2))) ;
+            PacketFloat t_out = packet_min(packet_max(tx1, tx2), packet_min(packet_max(ty1, ty2), packet_max(tz1, tz2))) * PacketFloat(1.0000004f) ;
+            int mask = packet_mask((t_min <= t_out) & (PacketFloat(0.0f) <= t_out) & (t_min <= t_max)) & packet.active_ ;
+            if (mask != 0) {
+                float t[PACKET_SIZE] ;
+                t_min.store(t) ;
+                float plus_proche = 1E30f ;
+                for (int i = 0 ; i < PACKET_SIZE ; i++) {
+                    if ((mask >> i) & 1) {
+                        plus_proche = std::min(plus_proche, t[i]) ;
+                    }
+                }
+                *t_near = plus_proche ;
+            }
+            return mask ;
+        }
+
+    public :
+        /**
+         * @brief Constructeur par défaut
+         *
+         * Crée une hiérarchie vide, qu'aucun rayon ne traverse
+        */
+        Bvh() ;
+        /**
+         * @brief Constructeur paramétré, à partir d'une hiérarchie déjà construite
+         *
+         * Sert à relire une hiérarchie enregistrée (voir SceneCache) sans la reconstruire.
+         *
+         * @param nodes : les noeuds, dans l'ordre de Bvh::build
+         * @param indices : les indices des primitives, dans l'ordre des feuilles
+        */
+        Bvh(MappedArray<BvhNode> nodes, MappedArray<int> indices) ;
+
+        /**
+         * @brief Construit la hiérarchie à partir des boîtes englobantes des primitives
+         *
+         * La primitive i est celle de boîte boxes[i]. Une construction précédente est remplacée.
+         * Pour une grande hiérarchie, les sous-arbres sous les premières coupes sont construits en parallèle,
+         * avec le même résultat que sur un seul thread.
+         *
+         * @param boxes : les boîtes englobantes des primitives
+         * @param nb_threads : le nombre de threads de la construction en parallèle, 0 pour tous les coeurs
+         * @see BoundingBox
+        */
+        void build(const std::vector<BoundingBox> & boxes, int nb_threads) ;
+
+        /**
+         * @brief Getter de l'attribut nodes_
+         *
+         * @return Référence vers l'attribut nodes_ de la classe
+        */
+        const MappedArray<BvhNode> & get_nodes() const { return nodes_ ; }
+        /**
+         * @brief Getter de l'attribut indices_
+         *
+         * @return Référence vers l'attribut indices_ de la classe
+        */
+        const MappedArray<int> & get_indices() const { return indices_ ; }
+        /**
+         * @brief Donne l'indice de la primitive rangée à la position i
+         *
+         * @param i : la position dans indices_, entre first_ et first_ + count_ pour une feuille
+         *
+         * @return L'indice de la primitive
+        */
+        int get_index(int i) const { return indices_[i] ; }
+        /**
+         * @brief Donne le nombre de primitives de la hiérarchie
+         *
+         * @return Le nombre de primitives
+        */
+        int get_nb_primitives() const { return static_cast<int>(indices_.size()) ; }
+        /**
+         * @brief Donne la boîte englobante de toute la hiérarchie
+         *
+         * @return La boîte de la racine, une boîte vide si la hiérarchie est vide
+         * @see BoundingBox
+        */
+        BoundingBox get_bounds() const ;
+
+        /**
+         * @brief Parcourt la hiérarchie le long d'un rayon
+         *
+         * Les noeuds sont visités du plus proche au plus lointain, et ceux qui commencent après t_max
+         * sont ignorés. Pour chaque feuille traversée, on appelle leaf(first, count, t_max) où
+         * [first, first + count[ est l'intervalle des primitives de la feuille (voir get_index).
+         * leaf peut diminuer t_max quand elle trouve une intersection plus proche, ce qui élague la suite
+         * du parcours, et renvoie true pour arrêter immédiatement le parcours.
+         *
+         * @param ray : référence vers le rayon
+         * @param t_max : la distance maximale de recherche
+         * @param leaf : la fonction appelée pour chaque feuille
+         * @see Ray3f
+        */
+        template <typename Leaf>
+        void traverse(const Ray3f & ray, float t_max, Leaf leaf) const {
+            if (nodes_.empty()) {
+                return ;
+            }
+            Vector3f o = ray.get_centre() ;
+            Vector3f d = ray.get_direction() ;
+            const float origin[3] = { o.get_x(), o.get_y(), o.get_z() } ;
+            const float inv_dir[3] = { slab_inverse(d.get_x()), slab_inverse(d.get_y()), slab_inverse(d.get_z()) } ;
+
+            float t_near ;
+            if (!hit_node(nodes_[0], origin, inv_dir, t_max, &t_near)) {
+                return ;
+            }
+
+            // Pile des noeuds restant à visiter, avec leur distance d'entrée pour pouvoir les élaguer
+            int stack[TAILLE_PILE_BVH] ;
+            float stack_t[TAILLE_PILE_BVH] ;
+            int size = 0 ;
+            int node = 0 ;
+
+            while (true) {
+                const BvhNode & n = nodes_[node] ;
+                RT_STAT(nodes_) ;
+                if (n.count_ > 0) {
+                    if (leaf(n.first_, n.count_, t_max)) {
+                        return ;
+                    }
+                }
+                else {
+                    int left = node + 1 ;
+                    int right = n.first_ ;
+                    float t_left, t_right ;
+                    bool hit_left = hit_node(nodes_[left], origin, inv_dir, t_max, &t_left) ;
+                    bool hit_right = hit_node(nodes_[right], origin, inv_dir, t_max, &t_right) ;
+                    if (hit_left && hit_right) {
+                        // On visite d'abord l'enfant le plus proche, l'autre attend dans la pile
+                        if (t_right < t_left) {
+                            std::swap(left, right) ;
+                            std::swap(t_left, t_right) ;
+                        }
+                        stack[size] = right ;
+                        stack_t[size] = t_right ;
+                        size++ ;
+                        node = left ;
+                        continue ;
+                    }
+                    if (hit_left) {
+                        node = left ;
+                        continue ;
+                    }
+                    if (hit_right) {
+                        node = right ;
+                        continue ;
+                    }
+                }
+
+                // On dépile le prochain noeud qui commence encore avant t_max
+                bool found = false ;
+                while (size > 0) {
+                    size-- ;
+                    if (stack_t[size] <= t_max) {
+                        node = stack[size] ;
+                        found = true ;
+                        break ;
+                    }
+                }
+                if (!found) {
+                    return ;
+                }
+            }
+        }
+
+        /**
+         * @brief Parcourt la hiérarchie avec un paquet de rayons
+         *
+         * Un noeud est visité dès qu'un des rayons actifs du paquet le traverse, dans l'ordre de la plus
+         * petite distance d'entrée. Comme pour traverse, leaf(first, count, t_max) est appelée pour chaque
+         * feuille, et peut diminuer les distances maximales t_max de chaque rayon.
+         *
+         * @param packet : référence vers le paquet de rayons
+         * @param t_max : les distances maximales de recherche de chaque rayon
+         * @param leaf : la fonction appelée pour chaque feuille
+         * @see RayPacket, traverse
+        */
+        template <typename Leaf>
+        void traverse_packet(const RayPacket & packet, PacketFloat t_max, Leaf leaf) const {
+            if (nodes_.empty()) {
+                return ;
+            }
+            float t_near ;
+            if (hit_node_packet(nodes_[0], packet, t_max, &t_near) == 0) {
+                return ;
+            }
+
+            int stack[TAILLE_PILE_BVH] ;
+            float stack_t[TAILLE_PILE_BVH] ;
+            int size = 0 ;
+            int node = 0 ;
+
+            while (true) {
+                const BvhNode & n = nodes_[node] ;
+                RT_STAT(nodes_) ;
+                if (n.count_ > 0) {
+                    leaf(n.first_, n.count_, t_max) ;
+                }
+                else {
+                    int left = node + 1 ;
+                    int right = n.first_ ;
+                    float t_left, t_right ;
+                    bool hit_left = hit_node_packet(nodes_[left], packet, t_max, &t_left) != 0 ;
+                    bool hit_right = hit_node_packet(nodes_[right], packet, t_max, &t_right) != 0 ;
+                    if (hit_left && hit_right) {
+                        if (t_right < t_left) {
+                            std::swap(left, right) ;
+                            std::swap(t_left, t_right) ;
+                        }
+                        stack[size] = right ;
+                        stack_t[size] = t_right ;
+                        size++ ;
+                        node = left ;
+                        continue ;
+                    }
+                    if (hit_left) {
+                        node = left ;
+                        continue ;
+                    }
+                    if (hit_right) {
+                        node = right ;
+                        continue ;
+                    }
+                }
+
+                // Un noeud de la pile n'est élagué que s'il commence après le t_max de tous les rayons actifs
+                float t[PACKET_SIZE] ;
+                t_max.store(t) ;
+                float t_max_paquet = -1E30f ;
+                for (int i = 0 ; i < PACKET_SIZE ; i++) {
+                    if ((packet.active_ >> i) & 1) {
+                        t_max_paquet = std::max(t_max_paquet, t[i]) ;
+                    }
+                }
+                bool found = false ;
+                while (size > 0) {
+                    size-- ;
+                    if (stack_t[size] <= t_max_paquet) {
+                        node = stack[size] ;
+                        found = true ;
+                        break ;
+                    }
+                }
+                if (!found) {
+                    return ;
+                }
+            }
+        }
+} ;
+
+/**
+ * @brief L'opérateur << pour afficher les informations de la hiérarchie
+ *
+ * Affiche les informations de la hiérarchie sous le format suivant :
+ * Bvh : [nodes : nombre de noeuds, primitives : nombre de primitives]
+ *
+ * @param st : le flux sur lequel on veut afficher la hiérarchie
+ * @param b : référence de la hiérarchie dont on veut afficher les informations
+ *
+ * @return la référence vers le flux modifié
+*/
+std::ostream & operator << (std::ostream & st, const Bvh & b) ;
+
+#endif
@@ -1,17 +1,84 @@
 #include "Camera.h"
 #include "Vector3f.h"
 
-Camera::Camera() {
-    position_ = Vector3f() ;
-    direction_ = Vector3f() ;
+#ifndef M_PI
+# define M_PI 3.1415926535
+#endif
+
+// La caméra ne se tourne pas plus près de la verticale que cela (cosinus de l'angle)
+const float VERTICALE_MAX = 0.99f ;
+
+// Rotation d'un vecteur autour d'un axe unitaire (formule de Rodrigues)
+static Vector3f rotate(const Vector3f & v, const Vector3f & axe, double degres) {
+    float c = static_cast<float>(cos(degres * M_PI / 180.0)) ;
+    float s = static_cast<float>(sin(degres * M_PI / 180.0)) ;
+    return c * v + s * cross(axe, v) + ((1.0f - c) * dot(axe, v)) * axe ;
 }
-        
-Camera::Camera (Vector3f position, Vector3f direction){
+
+Camera::Camera() : Camera(Vector3f(), Vector3f(0.0f, 0.0f, 1.0f), Vector3f(0.0f, -1.0f, 0.0f), screen_fov(1, 1.0), 1, 1) {}
+
+Camera::Camera(Vector3f position, Vector3f look_at, Vector3f up, double fov, int width, int height,
+               float aperture, float focus) {
     position_ = position ;
-    direction_ = direction ;
+    direction_ = look_at - position ;
+    float distance = direction_.longueur() ;
+    direction_.normalize() ;
+    up_ = up ;
+    up_.normalize() ;
+    width_ = width ;
+    height_ = height ;
+    aperture_ = aperture ;
+    focus_ = (focus > 0.0f) ? focus : distance ;
+    prepare(fov) ;
+}
+
+double Camera::screen_fov(int height, double distance) {
+    return 2.0 * atan(height / 2.0 / distance) * 180.0 / M_PI ;
+}
+
+void Camera::prepare(double fov) {
+    fov_ = static_cast<float>(fov) ;
+    right_ = cross(direction_, up_) ;
+    right_.normalize() ;
+    down_ = cross(direction_, right_) ;
+
+    // La taille d'un pixel sur le plan de mise au point
+    float taille = static_cast<float>(2.0 * focus_ * tan(fov * M_PI / 360.0) / height_) ;
+    du_ = taille * right_ ;
+    dv_ = taille * down_ ;
+    // Le pixel (largeur / 2, hauteur / 2) est au centre de l'image, sur la direction visée
+    coin_ = focus_ * direction_ - static_cast<float>(width_ / 2) * du_ - static_cast<float>(height_ / 2) * dv_ ;
+}
+
+Vector3f Camera::lens_offset(float u1, float u2) const {
+    // Tirage uniforme sur le disque : le rayon suit la racine pour ne pas regrouper les points au centre
+    float r = aperture_ * std::sqrt(u1) ;
+    float angle = static_cast<float>(2.0 * M_PI) * u2 ;
+    return (r * std::cos(angle)) * right_ + (r * std::sin(angle)) * down_ ;
+}
+
+void Camera::move(const Vector3f & deplacement) {
+    position_ += deplacement ;
+}
+
+void Camera::turn(float lacet, float tangage) {
+    // Autour de la verticale, tourner vers la droite est une rotation d'angle négatif
+    direction_ = rotate(direction_, up_, -lacet) ;
+    direction_.normalize() ;
+    Vector3f droite = cross(direction_, up_) ;
+    droite.normalize() ;
+    Vector3f direction = rotate(direction_, droite, tangage) ;
+    direction.normalize() ;
+    if (std::fabs(dot(direction, up_)) < VERTICALE_MAX) {
+        direction_ = direction ;
+    }
+    prepare(fov_) ;
 }
 
 std::ostream & operator << (std::ostream & st, const Camera & r) {
-    st << "Position :  " << r.get_position() << ", direction : " << r.get_direction();
+    st << "Position :  " << r.get_position() << ", direction : " << r.get_direction() << ", champ : " << r.get_fov() << " degrés" ;
+    if (r.get_aperture() > 0.0f) {
+        st << ", ouverture : " << r.get_aperture() << ", mise au point : " << r.get_focus() ;
+    }
     return st;
-}
\ No newline at end of file
+}
@@ -4,12 +4,21 @@
 #include "Vector3f.h"
 #include <cmath>
 #include <ostream>
+#include <type_traits>
 
 /**
  * @brief La classe Camera permet de représenter la caméra de la scène
- * 
+ *
  * Cette classe permet d'avoir un point de départ sur lequel se porter lors du calcul des rayons.
  * Elle représente le spectateur de la scène.
+ *
+ * La caméra est un sténopé placé en position_, qui regarde vers un point visé, avec un angle de champ vertical
+ * donné. Avec une ouverture non nulle, c'est une lentille mince : les rayons partent d'un disque autour de
+ * position_ et se croisent sur le plan de mise au point, les objets plus proches ou plus lointains sont flous.
+ *
+ * Tout ce qui ne dépend pas du pixel est calculé à la construction : la direction (non normalisée) du pixel
+ * (x, y) vaut coin_ + y * dv_ + x * du_, soit un début de ligne puis un pas par pixel. Les pixels d'une ligne
+ * peuvent ainsi être calculés ensemble, une voie SIMD par pixel (Scene::get_camera_rays).
 */
 
 class Camera {
@@ -20,71 +29,204 @@ class Camera {
         */
         Vector3f position_ ;
         /**
-         * @brief Direction vers laquelle la caméra pointe
+         * @brief Direction vers laquelle la caméra pointe, unitaire
          * @see Vector3f
         */
         Vector3f direction_ ;
+        /**
+         * @brief La verticale de la scène, qui fixe le haut de l'image : les y vont vers le bas, elle vaut (0, -1, 0)
+         * @see Vector3f
+        */
+        Vector3f up_ ;
+        /**
+         * @brief Les axes unitaires de l'image : vers la droite (right_) et vers le bas (down_)
+         * @see Vector3f
+        */
+        Vector3f right_, down_ ;
+        /**
+         * @brief L'angle de champ vertical, en degrés
+        */
+        float fov_ ;
+        /**
+         * @brief La taille de l'image en pixels
+        */
+        int width_, height_ ;
+        /**
+         * @brief Le rayon de la lentille, 0 pour un sténopé
+        */
+        float aperture_ ;
+        /**
+         * @brief La distance de mise au point, à laquelle se trouve le plan net
+        */
+        float focus_ ;
+        /**
+         * @brief Le point du plan de mise au point qui correspond au pixel (0, 0), relatif à position_
+         * @see Vector3f
+        */
+        Vector3f coin_ ;
+        /**
+         * @brief Le déplacement sur le plan de mise au point d'un pixel vers la droite (du_) et vers le bas (dv_)
+         * @see Vector3f
+        */
+        Vector3f du_, dv_ ;
+
+        /**
+         * @brief Calcule les axes de l'image et les pas par pixel à partir de la position, de la direction et du champ
+         *
+         * Le champ est pris en double : pour la caméra par défaut, le pas vaut alors exactement un pixel.
+         *
+         * @param fov : l'angle de champ vertical, en degrés
+        */
+        void prepare(double fov) ;
+
     public :
         /**
          * @brief Constructeur par défaut
-         * 
-         * Crée une instance de la classe Camera avec position_ et direction_ les vecteurs par défaut
-         * @see Vector3f
+         *
+         * Crée une caméra à l'origine qui regarde vers les z positifs, pour une image de 1 pixel
         */
         Camera() ;
 
         /**
          * @brief Constructeur paramétré
-         * 
+         *
          * Crée une instance de la classe Camera à partir des paramètres donnés
-         * 
-         * @param position : la position voulue  de la caméra
-         * @param direction : la direction voulue de la caméra
-         * 
+         *
+         * @param position : la position voulue de la caméra
+         * @param look_at : le point visé, au centre de l'image
+         * @param up : la verticale de la scène, qui ne doit pas être parallèle à la direction visée
+         * @param fov : l'angle de champ vertical, en degrés
+         * @param width : la largeur de l'image en pixels
+         * @param height : la hauteur de l'image en pixels
+         * @param aperture : le rayon de la lentille, 0 pour un sténopé
+         * @param focus : la distance de mise au point, la distance au point visé si elle est nulle
+         *
          * @see Vector3f
         */
-        Camera (Vector3f position, Vector3f direction);
+        Camera(Vector3f position, Vector3f look_at, Vector3f up, double fov, int width, int height,
+               float aperture = 0.0f, float focus = 0.0f) ;
+
+        /**
+         * @brief Donne l'angle de champ qui fait correspondre un pixel à une unité sur le plan à une distance donnée
+         *
+         * C'est le champ de l'écran de l'ancienne caméra, placé en z = 0 : la caméra par défaut le reprend.
+         *
+         * @param height : la hauteur de l'image en pixels
+         * @param distance : la distance du plan
+         *
+         * @return L'angle de champ vertical, en degrés
+        */
+        static double screen_fov(int height, double distance) ;
 
         /**
          * @brief Getter de l'attribut position_
-         * 
+         *
          * @return L'attribut position_ de la classe
         */
         Vector3f get_position() const {return position_ ;} ;
         /**
          * @brief Getter de l'attribut direction_
-         * 
+         *
          * @return L'attribut direction_ de la classe
         */
         Vector3f get_direction() const {return direction_ ;} ;
+        /**
+         * @brief Getter de l'attribut fov_
+         *
+         * @return L'attribut fov_ de la classe
+        */
+        float get_fov() const {return fov_ ;} ;
+        /**
+         * @brief Getter de l'attribut aperture_
+         *
+         * @return L'attribut aperture_ de la classe
+        */
+        float get_aperture() const {return aperture_ ;} ;
+        /**
+         * @brief Getter de l'attribut focus_
+         *
+         * @return L'attribut focus_ de la classe
+        */
+        float get_focus() const {return focus_ ;} ;
+        /**
+         * @brief Getter de l'attribut right_
+         *
+         * @return L'attribut right_ de la classe
+        */
+        Vector3f get_right() const {return right_ ;} ;
+        /**
+         * @brief Getter de l'attribut down_
+         *
+         * @return L'attribut down_ de la classe
+        */
+        Vector3f get_down() const {return down_ ;} ;
+        /**
+         * @brief Getter de l'attribut du_
+         *
+         * @return L'attribut du_ de la classe
+        */
+        Vector3f get_du() const {return du_ ;} ;
+
+        /**
+         * @brief Donne la direction du début d'une ligne de l'image, celle du pixel (0, y)
+         *
+         * @param y : la ligne
+         *
+         * @return La direction, non normalisée, qui va de position_ au plan de mise au point
+        */
+        Vector3f row_direction(float y) const { return coin_ + y * dv_ ; }
+        /**
+         * @brief Donne la direction du pixel (x, y)
+         *
+         * @param x : la colonne
+         * @param y : la ligne
+         *
+         * @return La direction, non normalisée, qui va de position_ au plan de mise au point
+        */
+        Vector3f pixel_direction(float x, float y) const { return row_direction(y) + x * du_ ; }
+        /**
+         * @brief Donne un point de la lentille, tiré uniformément sur son disque
+         *
+         * @param u1 : un nombre uniforme sur [0, 1[, pour le rayon
+         * @param u2 : un nombre uniforme sur [0, 1[, pour l'angle
+         *
+         * @return Le point, relatif à position_
+        */
+        Vector3f lens_offset(float u1, float u2) const ;
 
         /**
-         * @brief Setter de l'attribut position_
-         * 
-         * @param position : la position que l'on veut donner à la caméra
+         * @brief Déplace la caméra sans la tourner
+         *
+         * @param deplacement : le vecteur ajouté à la position de la caméra
         */
-        void set_position(Vector3f position){ position_ = position ;} ;
+        void move(const Vector3f & deplacement) ;
         /**
-         * @brief Setter de l'attribut direction_
-         * 
-         * @param direction : la direction que l'on veut donner à la caméra
+         * @brief Tourne la caméra sur elle-même, autour de la verticale puis autour de son axe horizontal
+         *
+         * La caméra ne peut pas regarder tout à fait vers le haut ou vers le bas : la rotation verticale
+         * qui l'y amènerait est ignorée.
+         *
+         * @param lacet : l'angle autour de la verticale, en degrés, positif vers la droite
+         * @param tangage : l'angle autour de l'axe horizontal, en degrés, positif vers le haut
         */
-        void set_direction(Vector3f direction){ direction_ = direction ;} ;
+        void turn(float lacet, float tangage) ;
 
 } ;
 
+static_assert(std::is_trivially_copyable<Camera>::value, "Camera doit pouvoir être copiée octet par octet") ;
+
 /**
  * @brief L'opérateur << pour afficher les informations de la caméra
- * 
- * Affiche les informations de la caméra donnée sous le format suivant : 
- * Position : position_, direction : direction_
- * 
+ *
+ * Affiche les informations de la caméra donnée sous le format suivant :
+ * Position : position_, direction : direction_, champ : fov_ degrés[, ouverture : aperture_, mise au point : focus_]
+ *
  * @param st : le flux sur lequel on veut afficher la caméra
  * @param c : référence de la caméra dont on veut afficher les informations
- * 
+ *
  * @return la référence vers le flux modifié
 */
 std::ostream & operator << (std::ostream & st, const Camera & c) ;
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,444 @@
+#include "CompiledScene.h"
+#include "Sphere.h"
+#include "Quad.h"
+#include "Plane.h"
+#include "RenderStats.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+
+// La clé d'un matériau dans la table des matériaux déjà vus : les bits de sa couleur et son type
+struct CleMateriau {
+    uint32_t rgb_[3] ;
+    unsigned char miroir_ ;
+
+    bool operator==(const CleMateriau & c) const {
+        return rgb_[0] == c.rgb_[0] && rgb_[1] == c.rgb_[1] && rgb_[2] == c.rgb_[2] && miroir_ == c.miroir_ ;
+    }
+} ;
+
+struct HachageMateriau {
+    size_t operator()(const CleMateriau & c) const {
+        uint64_t h = c.miroir_ ;
+        for (uint32_t bits : c.rgb_) {
+            h = (h ^ bits) * 0x9E3779B97F4A7C15ull ;
+        }
+        return static_cast<size_t>(h ^ (h >> 32)) ;
+    }
+} ;
+
+void CompiledScene::move_planes_to_end(std::vector<Shape*> & shapes) {
+    std::stable_partition(shapes.begin(), shapes.end(), [](const Shape * shape) {
+        return dynamic_cast<const Plane*>(shape) == nullptr ;
+    }) ;
+}
+
+std::vector<BoundingBox> CompiledScene::bounded_boxes(const std::vector<Shape*> & shapes) {
+    std::vector<BoundingBox> boxes ;
+    boxes.reserve(shapes.size()) ;
+    for (const Shape * shape : shapes) {
+        if (dynamic_cast<const Plane*>(shape) == nullptr) {
+            boxes.push_back(shape->bounding_box()) ;
+        }
+    }
+    return boxes ;
+}
+
+void CompiledScene::build(const std::vector<Shape*> & shapes, const Bvh & bvh) {
+    RT_TRACE("compilation de la scène") ;
+    *this = CompiledScene() ;
+
+    // -- Matériaux : les formes de même couleur et de même type (miroir ou non) partagent le même identifiant
+    // Une table des matériaux déjà vus : une scène où chaque forme a sa couleur en a autant que de formes
+    std::vector<int> material_ids(shapes.size()) ;
+    std::vector<Vector3f> albedos ;
+    std::vector<unsigned char> miroirs ;
+    std::unordered_map<CleMateriau, int, HachageMateriau> ids ;
+    for (size_t i = 0 ; i < shapes.size() ; i++) {
+        Vector3f albedo = shapes[i]->get_albedo() ;
+        CleMateriau cle ;
+        float rgb[3] = { albedo.get_x(), albedo.get_y(), albedo.get_z() } ;
+        std::memcpy(cle.rgb_, rgb, sizeof(rgb)) ;
+        cle.miroir_ = shapes[i]->get_miroir() ? 1 : 0 ;
+        std::pair<std::unordered_map<CleMateriau, int, HachageMateriau>::iterator, bool> r =
+            ids.emplace(cle, static_cast<int>(albedos.size())) ;
+        if (r.second) {
+            albedos.push_back(albedo) ;
+            miroirs.push_back(cle.miroir_) ;
+        }
+        material_ids[i] = r.first->second ;
+    }
+    std::vector<float> albedos_rgb ;
+    for (const Vector3f & albedo : albedos) {
+        albedos_rgb.push_back(albedo.get_x()) ;
+        albedos_rgb.push_back(albedo.get_y()) ;
+        albedos_rgb.push_back(albedo.get_z()) ;
+    }
+
+    // -- Primitives, dans l'ordre des feuilles du Bvh
+    std::vector<float> sphere_x, sphere_y, sphere_z, sphere_radius ;
+    std::vector<int> sphere_shape ;
+    std::vector<float> quad_x0, quad_y0, quad_z0, quad_x1, quad_y1, quad_z1 ;
+    std::vector<int> quad_shape ;
+    std::vector<int> other_shape ;
+    std::vector<unsigned char> shape_type(shapes.size()) ;
+    std::vector<int> shape_slot(shapes.size()) ;
+
+    int n = bvh.get_nb_primitives() ;
+    std::vector<int> sphere_start(n + 1), quad_start(n + 1), other_start(n + 1) ;
+    for (int k = 0 ; k < n ; k++) {
+        sphere_start[k] = static_cast<int>(sphere_shape.size()) ;
+        quad_start[k] = static_cast<int>(quad_shape.size()) ;
+        other_start[k] = static_cast<int>(other_shape.size()) ;
+
+        int i = bvh.get_index(k) ;
+        const Shape * shape = shapes[i] ;
+        if (const Sphere * s = dynamic_cast<const Sphere*>(shape)) {
+            shape_type[i] = TYPE_SPHERE ;
+            shape_slot[i] = static_cast<int>(sphere_shape.size()) ;
+            sphere_x.push_back(s->get_origin().get_x()) ;
+            sphere_y.push_back(s->get_origin().get_y()) ;
+            sphere_z.push_back(s->get_origin().get_z()) ;
+            sphere_radius.push_back(s->get_radius()) ;
+            sphere_shape.push_back(i) ;
+        }
+        else if (const Quad * q = dynamic_cast<const Quad*>(shape)) {
+            // Les coins rangés par coordonnée, comme dans Quad::is_hit
+            BoundingBox box = q->bounding_box() ;
+            Vector3f b0 = box.get_min() ;
+            Vector3f b1 = box.get_max() ;
+            shape_type[i] = TYPE_QUAD ;
+            shape_slot[i] = static_cast<int>(quad_shape.size()) ;
+            quad_x0.push_back(b0.get_x()) ;
+            quad_y0.push_back(b0.get_y()) ;
+            quad_z0.push_back(b0.get_z()) ;
+            quad_x1.push_back(b1.get_x()) ;
+            quad_y1.push_back(b1.get_y()) ;
+            quad_z1.push_back(b1.get_z()) ;
+            quad_shape.push_back(i) ;
+        }
+        else {
+            shape_type[i] = TYPE_OTHER ;
+            shape_slot[i] = static_cast<int>(other_shape.size()) ;
+            other_.push_back(shape) ;
+            other_shape.push_back(i) ;
+        }
+    }
+    sphere_start[n] = static_cast<int>(sphere_shape.size()) ;
+    quad_start[n] = static_cast<int>(quad_shape.size()) ;
+    other_start[n] = static_cast<int>(other_shape.size()) ;
+
+    // -- Plans, rangés par move_planes_to_end après les formes du Bvh
+    std::vector<float> plane_nx, plane_ny, plane_nz, plane_d ;
+    std::vector<int> plane_shape ;
+    for (size_t i = static_cast<size_t>(n) ; i < shapes.size() ; i++) {
+        const Plane * p = dynamic_cast<const Plane*>(shapes[i]) ;
+        if (p == nullptr) {
+            continue ;
+        }
+        shape_type[i] = TYPE_PLANE ;
+        shape_slot[i] = static_cast<int>(plane_shape.size()) ;
+        plane_nx.push_back(p->get_normal().get_x()) ;
+        plane_ny.push_back(p->get_normal().get_y()) ;
+        plane_nz.push_back(p->get_normal().get_z()) ;
+        plane_d.push_back(p->get_distance()) ;
+        plane_shape.push_back(static_cast<int>(i)) ;
+    }
+
+    // Les tableaux construits deviennent ceux de la scène compilée, sans copie
+    sphere_x_ = MappedArray<float>(std::move(sphere_x)) ;
+    sphere_y_ = MappedArray<float>(std::move(sphere_y)) ;
+    sphere_z_ = MappedArray<float>(std::move(sphere_z)) ;
+    sphere_radius_ = MappedArray<float>(std::move(sphere_radius)) ;
+    sphere_shape_ = MappedArray<int>(std::move(sphere_shape)) ;
+    quad_x0_ = MappedArray<float>(std::move(quad_x0)) ;
+    quad_y0_ = MappedArray<float>(std::move(quad_y0)) ;
+    quad_z0_ = MappedArray<float>(std::move(quad_z0)) ;
+    quad_x1_ = MappedArray<float>(std::move(quad_x1)) ;
+    quad_y1_ = MappedArray<float>(std::move(quad_y1)) ;
+    quad_z1_ = MappedArray<float>(std::move(quad_z1)) ;
+    quad_shape_ = MappedArray<int>(std::move(quad_shape)) ;
+    plane_nx_ = MappedArray<float>(std::move(plane_nx)) ;
+    plane_ny_ = MappedArray<float>(std::move(plane_ny)) ;
+    plane_nz_ = MappedArray<float>(std::move(plane_nz)) ;
+    plane_d_ = MappedArray<float>(std::move(plane_d)) ;
+    plane_shape_ = MappedArray<int>(std::move(plane_shape)) ;
+    other_shape_ = MappedArray<int>(std::move(other_shape)) ;
+    sphere_start_ = MappedArray<int>(std::move(sphere_start)) ;
+    quad_start_ = MappedArray<int>(std::move(quad_start)) ;
+    other_start_ = MappedArray<int>(std::move(other_start)) ;
+    shape_type_ = MappedArray<unsigned char>(std::move(shape_type)) ;
+    shape_slot_ = MappedArray<int>(std::move(shape_slot)) ;
+    material_ids_ = MappedArray<int>(std::move(material_ids)) ;
+    albedos_ = MappedArray<float>(std::move(albedos_rgb)) ;
+    miroirs_ = MappedArray<unsigned char>(std::move(miroirs)) ;
+}
+
+void CompiledScene::finalize_hit(const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const {
+    int slot = shape_slot_[hit.shape_id_] ;
+    switch (shape_type_[hit.shape_id_]) {
+        case TYPE_SPHERE :
+            // Comme Sphere::finalize_hit
+            *P = ray.get_centre() + hit.t_*ray.get_direction() ;
+            *N = (*P - Vector3f(sphere_x_[slot], sphere_y_[slot], sphere_z_[slot])) ;
+            N->normalize() ;
+            break ;
+        case TYPE_QUAD :
+            // Comme Quad::finalize_hit : la face touchée est dans primitive_
+            *P = ray.get_centre() + hit.t_*ray.get_direction() ;
+            *N = Quad::face_normal(hit.primitive_) ;
+            break ;
+        case TYPE_PLANE : {
+            // Comme Plane::finalize_hit
+            *P = ray.get_centre() + hit.t_*ray.get_direction() ;
+            Vector3f normale(plane_nx_[slot], plane_ny_[slot], plane_nz_[slot]) ;
+            *N = (dot(normale, ray.get_direction()) > 0.0f) ? -1.0f * normale : normale ;
+            break ;
+        }
+        default :
+            other_[slot]->finalize_hit(ray, hit, P, N) ;
+            break ;
+    }
+}
+
+// Les noyaux suivants refont exactement les calculs de Sphere::is_hit, Quad::is_hit et Plane::is_hit, dans le même
+// ordre, pour que l'image soit identique. Ils indiquent s'il y a intersection et en donnent la distance dans t.
+
+static inline bool sphere_hit(float ox, float oy, float oz, float dx, float dy, float dz,
+                              float cx, float cy, float cz, float r, float * t) {
+    float ocx = ox - cx ;
+    float ocy = oy - cy ;
+    float ocz = oz - cz ;
+    // a = 1 car la direction du rayon est unitaire
+    float b = 2.0 * (dx * ocx + dy * ocy + dz * ocz) ;
+    float c = (ocx * ocx + ocy * ocy + ocz * ocz) - r * r ;
+    float discriminant = b * b - 4.0f * c ;
+    if (discriminant < 0.0f) {
+        return false ;
+    }
+    float racine = std::sqrt(discriminant) ;
+    float t1 = (-b - racine) / 2.0 ;
+    float t2 = (-b + racine) / 2.0 ;
+    if (t2 < 0.0f) {
+        return false ;
+    }
+    *t = (t1 > 0.0f) ? t1 : t2 ;
+    return true ;
+}
+
+static inline bool quad_hit(const float o[3], const float inv[3],
+                            float x0, float y0, float z0, float x1, float y1, float z1, float * t, int * face) {
+    const float lo[3] = { x0, y0, z0 } ;
+    const float hi[3] = { x1, y1, z1 } ;
+    return Quad::slab_hit(o, inv, lo, hi, t, face) ;
+}
+
+// Un rayon parallèle au plan divise par 0 : l'infini ou le NaN obtenu échoue à la comparaison t > 0 && t < t_max
+static inline float plane_distance(float ox, float oy, float oz, float dx, float dy, float dz,
+                                   float nx, float ny, float nz, float d) {
+    float cosinus = nx * dx + ny * dy + nz * dz ;
+    return (d - (nx * ox + ny * oy + nz * oz)) / cosinus ;
+}
+
+void CompiledScene::intersect(const Ray3f & ray, int first, int count, HitRecord * closest) const {
+    float ox = ray.get_centre().get_x(), oy = ray.get_centre().get_y(), oz = ray.get_centre().get_z() ;
+    float dx = ray.get_direction().get_x(), dy = ray.get_direction().get_y(), dz = ray.get_direction().get_z() ;
+    const float o[3] = { ox, oy, oz } ;
+    const float inv[3] = { slab_inverse(dx), slab_inverse(dy), slab_inverse(dz) } ;
+    float t ;
+    int face ;
+
+    for (int i = sphere_start_[first] ; i < sphere_start_[first + count] ; i++) {
+        RT_STAT(shape_tests_) ;
+        if (sphere_hit(ox, oy, oz, dx, dy, dz, sphere_x_[i], sphere_y_[i], sphere_z_[i], sphere_radius_[i], &t) && t < closest->t_) {
+            closest->t_ = t ;
+            closest->shape_id_ = sphere_shape_[i] ;
+            closest->primitive_ = 0 ;
+        }
+    }
+    for (int i = quad_start_[first] ; i < quad_start_[first + count] ; i++) {
+        RT_STAT(shape_tests_) ;
+        if (quad_hit(o, inv, quad_x0_[i], quad_y0_[i], quad_z0_[i], quad_x1_[i], quad_y1_[i], quad_z1_[i], &t, &face)
+            && t < closest->t_) {
+            closest->t_ = t ;
+            closest->shape_id_ = quad_shape_[i] ;
+            closest->primitive_ = face ;
+        }
+    }
+    for (int i = other_start_[first] ; i < other_start_[first + count] ; i++) {
+        RT_STAT(shape_tests_) ;
+        HitRecord hit = other_[i]->is_hit(ray) ;
+        if (hit.hit() && hit.t_ < closest->t_) {
+            *closest = hit ;
+            closest->shape_id_ = other_shape_[i] ;
+        }
+    }
+}
+
+// Note les voies de masque où un rayon du paquet trouve une intersection plus proche, et leur primitive
+static inline void update_packet_hit(PacketHit * closest, PacketFloat masque, PacketFloat t, int shape_id,
+                                     PacketFloat primitive = PacketFloat(0.0f)) {
+    int m = packet_mask(masque) ;
+    if (m == 0) {
+        return ;
+    }
+    closest->t_ = packet_select(masque, closest->t_, t) ;
+    float p[PACKET_SIZE] ;
+    primitive.store(p) ;
+    for (int i = 0 ; i < PACKET_SIZE ; i++) {
+        if ((m >> i) & 1) {
+            closest->shape_id_[i] = shape_id ;
+            closest->primitive_[i] = static_cast<int>(p[i]) ;
+        }
+    }
+}
+
+void CompiledScene::intersect_packet(const RayPacket & packet, int first, int count, PacketHit * closest) const {
+    const PacketFloat zero(0.0f), un(1.0f), deux(2.0f), trois(3.0f), quatre(4.0f), cinq(5.0f) ;
+
+    for (int i = sphere_start_[first] ; i < sphere_start_[first + count] ; i++) {
+        RT_STAT(shape_tests_) ;
+        // Les mêmes calculs que sphere_hit, sur tous les rayons du paquet
+        PacketFloat ocx = packet.ox_ - PacketFloat(sphere_x_[i]) ;
+        PacketFloat ocy = packet.oy_ - PacketFloat(sphere_y_[i]) ;
+        PacketFloat ocz = packet.oz_ - PacketFloat(sphere_z_[i]) ;
+        PacketFloat r(sphere_radius_[i]) ;
+        PacketFloat b = PacketFloat(2.0f) * (packet.dx_ * ocx + packet.dy_ * ocy + packet.dz_ * ocz) ;
+        PacketFloat c = (ocx * ocx + ocy * ocy + ocz * ocz) - r * r ;
+        PacketFloat discriminant = b * b - PacketFloat(4.0f) * c ;
+        PacketFloat racine = packet_sqrt(discriminant) ;
+        // -0 - b est exactement -b, zéro compris
+        PacketFloat moins_b = PacketFloat(-0.0f) - b ;
+        PacketFloat t1 = (moins_b - racine) / PacketFloat(2.0f) ;
+        PacketFloat t2 = (moins_b + racine) / PacketFloat(2.0f) ;
+        PacketFloat t = packet_select(zero < t1, t2, t1) ;
+        PacketFloat touche = packet_not(discriminant < zero) & packet_not(t2 < zero) & (t < closest->t_) ;
+        update_packet_hit(closest, touche, t, sphere_shape_[i]) ;
+    }
+    for (int i = quad_start_[first] ; i < quad_start_[first + count] ; i++) {
+        RT_STAT(shape_tests_) ;
+        // Les mêmes calculs que Quad::slab_hit, sur tous les rayons du paquet ; la face est gardée en flottant
+        PacketFloat tx1 = (PacketFloat(quad_x0_[i]) - packet.ox_) * packet.inv_dx_ ;
+        PacketFloat tx2 = (PacketFloat(quad_x1_[i]) - packet.ox_) * packet.inv_dx_ ;
+        PacketFloat ty1 = (PacketFloat(quad_y0_[i]) - packet.oy_) * packet.inv_dy_ ;
+        PacketFloat ty2 = (PacketFloat(quad_y1_[i]) - packet.oy_) * packet.inv_dy_ ;
+        PacketFloat tz1 = (PacketFloat(quad_z0_[i]) - packet.oz_) * packet.inv_dz_ ;
+        PacketFloat tz2 = (PacketFloat(quad_z1_[i]) - packet.oz_) * packet.inv_dz_ ;
+        PacketFloat t_entree = packet_min(tx1, tx2), t_sortie = packet_max(tx1, tx2) ;
+        PacketFloat face_entree = packet_select(packet.inv_dx_ < zero, zero, un) ;
+        PacketFloat face_sortie = packet_select(packet.inv_dx_ < zero, un, zero) ;
+        PacketFloat ty_min = packet_min(ty1, ty2), ty_max = packet_max(ty1, ty2) ;
+        PacketFloat plus_loin = t_entree < ty_min ;
+        PacketFloat plus_pres = ty_max < t_sortie ;
+        t_entree = packet_select(plus_loin, t_entree, ty_min) ;
+        t_sortie = packet_select(plus_pres, t_sortie, ty_max) ;
+        face_entree = packet_select(plus_loin, face_entree, packet_select(packet.inv_dy_ < zero, deux, trois)) ;
+        face_sortie = packet_select(plus_pres, face_sortie, packet_select(packet.inv_dy_ < zero, trois, deux)) ;
+        PacketFloat tz_min = packet_min(tz1, tz2), tz_max = packet_max(tz1, tz2) ;
+        plus_loin = t_entree < tz_min ;
+        plus_pres = tz_max < t_sortie ;
+        t_entree = packet_select(plus_loin, t_entree, tz_min) ;
+        t_sortie = packet_select(plus_pres, t_sortie, tz_max) ;
+        face_entree = packet_select(plus_loin, face_entree, packet_select(packet.inv_dz_ < zero, quatre, cinq)) ;
+        face_sortie = packet_select(plus_pres, face_sortie, packet_select(packet.inv_dz_ < zero, cinq, quatre)) ;
+        // Une origine dans la boîte touche la face de sortie
+        PacketFloat dedans = t_entree < zero ;
+        PacketFloat t = packet_select(dedans, t_entree, t_sortie) ;
+        PacketFloat face = packet_select(dedans, face_entree, face_sortie) ;
+        PacketFloat touche = packet_not(t_sortie < t_entree) & packet_not(t_sortie < zero) & (t < closest->t_) ;
+        update_packet_hit(closest, touche, t, quad_shape_[i], face) ;
+    }
+    if (other_start_[first] < other_start_[first + count]) {
+        float t[PACKET_SIZE] ;
+        closest->t_.store(t) ;
+        for (int i = other_start_[first] ; i < other_start_[first + count] ; i++) {
+            for (int k = 0 ; k < PACKET_SIZE ; k++) {
+                if (!((packet.active_ >> k) & 1)) {
+                    continue ;
+                }
+                RT_STAT(shape_tests_) ;
+                HitRecord hit = other_[i]->is_hit(packet.rays_[k]) ;
+                if (hit.hit() && hit.t_ < t[k]) {
+                    t[k] = hit.t_ ;
+                    closest->shape_id_[k] = other_shape_[i] ;
+                    closest->primitive_[k] = hit.primitive_ ;
+                }
+            }
+        }
+        closest->t_ = PacketFloat::load(t) ;
+    }
+}
+
+bool CompiledScene::occluded(const Ray3f & ray, int first, int count, float t_max) const {
+    float ox = ray.get_centre().get_x(), oy = ray.get_centre().get_y(), oz = ray.get_centre().get_z() ;
+    float dx = ray.get_direction().get_x(), dy = ray.get_direction().get_y(), dz = ray.get_direction().get_z() ;
+    const float o[3] = { ox, oy, oz } ;
+    const float inv[3] = { slab_inverse(dx), slab_inverse(dy), slab_inverse(dz) } ;
+    float t ;
+    int face ;
+
+    for (int i = sphere_start_[first] ; i < sphere_start_[first + count] ; i++) {
+        RT_STAT(shape_tests_) ;
+        if (sphere_hit(ox, oy, oz, dx, dy, dz, sphere_x_[i], sphere_y_[i], sphere_z_[i], sphere_radius_[i], &t) && t < t_max) {
+            return true ;
+        }
+    }
+    for (int i = quad_start_[first] ; i < quad_start_[first + count] ; i++) {
+        RT_STAT(shape_tests_) ;
+        if (quad_hit(o, inv, quad_x0_[i], quad_y0_[i], quad_z0_[i], quad_x1_[i], quad_y1_[i], quad_z1_[i], &t, &face)
+            && t < t_max) {
+            return true ;
+        }
+    }
+    for (int i = other_start_[first] ; i < other_start_[first + count] ; i++) {
+        RT_STAT(shape_tests_) ;
+        HitRecord hit = other_[i]->is_hit(ray) ;
+        if (hit.hit() && hit.t_ < t_max) {
+            return true ;
+        }
+    }
+    return false ;
+}
+
+void CompiledScene::intersect_planes(const Ray3f & ray, HitRecord * closest) const {
+    float ox = ray.get_centre().get_x(), oy = ray.get_centre().get_y(), oz = ray.get_centre().get_z() ;
+    float dx = ray.get_direction().get_x(), dy = ray.get_direction().get_y(), dz = ray.get_direction().get_z() ;
+    RT_STAT_N(shape_tests_, plane_shape_.size()) ;
+    for (size_t i = 0 ; i < plane_shape_.size() ; i++) {
+        float t = plane_distance(ox, oy, oz, dx, dy, dz, plane_nx_[i], plane_ny_[i], plane_nz_[i], plane_d_[i]) ;
+        if (t > 0.0f && t < closest->t_) {
+            closest->t_ = t ;
+            closest->shape_id_ = plane_shape_[i] ;
+            closest->primitive_ = 0 ;
+        }
+    }
+}
+
+bool CompiledScene::occluded_planes(const Ray3f & ray, float t_max) const {
+    float ox = ray.get_centre().get_x(), oy = ray.get_centre().get_y(), oz = ray.get_centre().get_z() ;
+    float dx = ray.get_direction().get_x(), dy = ray.get_direction().get_y(), dz = ray.get_direction().get_z() ;
+    RT_STAT_N(shape_tests_, plane_shape_.size()) ;
+    for (size_t i = 0 ; i < plane_shape_.size() ; i++) {
+        float t = plane_distance(ox, oy, oz, dx, dy, dz, plane_nx_[i], plane_ny_[i], plane_nz_[i], plane_d_[i]) ;
+        if (t > 0.0f && t < t_max) {
+            return true ;
+        }
+    }
+    return false ;
+}
+
+void CompiledScene::intersect_planes_packet(const RayPacket & packet, PacketHit * closest) const {
+    const PacketFloat zero(0.0f) ;
+    RT_STAT_N(shape_tests_, plane_shape_.size()) ;
+    for (size_t i = 0 ; i < plane_shape_.size() ; i++) {
+        // Les mêmes calculs que plane_distance, sur tous les rayons du paquet
+        PacketFloat nx(plane_nx_[i]), ny(plane_ny_[i]), nz(plane_nz_[i]) ;
+        PacketFloat cosinus = nx * packet.dx_ + ny * packet.dy_ + nz * packet.dz_ ;
+        PacketFloat t = (PacketFloat(plane_d_[i]) - (nx * packet.ox_ + ny * packet.oy_ + nz * packet.oz_)) / cosinus ;
+        update_packet_hit(closest, (zero < t) & (t < closest->t_), t, plane_shape_[i]) ;
+    }
+}
@@ -0,0 +1,280 @@
+#ifndef COMPILEDSCENE_H
+#define COMPILEDSCENE_H
+
+#include "Shape.h"
+#include "Bvh.h"
+#include "Ray3f.h"
+#include "Vector3f.h"
+#include "Packet.h"
+#include "MappedArray.h"
+#include <vector>
+
+/**
+ * @brief Les intersections les plus proches des rayons d'un paquet, comme un HitRecord par voie
+ * 
+ * @see HitRecord, RayPacket
+*/
+struct PacketHit {
+    /**
+     * @brief La distance de l'intersection la plus proche de chaque rayon
+    */
+    PacketFloat t_ ;
+    /**
+     * @brief L'indice dans Scene::shapes_ de la forme intersectée par chaque rayon, -1 s'il n'y en a pas
+    */
+    int shape_id_[PACKET_SIZE] ;
+    /**
+     * @brief La primitive intersectée par chaque rayon, -1 s'il n'y en a pas
+    */
+    int primitive_[PACKET_SIZE] ;
+} ;
+
+/**
+ * @brief La classe CompiledScene range les formes de la scène par type, en tableaux contigus (structure de tableaux)
+ * 
+ * Elle est construite une seule fois, avant le rendu, à partir des formes et du Bvh de la scène.
+ * Les sphères et les quads sont copiés dans des tableaux de flottants, un par coordonnée, rangés dans l'ordre
+ * des feuilles du Bvh : chaque feuille correspond à un intervalle contigu de chaque tableau. Les intersections
+ * d'une feuille sont alors des boucles serrées sur ces tableaux, sans appel virtuel ni saut dans le tas.
+ * Les formes d'un autre type sont testées par leur méthode virtuelle is_hit.
+ * 
+ * Les plans, infinis, ne sont pas dans le Bvh : ils sont rangés à part et testés avant chaque parcours, ce qui
+ * donne tout de suite une distance maximale aux rayons qui sortent d'une pièce fermée.
+ * 
+ * Les couleurs et les miroirs sont rangés par matériau, chaque forme ayant un identifiant de matériau.
+ * 
+ * @see Bvh, Sphere, Quad, Plane
+*/
+class CompiledScene {
+    friend class SceneCache ;
+
+    private :
+        /**
+         * @brief Les centres et rayons des sphères, dans l'ordre des feuilles du Bvh
+        */
+        MappedArray<float> sphere_x_, sphere_y_, sphere_z_, sphere_radius_ ;
+        /**
+         * @brief L'indice dans Scene::shapes_ de chaque sphère
+        */
+        MappedArray<int> sphere_shape_ ;
+        /**
+         * @brief Les coins des boîtes des quads, rangés par coordonnée (x0 <= x1...), dans l'ordre des feuilles du Bvh
+        */
+        MappedArray<float> quad_x0_, quad_y0_, quad_z0_, quad_x1_, quad_y1_, quad_z1_ ;
+        /**
+         * @brief L'indice dans Scene::shapes_ de chaque quad
+        */
+        MappedArray<int> quad_shape_ ;
+        /**
+         * @brief Les normales et les distances à l'origine des plans (Plane::get_distance)
+        */
+        MappedArray<float> plane_nx_, plane_ny_, plane_nz_, plane_d_ ;
+        /**
+         * @brief L'indice dans Scene::shapes_ de chaque plan
+        */
+        MappedArray<int> plane_shape_ ;
+        /**
+         * @brief Les formes d'un autre type, testées par un appel virtuel
+        */
+        std::vector<const Shape*> other_ ;
+        /**
+         * @brief L'indice dans Scene::shapes_ de chaque autre forme
+        */
+        MappedArray<int> other_shape_ ;
+        /**
+         * @brief Pour chaque position k de l'ordre des feuilles du Bvh, le nombre de sphères, de quads et
+         * d'autres formes placées avant k (un élément de plus que de primitives)
+        */
+        MappedArray<int> sphere_start_, quad_start_, other_start_ ;
+        /**
+         * @brief Le type de chaque forme (TYPE_SPHERE, TYPE_QUAD, TYPE_OTHER ou TYPE_PLANE), indexé comme Scene::shapes_
+        */
+        MappedArray<unsigned char> shape_type_ ;
+        /**
+         * @brief La place de chaque forme dans les tableaux de son type, indexée comme Scene::shapes_
+        */
+        MappedArray<int> shape_slot_ ;
+        /**
+         * @brief L'identifiant de matériau de chaque forme, indexé comme Scene::shapes_
+        */
+        MappedArray<int> material_ids_ ;
+        /**
+         * @brief L'albédo de chaque matériau, trois flottants (r, g, b) par matériau
+        */
+        MappedArray<float> albedos_ ;
+        /**
+         * @brief Pour chaque matériau, 1 s'il est un miroir, 0 sinon
+        */
+        MappedArray<unsigned char> miroirs_ ;
+
+    public :
+        /**
+         * @brief Les valeurs de shape_type_
+        */
+        static const unsigned char TYPE_SPHERE = 0 ;
+        static const unsigned char TYPE_QUAD = 1 ;
+        static const unsigned char TYPE_OTHER = 2 ;
+        static const unsigned char TYPE_PLANE = 3 ;
+
+        /**
+         * @brief Déplace les plans après les autres formes, sans changer l'ordre des unes ni des autres
+         * 
+         * Les indices des formes changent : à appeler avant bounded_boxes et build, qui attendent cet ordre.
+         * 
+         * @param shapes : référence vers les formes de la scène, réordonnées
+         * @see Plane
+        */
+        static void move_planes_to_end(std::vector<Shape*> & shapes) ;
+        /**
+         * @brief Donne les boîtes des formes qui ne sont pas des plans, pour construire le Bvh
+         * 
+         * @param shapes : référence vers les formes de la scène, rangées par move_planes_to_end
+         * 
+         * @return Les boîtes englobantes des formes qui ne sont pas des plans, dans l'ordre de shapes
+         * @see Plane
+        */
+        static std::vector<BoundingBox> bounded_boxes(const std::vector<Shape*> & shapes) ;
+
+        /**
+         * @brief Construit les tableaux à partir des formes et du Bvh construit sur elles
+         * 
+         * @param shapes : référence vers les formes de la scène, rangées par move_planes_to_end
+         * @param bvh : référence vers le Bvh construit sur les boîtes données par bounded_boxes
+        */
+        void build(const std::vector<Shape*> & shapes, const Bvh & bvh) ;
+
+        /**
+         * @brief Cherche l'intersection la plus proche parmi les primitives d'une feuille du Bvh
+         * 
+         * Donne exactement les mêmes intersections que Sphere::is_hit et Quad::is_hit (dont la face touchée).
+         * 
+         * @param ray : référence vers le rayon
+         * @param first : la position de la première primitive de la feuille dans l'ordre du Bvh
+         * @param count : le nombre de primitives de la feuille
+         * @param closest : pointeur vers l'intersection la plus proche trouvée, mise à jour si une primitive est plus proche
+         * @see HitRecord
+        */
+        void intersect(const Ray3f & ray, int first, int count, HitRecord * closest) const ;
+        /**
+         * @brief Cherche l'intersection la plus proche parmi les plans
+         * 
+         * @param ray : référence vers le rayon
+         * @param closest : pointeur vers l'intersection la plus proche trouvée, mise à jour si un plan est plus proche
+         * @see HitRecord
+        */
+        void intersect_planes(const Ray3f & ray, HitRecord * closest) const ;
+        /**
+         * @brief Indique si un des plans coupe le rayon avant t_max
+         * 
+         * @param ray : référence vers le rayon
+         * @param t_max : la distance maximale le long du rayon
+         * 
+         * @return true s'il y a une intersection avant t_max
+        */
+        bool occluded_planes(const Ray3f & ray, float t_max) const ;
+        /**
+         * @brief Cherche, pour chaque rayon d'un paquet, l'intersection la plus proche parmi les plans
+         * 
+         * @param packet : référence vers le paquet de rayons
+         * @param closest : pointeur vers les intersections les plus proches trouvées, mises à jour voie par voie
+         * @see RayPacket, PacketHit
+        */
+        void intersect_planes_packet(const RayPacket & packet, PacketHit * closest) const ;
+        /**
+         * @brief Indique si une des primitives d'une feuille du Bvh coupe le rayon avant t_max
+         * 
+         * @param ray : référence vers le rayon
+         * @param first : la position de la première primitive de la feuille dans l'ordre du Bvh
+         * @param count : le nombre de primitives de la feuille
+         * @param t_max : la distance maximale le long du rayon
+         * 
+         * @return true s'il y a une intersection avant t_max
+        */
+        bool occluded(const Ray3f & ray, int first, int count, float t_max) const ;
+        /**
+         * @brief Cherche, pour chaque rayon d'un paquet, l'intersection la plus proche parmi les primitives d'une feuille
+         * 
+         * Les sphères et les quads sont testés sur tous les rayons à la fois, une voie SIMD par rayon ; chaque voie
+         * fait exactement les calculs de intersect. Les autres formes sont testées rayon par rayon.
+         * 
+         * @param packet : référence vers le paquet de rayons
+         * @param first : la position de la première primitive de la feuille dans l'ordre du Bvh
+         * @param count : le nombre de primitives de la feuille
+         * @param closest : pointeur vers les intersections les plus proches trouvées, mises à jour voie par voie
+         * @see RayPacket, PacketHit
+        */
+        void intersect_packet(const RayPacket & packet, int first, int count, PacketHit * closest) const ;
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par intersect
+         *
+         * Donne exactement les mêmes P et N que Sphere::finalize_hit, Quad::finalize_hit et Plane::finalize_hit,
+         * sans avoir besoin des formes elles-mêmes : une scène relue d'un cache peut donc être rendue sans
+         * Scene::shapes_.
+         * Les formes d'un autre type passent par leur méthode virtuelle.
+         *
+         * @param ray : référence vers le rayon
+         * @param hit : référence vers l'intersection, dont shape_id_ indique la forme
+         * @param P : pointeur vers le point d'intersection
+         * @param N : pointeur vers la normale au point d'intersection
+         * @see Shape::finalize_hit
+        */
+        void finalize_hit(const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const ;
+
+        /**
+         * @brief Donne l'albédo de la forme shape_id
+         * 
+         * @param shape_id : l'indice de la forme dans Scene::shapes_
+         * 
+         * @return L'albédo du matériau de la forme
+        */
+        Vector3f get_albedo(int shape_id) const {
+            const float * albedo = albedos_.data() + 3 * material_ids_[shape_id] ;
+            return Vector3f(albedo[0], albedo[1], albedo[2]) ;
+        }
+        /**
+         * @brief Indique si la forme shape_id est un miroir
+         * 
+         * @param shape_id : l'indice de la forme dans Scene::shapes_
+         * 
+         * @return true si le matériau de la forme est un miroir
+        */
+        bool get_miroir(int shape_id) const { return miroirs_[material_ids_[shape_id]] != 0 ; }
+        /**
+         * @brief Donne le nombre de matériaux différents de la scène
+         * 
+         * @return Le nombre de matériaux
+        */
+        int get_nb_materials() const { return static_cast<int>(miroirs_.size()) ; }
+        /**
+         * @brief Donne le nombre de sphères
+         * 
+         * @return Le nombre de sphères rangées dans les tableaux
+        */
+        int get_nb_spheres() const { return static_cast<int>(sphere_shape_.size()) ; }
+        /**
+         * @brief Donne le nombre de quads
+         * 
+         * @return Le nombre de quads rangés dans les tableaux
+        */
+        int get_nb_quads() const { return static_cast<int>(quad_shape_.size()) ; }
+        /**
+         * @brief Donne le nombre de plans
+         * 
+         * @return Le nombre de plans rangés dans les tableaux
+        */
+        int get_nb_planes() const { return static_cast<int>(plane_shape_.size()) ; }
+        /**
+         * @brief Donne le nombre de formes d'un autre type
+         *
+         * @return Le nombre de formes testées par un appel virtuel
+        */
+        int get_nb_others() const { return static_cast<int>(other_shape_.size()) ; }
+        /**
+         * @brief Donne le nombre de formes de la scène
+         *
+         * @return Le nombre de formes, tous types confondus
+        */
+        int get_nb_shapes() const { return static_cast<int>(material_ids_.size()) ; }
+} ;
+
+#endif
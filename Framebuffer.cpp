@@ -0,0 +1,82 @@
+#include "Framebuffer.h"
+#include "Trace.h"
+#include "Image.h"
+#include <cmath>
+#include <limits>
+
+Framebuffer::Framebuffer() {
+    width_ = 0 ;
+    height_ = 0 ;
+}
+
+Framebuffer::Framebuffer(int width, int height) {
+    resize(width, height) ;
+}
+
+void Framebuffer::resize(int width, int height) {
+    width_ = width ;
+    height_ = height ;
+    pixels_.assign(3 * static_cast<size_t>(width) * height, 0.0f) ;
+}
+
+void Framebuffer::set_pixel(int x, int y, const Material & color) {
+    float * p = get_pixel(x, y) ;
+    p[0] = color.get_r() ;
+    p[1] = color.get_g() ;
+    p[2] = color.get_b() ;
+}
+
+// Table des seuils de la correction gamma : seuils[k] est la plus petite composante c
+// telle que c^(1/2.2) >= k, c'est-à-dire la plus petite composante qui donne la valeur 8 bits k
+static const float * gamma_thresholds() {
+    static float seuils[256] ;
+    static bool init = false ;
+    if (!init) {
+        seuils[0] = -std::numeric_limits<float>::infinity() ;
+        for (int k = 1 ; k < 256 ; k++) {
+            float c = static_cast<float>(std::pow(static_cast<double>(k), 2.2)) ;
+            // On ajuste à l'ulp près pour retrouver exactement le résultat de pow
+            while (std::pow(static_cast<double>(c), 1/2.2) < k) {
+                c = std::nextafter(c, std::numeric_limits<float>::infinity()) ;
+            }
+            while (std::pow(static_cast<double>(std::nextafter(c, 0.0f)), 1/2.2) >= k) {
+                c = std::nextafter(c, 0.0f) ;
+            }
+            seuils[k] = c ;
+        }
+        init = true ;
+    }
+    return seuils ;
+}
+
+void Framebuffer::to_rgb8(std::vector<unsigned char> & rgb) const {
+    RT_TRACE("correction gamma") ;
+    // Initialisation de la table avant toute utilisation (thread-safe en C++11)
+    static const float * seuils = gamma_thresholds() ;
+
+    size_t n = pixels_.size() ;
+    rgb.resize(n) ;
+    const float * src = pixels_.data() ;
+    unsigned char * dst = rgb.data() ;
+    for (size_t i = 0 ; i < n ; i++) {
+        float c = src[i] ;
+        // Dichotomie sans branchement : k est le plus grand indice tel que seuils[k] <= c
+        // Les composantes négatives ou NaN donnent 0, celles au-delà de 255^2.2 donnent 255
+        int k = 0 ;
+        k += (c >= seuils[k + 128]) ? 128 : 0 ;
+        k += (c >= seuils[k + 64]) ? 64 : 0 ;
+        k += (c >= seuils[k + 32]) ? 32 : 0 ;
+        k += (c >= seuils[k + 16]) ? 16 : 0 ;
+        k += (c >= seuils[k + 8]) ? 8 : 0 ;
+        k += (c >= seuils[k + 4]) ? 4 : 0 ;
+        k += (c >= seuils[k + 2]) ? 2 : 0 ;
+        k += (c >= seuils[k + 1]) ? 1 : 0 ;
+        dst[i] = static_cast<unsigned char>(k) ;
+    }
+}
+
+bool Framebuffer::save(const std::string & filename) const {
+    std::vector<unsigned char> rgb ;
+    to_rgb8(rgb) ;
+    return save_image(filename, width_, height_, rgb) ;
+}
@@ -0,0 +1,125 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "Material.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief La classe Framebuffer est l'image calculée par le lancer de rayons, en couleurs linéaires flottantes
+ * 
+ * Les pixels sont rangés de façon contiguë, ligne par ligne, trois flottants (r, g, b) par pixel, sans
+ * limite de valeur (HDR). La correction gamma et la conversion en 8 bits ne sont faites qu'une fois,
+ * en une seule passe sur tout le tableau, au moment d'afficher ou d'enregistrer l'image.
+*/
+class Framebuffer {
+    private :
+        /**
+         * @brief La largeur de l'image
+        */
+        int width_ ;
+        /**
+         * @brief La hauteur de l'image
+        */
+        int height_ ;
+        /**
+         * @brief Les composantes des pixels, ligne par ligne, 3 flottants par pixel
+        */
+        std::vector<float> pixels_ ;
+
+    public :
+        /**
+         * @brief Constructeur par défaut
+         * 
+         * Crée une image vide, de taille 0
+        */
+        Framebuffer() ;
+        /**
+         * @brief Constructeur paramétré
+         * 
+         * Crée une image noire de la taille donnée
+         * 
+         * @param width : la largeur de l'image
+         * @param height : la hauteur de l'image
+        */
+        Framebuffer(int width, int height) ;
+
+        /**
+         * @brief Getter de l'attribut width_
+         * 
+         * @return L'attribut width_ de la classe
+        */
+        int get_width() const { return width_ ; }
+        /**
+         * @brief Getter de l'attribut height_
+         * 
+         * @return L'attribut height_ de la classe
+        */
+        int get_height() const { return height_ ; }
+        /**
+         * @brief Getter de l'attribut pixels_
+         * 
+         * @return Référence vers l'attribut pixels_ de la classe
+        */
+        const std::vector<float> & get_pixels() const { return pixels_ ; }
+
+        /**
+         * @brief Change la taille de l'image et la remet en noir
+         * 
+         * @param width : la nouvelle largeur de l'image
+         * @param height : la nouvelle hauteur de l'image
+        */
+        void resize(int width, int height) ;
+
+        /**
+         * @brief Donne les composantes du pixel (x, y)
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * 
+         * @return Un pointeur vers les 3 composantes (r, g, b) du pixel
+        */
+        float * get_pixel(int x, int y) { return &pixels_[3 * (x + static_cast<size_t>(y) * width_)] ; }
+        /**
+         * @brief Donne les composantes du pixel (x, y)
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * 
+         * @return Un pointeur vers les 3 composantes (r, g, b) du pixel
+        */
+        const float * get_pixel(int x, int y) const { return &pixels_[3 * (x + static_cast<size_t>(y) * width_)] ; }
+        /**
+         * @brief Donne la couleur du pixel (x, y) à partir d'un Material
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * @param color : référence vers la couleur du pixel, seules r, g et b sont gardées
+         * @see Material
+        */
+        void set_pixel(int x, int y, const Material & color) ;
+
+        /**
+         * @brief Convertit toute l'image en 8 bits par composante, avec la correction gamma
+         * 
+         * Chaque composante c devient min(255, max(0, c^(1/2.2))), tronqué à l'entier inférieur.
+         * Le calcul se fait en une passe sans branchement sur le tableau contigu : au lieu d'appeler pow,
+         * on cherche par dichotomie la composante dans la table des 256 seuils k^2.2, ce qui donne
+         * exactement le même résultat.
+         * 
+         * @param rgb : référence vers le tableau qui reçoit les pixels 8 bits (r, g, b), ligne par ligne
+        */
+        void to_rgb8(std::vector<unsigned char> & rgb) const ;
+
+        /**
+         * @brief Enregistre l'image, après correction gamma, au format donné par l'extension (.bmp ou .ppm)
+         * 
+         * @param filename : référence vers le nom du fichier à créer
+         * @see save_image
+         * 
+         * @return true si l'image a été enregistrée, false sinon
+        */
+        bool save(const std::string & filename) const ;
+} ;
+
+#endif
@@ -0,0 +1,74 @@
+#include "Image.h"
+#include "Trace.h"
+#include <fstream>
+#include <iostream>
+
+// Écrit un entier sur n octets, en petit-boutiste comme le veut le format BMP
+static void write_le(std::ofstream & out, unsigned int value, int n) {
+    for (int i = 0 ; i < n ; i++) {
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF)) ;
+    }
+}
+
+bool save_bmp(const std::string & filename, int width, int height, const std::vector<unsigned char> & rgb) {
+    std::ofstream out(filename, std::ios::binary) ;
+    if (!out) {
+        std::cerr << "Impossible d'ouvrir le fichier " << filename << std::endl ;
+        return false ;
+    }
+
+    // Chaque ligne du BMP est complétée pour faire un multiple de 4 octets
+    unsigned int row_size = (3 * width + 3) & ~3u ;
+    unsigned int data_size = row_size * height ;
+
+    // En-tête du fichier (14 octets)
+    out.put('B') ;
+    out.put('M') ;
+    write_le(out, 54 + data_size, 4) ;
+    write_le(out, 0, 4) ;
+    write_le(out, 54, 4) ;
+    // En-tête de l'image (BITMAPINFOHEADER, 40 octets)
+    write_le(out, 40, 4) ;
+    write_le(out, width, 4) ;
+    write_le(out, height, 4) ;
+    write_le(out, 1, 2) ;
+    write_le(out, 24, 2) ;
+    write_le(out, 0, 4) ;
+    write_le(out, data_size, 4) ;
+    write_le(out, 2835, 4) ;
+    write_le(out, 2835, 4) ;
+    write_le(out, 0, 4) ;
+    write_le(out, 0, 4) ;
+
+    // Les lignes sont stockées de bas en haut, et les pixels en BGR
+    std::vector<char> row(row_size, 0) ;
+    for (int y = height - 1 ; y >= 0 ; y--) {
+        const unsigned char * src = &rgb[3 * static_cast<size_t>(y) * width] ;
+        for (int x = 0 ; x < width ; x++) {
+            row[3 * x] = static_cast<char>(src[3 * x + 2]) ;
+            row[3 * x + 1] = static_cast<char>(src[3 * x + 1]) ;
+            row[3 * x + 2] = static_cast<char>(src[3 * x]) ;
+        }
+        out.write(row.data(), row_size) ;
+    }
+    return static_cast<bool>(out) ;
+}
+
+bool save_ppm(const std::string & filename, int width, int height, const std::vector<unsigned char> & rgb) {
+    std::ofstream out(filename, std::ios::binary) ;
+    if (!out) {
+        std::cerr << "Impossible d'ouvrir le fichier " << filename << std::endl ;
+        return false ;
+    }
+    out << "P6\n" << width << " " << height << "\n255\n" ;
+    out.write(reinterpret_cast<const char *>(rgb.data()), 3 * static_cast<std::streamsize>(width) * height) ;
+    return static_cast<bool>(out) ;
+}
+
+bool save_image(const std::string & filename, int width, int height, const std::vector<unsigned char> & rgb) {
+    RT_TRACE("encodage de l'image") ;
+    if (filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".ppm") == 0) {
+        return save_ppm(filename, width, height, rgb) ;
+    }
+    return save_bmp(filename, width, height, rgb) ;
+}
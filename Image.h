@@ -0,0 +1,50 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Enregistre une image RGB 8 bits au format BMP (24 bits, sans compression)
+ *
+ * Les pixels sont donnés ligne par ligne, du haut vers le bas, trois octets (r, g, b) par pixel.
+ *
+ * @param filename : référence vers le nom du fichier à créer
+ * @param width : la largeur de l'image
+ * @param height : la hauteur de l'image
+ * @param rgb : référence vers les pixels de l'image
+ *
+ * @return true si l'image a été enregistrée, false sinon
+*/
+bool save_bmp(const std::string & filename, int width, int height, const std::vector<unsigned char> & rgb) ;
+
+/**
+ * @brief Enregistre une image RGB 8 bits au format PPM binaire (P6)
+ *
+ * Les pixels sont donnés ligne par ligne, du haut vers le bas, trois octets (r, g, b) par pixel.
+ *
+ * @param filename : référence vers le nom du fichier à créer
+ * @param width : la largeur de l'image
+ * @param height : la hauteur de l'image
+ * @param rgb : référence vers les pixels de l'image
+ *
+ * @return true si l'image a été enregistrée, false sinon
+*/
+bool save_ppm(const std::string & filename, int width, int height, const std::vector<unsigned char> & rgb) ;
+
+/**
+ * @brief Enregistre une image RGB 8 bits, au format donné par l'extension du fichier
+ *
+ * L'extension .ppm donne une image PPM, toute autre extension une image BMP.
+ *
+ * @param filename : référence vers le nom du fichier à créer
+ * @param width : la largeur de l'image
+ * @param height : la hauteur de l'image
+ * @param rgb : référence vers les pixels de l'image, ligne par ligne, trois octets par pixel
+ * @see save_bmp, save_ppm
+ *
+ * @return true si l'image a été enregistrée, false sinon
+*/
+bool save_image(const std::string & filename, int width, int height, const std::vector<unsigned char> & rgb) ;
+
+#endif
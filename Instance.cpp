@@ -0,0 +1,48 @@
+#include "Instance.h"
+#include <cmath>
+#include <utility>
+
+Instance::Instance(Material matter, std::shared_ptr<const Shape> geometry, const Transform & transform, bool miroir)
+    : Shape(matter, miroir) {
+    geometry_ = std::move(geometry) ;
+    transform_ = transform ;
+    box_ = transform_.box(geometry_->bounding_box()) ;
+}
+
+Ray3f Instance::to_object(const Ray3f & ray, float * echelle) const {
+    Vector3f direction = transform_.inverse_vector(ray.get_direction()) ;
+    *echelle = std::sqrt(dot(direction, direction)) ;
+    direction = (1.0f / *echelle) * direction ;
+    return Ray3f(transform_.inverse_point(ray.get_centre()), direction) ;
+}
+
+HitRecord Instance::is_hit(const Ray3f & ray) const {
+    float echelle ;
+    HitRecord hit = geometry_->is_hit(to_object(ray, &echelle)) ;
+    if (hit.hit()) {
+        hit.t_ /= echelle ;
+    }
+    return hit ;
+}
+
+void Instance::finalize_hit(const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const {
+    float echelle ;
+    Ray3f local = to_object(ray, &echelle) ;
+    HitRecord hit_local = hit ;
+    hit_local.t_ = hit.t_ * echelle ;
+    Vector3f P_local, N_local ;
+    geometry_->finalize_hit(local, hit_local, &P_local, &N_local) ;
+    // Le point est recalculé sur le rayon de la scène plutôt que transformé, pour ne pas ajouter d'erreur d'arrondi
+    *P = ray.get_centre() + hit.t_*ray.get_direction() ;
+    *N = transform_.normal(N_local) ;
+    N->normalize() ;
+}
+
+BoundingBox Instance::bounding_box() const {
+    return box_ ;
+}
+
+std::ostream & operator << (std::ostream & st, const Instance & i) {
+    st << "Instance : [ box : " << i.bounding_box() << " ]" ;
+    return st ;
+}
@@ -0,0 +1,121 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include "Shape.h"
+#include "Transform.h"
+#include "BoundingBox.h"
+#include "Vector3f.h"
+#include "Material.h"
+#include "Ray3f.h"
+#include <memory>
+#include <ostream>
+
+/**
+ * @brief La classe Instance place une géométrie partagée dans la scène, par une transformation affine
+ *
+ * La géométrie (un TriangleMesh, un ShapeGroup...) est décrite une seule fois dans son propre repère, avec sa
+ * propre hiérarchie de volumes englobants : chaque instance ne garde qu'un pointeur partagé vers elle, sa
+ * transformation (et son inverse) et sa boîte dans la scène. Le Bvh de la scène, construit sur les boîtes des
+ * instances, est le premier niveau de la hiérarchie, et celui de la géométrie le second.
+ *
+ * Le rayon est ramené dans le repère de la géométrie pour le test d'intersection, puis le point et la normale
+ * sont ramenés dans la scène. Le matériel de l'instance remplace celui de la géométrie.
+ *
+ * @see Transform, ShapeGroup, TriangleMesh
+*/
+class Instance : public Shape {
+    private :
+        /**
+         * @brief La géométrie, partagée entre toutes ses instances
+        */
+        std::shared_ptr<const Shape> geometry_ ;
+        /**
+         * @brief La transformation du repère de la géométrie vers celui de la scène
+        */
+        Transform transform_ ;
+        /**
+         * @brief La boîte englobante de l'instance dans la scène
+        */
+        BoundingBox box_ ;
+
+        /**
+         * @brief Ramène un rayon dans le repère de la géométrie
+         *
+         * La direction est normalisée, comme l'attendent les formes : une distance t dans le repère de la
+         * géométrie vaut t / echelle dans la scène.
+         *
+         * @param ray : référence vers le rayon dans la scène
+         * @param echelle : pointeur vers la longueur de la direction transformée
+         *
+         * @return Le rayon dans le repère de la géométrie
+        */
+        Ray3f to_object(const Ray3f & ray, float * echelle) const ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         *
+         * @param matter : le matériel de l'instance
+         * @param geometry : la géométrie placée
+         * @param transform : la transformation du repère de la géométrie vers celui de la scène
+         * @param miroir : si l'instance est un miroir
+         * @see Shape
+        */
+        Instance(Material matter, std::shared_ptr<const Shape> geometry, const Transform & transform, bool miroir = false) ;
+
+        /**
+         * @brief Getter de l'attribut geometry_
+         *
+         * @return Référence vers l'attribut geometry_ de la classe
+        */
+        const std::shared_ptr<const Shape> & get_geometry() const { return geometry_ ; }
+        /**
+         * @brief Getter de l'attribut transform_
+         *
+         * @return Référence vers l'attribut transform_ de la classe
+        */
+        const Transform & get_transform() const { return transform_ ; }
+
+        /**
+         * @brief Cherche l'intersection du rayon avec la géométrie, dans son repère
+         *
+         * @param ray : référence vers le rayon
+         *
+         * @return Le HitRecord de la géométrie, dont t_ est ramené dans la scène
+         * @see HitRecord
+        */
+        HitRecord is_hit (const Ray3f & ray) const ;
+
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par is_hit
+         *
+         * @param ray : référence vers le rayon qui a donné l'intersection
+         * @param hit : référence vers le HitRecord renvoyé par is_hit pour ce rayon
+         * @param P : pointeur vers le point d'intersection
+         * @param N : pointeur vers la normale (unitaire) associée au point P
+         * @see HitRecord
+        */
+        void finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const ;
+
+        /**
+         * @brief Donne la boîte englobante de l'instance dans la scène
+         *
+         * @return L'attribut box_
+         * @see BoundingBox
+        */
+        BoundingBox bounding_box() const ;
+} ;
+
+/**
+ * @brief L'opérateur << pour afficher les informations de l'instance
+ *
+ * Affiche : Instance : [ box : la boîte dans la scène ]
+ *
+ * @param st : le flux sur lequel on veut afficher l'instance
+ * @param i : référence de l'instance dont on veut afficher les informations
+ *
+ * @return la référence vers le flux modifié
+*/
+std::ostream & operator << (std::ostream & st, const Instance & i) ;
+
+#endif
@@ -0,0 +1,67 @@
+#include "Light.h"
+#include <cmath>
+
+const float PI_LUMIERE = 3.14159265358979f ;
+
+Light::Light() {
+    type_ = POINT ;
+    position_ = Vector3f() ;
+    cote_u_ = Vector3f() ;
+    cote_v_ = Vector3f() ;
+    normal_ = Vector3f() ;
+    rayon_ = 0.0f ;
+    puissance_ = PUISSANCE_LUMIERE ;
+}
+
+Light::Light(Vector3f position, float puissance) : Light() {
+    position_ = position ;
+    puissance_ = puissance ;
+}
+
+Light Light::sphere(Vector3f centre, float rayon, float puissance) {
+    Light l(centre, puissance) ;
+    l.type_ = SPHERE ;
+    l.rayon_ = rayon ;
+    return l ;
+}
+
+Light Light::rectangle(Vector3f coin, Vector3f cote_u, Vector3f cote_v, float puissance) {
+    Light l(coin, puissance) ;
+    l.type_ = RECTANGLE ;
+    l.cote_u_ = cote_u ;
+    l.cote_v_ = cote_v ;
+    l.normal_ = cross(cote_u, cote_v).get_normalised() ;
+    return l ;
+}
+
+Vector3f Light::sample(float u1, float u2, const Vector3f & P, float * facteur) const {
+    *facteur = 1.0f ;
+    if (type_ == SPHERE) {
+        // Le disque face à P : on construit deux axes orthogonaux à la direction de P vers le centre
+        Vector3f w = (position_ - P).get_normalised() ;
+        Vector3f a = (std::fabs(w.get_x()) > 0.9f) ? Vector3f(0, 1, 0) : Vector3f(1, 0, 0) ;
+        Vector3f t1 = cross(w, a).get_normalised() ;
+        Vector3f t2 = cross(w, t1) ;
+        // La racine répartit les points uniformément sur la surface du disque
+        float r = rayon_ * std::sqrt(u1) ;
+        float angle = 2.0f * PI_LUMIERE * u2 ;
+        return position_ + (r * std::cos(angle)) * t1 + (r * std::sin(angle)) * t2 ;
+    }
+    if (type_ == RECTANGLE) {
+        Vector3f Y = position_ + u1 * cote_u_ + u2 * cote_v_ ;
+        *facteur = std::fabs(dot(normal_, (Y - P).get_normalised())) ;
+        return Y ;
+    }
+    return position_ ;
+}
+
+std::ostream & operator << (std::ostream & st, const Light & l) {
+    st << "Light : [ position : " << l.get_position() << ", puissance : " << l.get_puissance() << " ]" ;
+    if (l.get_type() == Light::SPHERE) {
+        st << ", sphère de rayon " << l.get_rayon() ;
+    }
+    else if (l.get_type() == Light::RECTANGLE) {
+        st << ", rectangle de côtés " << l.get_cote_u() << " et " << l.get_cote_v() ;
+    }
+    return st ;
+}
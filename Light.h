@@ -0,0 +1,172 @@
+#ifndef LIGHT_H
+#define LIGHT_H
+
+#include "Vector3f.h"
+#include <ostream>
+
+// La puissance d'une lumière dont la puissance n'est pas donnée, celle de l'unique lumière des premières scènes
+const float PUISSANCE_LUMIERE = 3000000000.0f ;
+
+/**
+ * @brief La classe Light représente une lumière de la scène : un point, une sphère ou un rectangle
+ *
+ * Une lumière éclaire un point P avec une intensité proportionnelle à sa puissance et inversement
+ * proportionnelle au carré de sa distance à P. Une lumière étendue (sphère ou rectangle) est échantillonnée :
+ * chaque rayon d'ombre va vers un de ses points, et la moyenne des rayons donne des ombres douces.
+ * Une scène peut avoir plusieurs milliers de lumières : chaque rayon d'ombre n'en tire qu'une, selon sa puissance
+ * (voir LightSampler). Les lumières ne sont pas des formes : elles n'apparaissent pas dans l'image et n'arrêtent
+ * pas les rayons.
+ *
+ * @see LightSampler
+*/
+class Light {
+    public :
+        /**
+         * @brief Les formes de lumière
+        */
+        enum Type { POINT = 0, SPHERE = 1, RECTANGLE = 2 } ;
+
+    private :
+        /**
+         * @brief La forme de la lumière
+        */
+        int type_ ;
+        /**
+         * @brief Position de la lumière : le point, le centre de la sphère ou un coin du rectangle
+         * @see Vector3f
+        */
+        Vector3f position_ ;
+        /**
+         * @brief Les deux côtés du rectangle, à partir de position_ (nuls pour les autres formes)
+         * @see Vector3f
+        */
+        Vector3f cote_u_, cote_v_ ;
+        /**
+         * @brief La normale (unitaire) du rectangle (nulle pour les autres formes)
+         * @see Vector3f
+        */
+        Vector3f normal_ ;
+        /**
+         * @brief Le rayon de la sphère (nul pour les autres formes)
+        */
+        float rayon_ ;
+        /**
+         * @brief Puissance de la lumière
+        */
+        float puissance_ ;
+    public :
+        /**
+         * @brief Constructeur par défaut
+         *
+         * Crée une lumière ponctuelle à l'origine, de puissance PUISSANCE_LUMIERE
+        */
+        Light() ;
+
+        /**
+         * @brief Constructeur paramétré, pour une lumière ponctuelle
+         *
+         * @param position : la position de la lumière
+         * @param puissance : la puissance de la lumière, PUISSANCE_LUMIERE par défaut
+         *
+         * @see Vector3f
+        */
+        Light(Vector3f position, float puissance = PUISSANCE_LUMIERE) ;
+
+        /**
+         * @brief Crée une lumière sphérique
+         *
+         * @param centre : le centre de la sphère
+         * @param rayon : le rayon de la sphère
+         * @param puissance : la puissance de la lumière, PUISSANCE_LUMIERE par défaut
+         *
+         * @return La lumière
+        */
+        static Light sphere(Vector3f centre, float rayon, float puissance = PUISSANCE_LUMIERE) ;
+        /**
+         * @brief Crée une lumière rectangulaire, qui éclaire des deux côtés
+         *
+         * @param coin : un coin du rectangle
+         * @param cote_u : le premier côté, à partir du coin
+         * @param cote_v : le second côté, à partir du coin
+         * @param puissance : la puissance de la lumière, PUISSANCE_LUMIERE par défaut
+         *
+         * @return La lumière
+        */
+        static Light rectangle(Vector3f coin, Vector3f cote_u, Vector3f cote_v, float puissance = PUISSANCE_LUMIERE) ;
+
+        /**
+         * @brief Getter de l'attribut type_
+         *
+         * @return L'attribut type_ de la classe, une valeur de Type
+        */
+        int get_type() const { return type_ ; }
+        /**
+         * @brief Getter de l'attribut position_
+         *
+         * @return L'attribut position_ de la classe
+        */
+        Vector3f get_position() const { return position_ ; }
+        /**
+         * @brief Getter de l'attribut cote_u_
+         *
+         * @return L'attribut cote_u_ de la classe
+        */
+        Vector3f get_cote_u() const { return cote_u_ ; }
+        /**
+         * @brief Getter de l'attribut cote_v_
+         *
+         * @return L'attribut cote_v_ de la classe
+        */
+        Vector3f get_cote_v() const { return cote_v_ ; }
+        /**
+         * @brief Getter de l'attribut rayon_
+         *
+         * @return L'attribut rayon_ de la classe
+        */
+        float get_rayon() const { return rayon_ ; }
+        /**
+         * @brief Getter de l'attribut puissance_
+         *
+         * @return L'attribut puissance_ de la classe
+        */
+        float get_puissance() const { return puissance_ ; }
+
+        /**
+         * @brief Vérifie si la lumière est étendue, c'est-à-dire si ses échantillons sont différents
+         *
+         * @return true pour une sphère ou un rectangle
+        */
+        bool is_area() const { return type_ != POINT ; }
+
+        /**
+         * @brief Tire un point de la lumière, vu depuis un point éclairé
+         *
+         * Une sphère est vue comme le disque de même rayon face à P, sur lequel le point est tiré uniformément :
+         * les ombres ont le contour de la sphère. Un point du rectangle est tiré uniformément sur sa surface, et
+         * son éclairage est réduit par l'inclinaison du rectangle vue de P. Deux nombres bien répartis sur
+         * [0, 1[ donnent des points bien répartis sur la lumière.
+         *
+         * @param u1 : un nombre de [0, 1[
+         * @param u2 : un nombre de [0, 1[
+         * @param P : référence vers le point éclairé
+         * @param facteur : pointeur vers le facteur de l'éclairage dû à l'orientation de la lumière (1 sauf pour un rectangle)
+         *
+         * @return Le point tiré
+        */
+        Vector3f sample(float u1, float u2, const Vector3f & P, float * facteur) const ;
+} ;
+
+/**
+ * @brief L'opérateur << pour afficher les informations de la lumière
+ *
+ * Affiche : Light : [ position : position_, puissance : puissance_ ], suivi du rayon ou des côtés
+ * d'une lumière étendue
+ *
+ * @param st : le flux sur lequel on veut afficher la lumière
+ * @param l : référence de la lumière dont on veut afficher les informations
+ *
+ * @return la référence vers le flux modifié
+*/
+std::ostream & operator << (std::ostream & st, const Light & l) ;
+
+#endif
@@ -0,0 +1,50 @@
+#include "LightSampler.h"
+#include <algorithm>
+
+void LightSampler::build(const std::vector<Light> & lights) {
+    int n = static_cast<int>(lights.size()) ;
+    probabilites_.clear() ;
+    alias_.clear() ;
+    pdf_.clear() ;
+
+    double total = 0.0 ;
+    for (const Light & l : lights) {
+        total += std::max(0.0f, l.get_puissance()) ;
+    }
+    if (!(total > 0.0)) {
+        return ;
+    }
+
+    // Chaque case reçoit la puissance moyenne : les lumières plus faibles que la moyenne (petites) sont
+    // complétées par une lumière plus forte (grande), dont le reste est réparti dans les cases suivantes
+    probabilites_.resize(n) ;
+    alias_.resize(n) ;
+    pdf_.resize(n) ;
+    std::vector<double> reste(n) ;
+    std::vector<int> petites, grandes ;
+    for (int i = 0 ; i < n ; i++) {
+        double puissance = std::max(0.0f, lights[i].get_puissance()) ;
+        pdf_[i] = static_cast<float>(puissance / total) ;
+        reste[i] = puissance * n / total ;
+        alias_[i] = i ;
+        (reste[i] < 1.0 ? petites : grandes).push_back(i) ;
+    }
+    while (!petites.empty() && !grandes.empty()) {
+        int petite = petites.back() ; petites.pop_back() ;
+        int grande = grandes.back() ;
+        probabilites_[petite] = static_cast<float>(reste[petite]) ;
+        alias_[petite] = grande ;
+        reste[grande] -= 1.0 - reste[petite] ;
+        if (reste[grande] < 1.0) {
+            grandes.pop_back() ;
+            petites.push_back(grande) ;
+        }
+    }
+    // Les cases restantes valent 1 aux erreurs d'arrondi près
+    for (int i : petites) {
+        probabilites_[i] = 1.0f ;
+    }
+    for (int i : grandes) {
+        probabilites_[i] = 1.0f ;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef LIGHTSAMPLER_H
+#define LIGHTSAMPLER_H
+
+#include "Light.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief La classe LightSampler tire une lumière de la scène avec une probabilité proportionnelle à sa puissance
+ *
+ * Elle repose sur une table d'alias (méthode de Vose) : chaque case de la table contient une probabilité et une
+ * autre lumière, l'alias. Un tirage choisit une case uniformément, puis garde sa lumière ou prend l'alias selon la
+ * probabilité de la case. Il coûte donc le même temps quel que soit le nombre de lumières : chaque rayon d'ombre
+ * va vers une seule lumière tirée, dont la contribution est divisée par sa probabilité.
+ *
+ * @see Light
+*/
+class LightSampler {
+    private :
+        /**
+         * @brief La probabilité de garder la lumière de chaque case plutôt que son alias
+        */
+        std::vector<float> probabilites_ ;
+        /**
+         * @brief L'alias de chaque case
+        */
+        std::vector<int> alias_ ;
+        /**
+         * @brief La probabilité de tirer chaque lumière, sa puissance divisée par la puissance totale
+        */
+        std::vector<float> pdf_ ;
+    public :
+        /**
+         * @brief Construit la table d'alias des lumières
+         *
+         * Les lumières de puissance négative ou nulle ne sont jamais tirées. Si aucune lumière n'a de puissance,
+         * la table est vide.
+         *
+         * @param lights : référence vers les lumières de la scène
+         * @see Light
+        */
+        void build(const std::vector<Light> & lights) ;
+
+        /**
+         * @brief Vérifie si la table est vide
+         *
+         * @return true si aucune lumière ne peut être tirée
+        */
+        bool empty() const { return probabilites_.empty() ; }
+
+        /**
+         * @brief Tire une lumière
+         *
+         * La partie entière de u * n choisit la case, sa partie fractionnaire choisit entre la lumière de la
+         * case et son alias : un seul nombre aléatoire suffit. Avec une seule lumière, le tirage ne dépend pas de u.
+         *
+         * @param u : un nombre uniformément réparti sur [0, 1[
+         * @param pdf : pointeur vers la probabilité de la lumière tirée
+         *
+         * @return L'indice de la lumière tirée, -1 si la table est vide
+        */
+        int sample(float u, float * pdf) const {
+            int n = static_cast<int>(probabilites_.size()) ;
+            if (n == 0) {
+                return -1 ;
+            }
+            float x = u * n ;
+            int i = std::min(static_cast<int>(x), n - 1) ;
+            int choix = (x - i < probabilites_[i]) ? i : alias_[i] ;
+            *pdf = pdf_[choix] ;
+            return choix ;
+        }
+} ;
+
+#endif
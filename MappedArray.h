@@ -0,0 +1,98 @@
+#ifndef MAPPEDARRAY_H
+#define MAPPEDARRAY_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Un tableau en lecture seule, qui possède ses éléments ou qui désigne des éléments rangés ailleurs
+ *
+ * Les tableaux construits en mémoire (Bvh::build, CompiledScene::build) possèdent leurs éléments dans un
+ * std::vector. Ceux lus dans un cache de scène désignent directement les octets du fichier projeté en mémoire,
+ * sans copie : c'est alors à celui qui a projeté le fichier de le garder ouvert tant que le tableau sert.
+ * Le rendu ne voit que data_ et size_, sans savoir d'où viennent les éléments.
+ *
+ * T doit pouvoir être copié octet par octet (float, int, BvhNode...).
+ *
+ * @see SceneCache, MappedFile
+*/
+template <typename T>
+class MappedArray {
+    private :
+        /**
+         * @brief Les éléments, si le tableau les possède (vide sinon)
+        */
+        std::vector<T> owned_ ;
+        /**
+         * @brief Le premier élément, dans owned_ ou dans le fichier projeté
+        */
+        const T * data_ ;
+        /**
+         * @brief Le nombre d'éléments
+        */
+        size_t size_ ;
+
+    public :
+        /**
+         * @brief Constructeur par défaut, crée un tableau vide
+        */
+        MappedArray() : data_(nullptr), size_(0) {}
+        /**
+         * @brief Constructeur paramétré, le tableau possède les éléments donnés
+         *
+         * @param values : les éléments, déplacés dans le tableau
+        */
+        explicit MappedArray(std::vector<T> && values) : owned_(std::move(values)), data_(owned_.data()), size_(owned_.size()) {}
+        /**
+         * @brief Constructeur paramétré, le tableau désigne des éléments qu'il ne possède pas
+         *
+         * @param data : pointeur vers le premier élément, qui doit rester valide
+         * @param size : le nombre d'éléments
+        */
+        MappedArray(const T * data, size_t size) : data_(data), size_(size) {}
+
+        /**
+         * @brief Constructeur par copie : les éléments possédés sont copiés, les autres sont désignés à nouveau
+        */
+        MappedArray(const MappedArray & a) : owned_(a.owned_), data_(a.is_owner() ? owned_.data() : a.data_), size_(a.size_) {}
+        /**
+         * @brief Constructeur par déplacement
+        */
+        MappedArray(MappedArray && a) noexcept : owned_(std::move(a.owned_)), data_(a.data_), size_(a.size_) {
+            a.data_ = nullptr ;
+            a.size_ = 0 ;
+        }
+        MappedArray & operator=(const MappedArray & a) {
+            if (this != &a) {
+                owned_ = a.owned_ ;
+                data_ = a.is_owner() ? owned_.data() : a.data_ ;
+                size_ = a.size_ ;
+            }
+            return *this ;
+        }
+        MappedArray & operator=(MappedArray && a) noexcept {
+            if (this != &a) {
+                owned_ = std::move(a.owned_) ;
+                data_ = a.data_ ;
+                size_ = a.size_ ;
+                a.data_ = nullptr ;
+                a.size_ = 0 ;
+            }
+            return *this ;
+        }
+
+        /**
+         * @brief Indique si le tableau possède ses éléments
+         *
+         * @return true si les éléments sont dans owned_, false s'ils sont rangés ailleurs
+        */
+        bool is_owner() const { return !owned_.empty() ; }
+
+        const T & operator[](size_t i) const { return data_[i] ; }
+        const T * data() const { return data_ ; }
+        size_t size() const { return size_ ; }
+        bool empty() const { return size_ == 0 ; }
+} ;
+
+#endif
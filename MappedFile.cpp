@@ -0,0 +1,46 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() {
+    data_ = nullptr ;
+    size_ = 0 ;
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<unsigned char *>(data_), size_) ;
+    }
+}
+
+bool MappedFile::open(const std::string & path) {
+    int fd = ::open(path.c_str(), O_RDONLY) ;
+    if (fd < 0) {
+        std::cerr << "Impossible d'ouvrir " << path << " : " << std::strerror(errno) << std::endl ;
+        return false ;
+    }
+    struct stat infos ;
+    if (fstat(fd, &infos) != 0 || infos.st_size == 0) {
+        std::cerr << "Impossible de lire la taille de " << path << ", ou fichier vide" << std::endl ;
+        close(fd) ;
+        return false ;
+    }
+    void * p = mmap(nullptr, static_cast<size_t>(infos.st_size), PROT_READ, MAP_PRIVATE, fd, 0) ;
+    // La projection reste valide une fois le descripteur fermé
+    close(fd) ;
+    if (p == MAP_FAILED) {
+        std::cerr << "Impossible de projeter " << path << " en mémoire : " << std::strerror(errno) << std::endl ;
+        return false ;
+    }
+    if (data_ != nullptr) {
+        munmap(const_cast<unsigned char *>(data_), size_) ;
+    }
+    data_ = static_cast<const unsigned char *>(p) ;
+    size_ = static_cast<size_t>(infos.st_size) ;
+    return true ;
+}
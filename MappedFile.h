@@ -0,0 +1,63 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief La classe MappedFile projette un fichier en mémoire, en lecture seule
+ *
+ * Le fichier n'est pas lu à l'ouverture : le système charge chaque page la première fois qu'elle est touchée,
+ * et peut la partager entre plusieurs processus qui projettent le même fichier.
+ * La projection dure autant que l'objet.
+ *
+ * @see SceneCache
+*/
+class MappedFile {
+    private :
+        /**
+         * @brief Le début du fichier projeté, nullptr si aucun fichier n'est ouvert
+        */
+        const unsigned char * data_ ;
+        /**
+         * @brief La taille du fichier, en octets
+        */
+        size_t size_ ;
+
+    public :
+        /**
+         * @brief Constructeur par défaut, aucun fichier n'est ouvert
+        */
+        MappedFile() ;
+        /**
+         * @brief Destructeur, qui retire la projection
+        */
+        ~MappedFile() ;
+
+        MappedFile(const MappedFile &) = delete ;
+        MappedFile & operator=(const MappedFile &) = delete ;
+
+        /**
+         * @brief Projette un fichier en mémoire
+         *
+         * @param path : référence vers le chemin du fichier
+         *
+         * @return true si le fichier est projeté, false sinon (l'erreur est affichée)
+        */
+        bool open(const std::string & path) ;
+
+        /**
+         * @brief Getter de l'attribut data_
+         *
+         * @return L'attribut data_ de la classe
+        */
+        const unsigned char * get_data() const { return data_ ; }
+        /**
+         * @brief Getter de l'attribut size_
+         *
+         * @return L'attribut size_ de la classe
+        */
+        size_t get_size() const { return size_ ; }
+} ;
+
+#endif
@@ -0,0 +1,295 @@
+#include "ObjLoader.h"
+#include "Trace.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+// Taille visée des morceaux analysés en parallèle
+const size_t TAILLE_MORCEAU = 1 << 20 ;
+// Un indice négatif ne peut être résolu qu'une fois connu le nombre de sommets des morceaux précédents :
+// il est rangé en attendant comme RELATIF + sa position dans le morceau
+const int64_t RELATIF = int64_t(1) << 40 ;
+
+/**
+ * @brief Ce qu'a lu un morceau du fichier, avant d'être recopié à la suite des morceaux précédents
+*/
+struct Morceau {
+    const char * debut ;
+    const char * fin ;
+    std::vector<float> positions ;
+    std::vector<float> normals ;
+    // Indices des sommets et des normales de chaque triangle, absolus ou RELATIF + position dans le morceau
+    std::vector<int64_t> triangles ;
+    std::vector<int64_t> normal_ids ;
+    int nb_lignes ;
+    // La première erreur, et sa ligne dans le morceau (0 s'il n'y en a pas)
+    int ligne_erreur ;
+    std::string erreur ;
+} ;
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' ;
+}
+
+// Passe les séparateurs, puis avance jusqu'à la fin du mot
+static bool next_word(const char ** p, const char * fin, const char ** debut, const char ** fin_mot) {
+    while (*p < fin && is_space(**p)) {
+        (*p)++ ;
+    }
+    if (*p == fin) {
+        return false ;
+    }
+    *debut = *p ;
+    while (*p < fin && !is_space(**p)) {
+        (*p)++ ;
+    }
+    *fin_mot = *p ;
+    return true ;
+}
+
+static bool read_floats(const char ** p, const char * fin, float * valeurs, int n) {
+    for (int i = 0 ; i < n ; i++) {
+        const char * debut ;
+        const char * fin_mot ;
+        if (!next_word(p, fin, &debut, &fin_mot)) {
+            return false ;
+        }
+        std::from_chars_result r = std::from_chars(debut, fin_mot, valeurs[i]) ;
+        if (r.ec != std::errc() || r.ptr != fin_mot) {
+            return false ;
+        }
+    }
+    return true ;
+}
+
+// Lit un indice d'une face (1 pour le premier élément, négatif depuis le dernier), vers son codage dans Morceau
+static bool read_index(const char ** p, const char * fin, int64_t nb_lus, int64_t * indice) {
+    int valeur ;
+    std::from_chars_result r = std::from_chars(*p, fin, valeur) ;
+    if (r.ec != std::errc() || valeur == 0) {
+        return false ;
+    }
+    *p = r.ptr ;
+    *indice = (valeur > 0) ? valeur - 1 : RELATIF + nb_lus + valeur ;
+    return true ;
+}
+
+// Lit une face "f v1 v2 v3...", dont chaque sommet s'écrit v, v/vt, v/vt/vn ou v//vn
+static bool parse_face(const char * p, const char * fin, Morceau * m, std::vector<int64_t> & sommets, std::vector<int64_t> & normales) {
+    sommets.clear() ;
+    normales.clear() ;
+    bool toutes_normales = true ;
+    const char * debut ;
+    const char * fin_mot ;
+    int64_t nb_positions = static_cast<int64_t>(m->positions.size() / 3) ;
+    int64_t nb_normales = static_cast<int64_t>(m->normals.size() / 3) ;
+    while (next_word(&p, fin, &debut, &fin_mot)) {
+        int64_t v, n = -1 ;
+        if (!read_index(&debut, fin_mot, nb_positions, &v)) {
+            return false ;
+        }
+        if (debut < fin_mot && *debut == '/') {
+            debut++ ;
+            // La coordonnée de texture n'est pas utilisée
+            while (debut < fin_mot && *debut != '/') {
+                debut++ ;
+            }
+            if (debut < fin_mot) {
+                debut++ ;
+                if (!read_index(&debut, fin_mot, nb_normales, &n)) {
+                    return false ;
+                }
+            }
+        }
+        if (debut != fin_mot) {
+            return false ;
+        }
+        toutes_normales = toutes_normales && n >= 0 ;
+        sommets.push_back(v) ;
+        normales.push_back(n) ;
+    }
+    if (sommets.size() < 3) {
+        return false ;
+    }
+    // Découpage en éventail autour du premier sommet
+    for (size_t k = 1 ; k + 1 < sommets.size() ; k++) {
+        m->triangles.push_back(sommets[0]) ;
+        m->triangles.push_back(sommets[k]) ;
+        m->triangles.push_back(sommets[k + 1]) ;
+        m->normal_ids.push_back(toutes_normales ? normales[0] : -1) ;
+        m->normal_ids.push_back(toutes_normales ? normales[k] : -1) ;
+        m->normal_ids.push_back(toutes_normales ? normales[k + 1] : -1) ;
+    }
+    return true ;
+}
+
+static void parse_chunk(Morceau * m) {
+    std::vector<int64_t> sommets, normales ;
+    const char * p = m->debut ;
+    m->nb_lignes = 0 ;
+    m->ligne_erreur = 0 ;
+    while (p < m->fin) {
+        const char * nl = static_cast<const char *>(std::memchr(p, '\n', m->fin - p)) ;
+        const char * fin_ligne = (nl != nullptr) ? nl : m->fin ;
+        m->nb_lignes++ ;
+
+        const char * curseur = p ;
+        const char * mot ;
+        const char * fin_mot ;
+        p = (nl != nullptr) ? nl + 1 : m->fin ;
+        if (!next_word(&curseur, fin_ligne, &mot, &fin_mot) || *mot == '#') {
+            continue ;
+        }
+        size_t longueur = static_cast<size_t>(fin_mot - mot) ;
+        bool ok = true ;
+        const char * quoi = nullptr ;
+        if (longueur == 1 && mot[0] == 'v') {
+            float v[3] ;
+            ok = read_floats(&curseur, fin_ligne, v, 3) ;
+            m->positions.insert(m->positions.end(), v, v + 3) ;
+            quoi = "v : trois nombres attendus" ;
+        }
+        else if (longueur == 2 && mot[0] == 'v' && mot[1] == 'n') {
+            float n[3] ;
+            ok = read_floats(&curseur, fin_ligne, n, 3) ;
+            m->normals.insert(m->normals.end(), n, n + 3) ;
+            quoi = "vn : trois nombres attendus" ;
+        }
+        else if (longueur == 1 && mot[0] == 'f') {
+            ok = parse_face(curseur, fin_ligne, m, sommets, normales) ;
+            quoi = "f : au moins trois sommets attendus, de la forme v, v/vt, v/vt/vn ou v//vn" ;
+        }
+        if (!ok) {
+            m->ligne_erreur = m->nb_lignes ;
+            m->erreur = quoi ;
+            return ;
+        }
+    }
+}
+
+ObjLoader::ObjLoader(int nb_threads) {
+    nb_threads_ = nb_threads ;
+}
+
+bool ObjLoader::load(const std::string & path) {
+    RT_TRACE("lecture OBJ") ;
+    positions_.clear() ;
+    normals_.clear() ;
+    triangles_.clear() ;
+    normal_ids_.clear() ;
+
+    MappedFile file ;
+    if (!file.open(path)) {
+        return false ;
+    }
+    const char * data = reinterpret_cast<const char *>(file.get_data()) ;
+    size_t taille = file.get_size() ;
+
+    // Découpage en morceaux qui commencent au début d'une ligne
+    size_t nb_morceaux = taille / TAILLE_MORCEAU + 1 ;
+    std::vector<Morceau> morceaux ;
+    const char * debut = data ;
+    for (size_t i = 1 ; i <= nb_morceaux && debut < data + taille ; i++) {
+        const char * fin = data + taille * i / nb_morceaux ;
+        if (fin < debut) {
+            fin = debut ;
+        }
+        const char * nl = static_cast<const char *>(std::memchr(fin, '\n', data + taille - fin)) ;
+        fin = (i == nb_morceaux || nl == nullptr) ? data + taille : nl + 1 ;
+        Morceau m ;
+        m.debut = debut ;
+        m.fin = fin ;
+        morceaux.push_back(std::move(m)) ;
+        debut = fin ;
+    }
+
+    ThreadPool pool(nb_threads_) ;
+    int nb = static_cast<int>(morceaux.size()) ;
+    pool.parallel_for(nb, [&](int c) {
+        parse_chunk(&morceaux[c]) ;
+    }) ;
+
+    // Place de chaque morceau dans les tableaux finaux, et première erreur du fichier
+    std::vector<size_t> debut_positions(nb + 1, 0), debut_normales(nb + 1, 0), debut_triangles(nb + 1, 0) ;
+    int ligne = 0 ;
+    for (int c = 0 ; c < nb ; c++) {
+        const Morceau & m = morceaux[c] ;
+        if (m.ligne_erreur > 0) {
+            std::cerr << path << ":" << ligne + m.ligne_erreur << " : " << m.erreur << std::endl ;
+            return false ;
+        }
+        ligne += m.nb_lignes ;
+        debut_positions[c + 1] = debut_positions[c] + m.positions.size() ;
+        debut_normales[c + 1] = debut_normales[c] + m.normals.size() ;
+        debut_triangles[c + 1] = debut_triangles[c] + m.triangles.size() ;
+    }
+    if (debut_triangles[nb] == 0) {
+        std::cerr << path << " : aucune face" << std::endl ;
+        return false ;
+    }
+
+    positions_.resize(debut_positions[nb]) ;
+    normals_.resize(debut_normales[nb]) ;
+    triangles_.resize(debut_triangles[nb]) ;
+    normal_ids_.resize(debut_triangles[nb]) ;
+    int64_t nb_positions = static_cast<int64_t>(positions_.size() / 3) ;
+    int64_t nb_normales = static_cast<int64_t>(normals_.size() / 3) ;
+    std::vector<unsigned char> hors_limites(nb, 0) ;
+    pool.parallel_for(nb, [&](int c) {
+        Morceau & m = morceaux[c] ;
+        std::copy(m.positions.begin(), m.positions.end(), positions_.begin() + debut_positions[c]) ;
+        std::copy(m.normals.begin(), m.normals.end(), normals_.begin() + debut_normales[c]) ;
+        int64_t avant_positions = static_cast<int64_t>(debut_positions[c] / 3) ;
+        int64_t avant_normales = static_cast<int64_t>(debut_normales[c] / 3) ;
+        for (size_t k = 0 ; k < m.triangles.size() ; k++) {
+            int64_t v = m.triangles[k] ;
+            int64_t n = m.normal_ids[k] ;
+            // Les indices négatifs sont résolus avec le nombre d'éléments des morceaux précédents
+            if (v >= RELATIF / 2) {
+                v = avant_positions + (v - RELATIF) ;
+            }
+            bool normale_valide = (n == -1) ;
+            if (n >= RELATIF / 2) {
+                n = avant_normales + (n - RELATIF) ;
+            }
+            normale_valide = normale_valide || (n >= 0 && n < nb_normales) ;
+            if (v < 0 || v >= nb_positions || !normale_valide) {
+                hors_limites[c] = 1 ;
+                return ;
+            }
+            triangles_[debut_triangles[c] + k] = static_cast<int>(v) ;
+            normal_ids_[debut_triangles[c] + k] = static_cast<int>(n) ;
+        }
+        // Les tableaux du morceau ne servent plus
+        m = Morceau() ;
+    }) ;
+    for (int c = 0 ; c < nb ; c++) {
+        if (hors_limites[c]) {
+            std::cerr << path << " : une face utilise un sommet ou une normale qui n'existe pas" << std::endl ;
+            positions_.clear() ;
+            normals_.clear() ;
+            triangles_.clear() ;
+            normal_ids_.clear() ;
+            return false ;
+        }
+    }
+    return true ;
+}
+
+TriangleMesh * ObjLoader::create_mesh(Material matter, float echelle, bool miroir) {
+    for (float & p : positions_) {
+        p *= echelle ;
+    }
+    TriangleMesh * mesh = new TriangleMesh(matter, std::move(positions_), std::move(normals_), std::move(triangles_),
+                                           std::move(normal_ids_), miroir, nb_threads_) ;
+    positions_.clear() ;
+    normals_.clear() ;
+    triangles_.clear() ;
+    normal_ids_.clear() ;
+    return mesh ;
+}
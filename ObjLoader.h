@@ -0,0 +1,91 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include "TriangleMesh.h"
+#include "Material.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief La classe ObjLoader lit un maillage au format Wavefront OBJ
+ *
+ * Le fichier est projeté en mémoire (MappedFile) puis découpé en morceaux qui commencent chacun au début d'une
+ * ligne. Les morceaux sont analysés en parallèle sur un pool de threads, chacun dans ses propres tableaux, puis
+ * recopiés bout à bout, eux aussi en parallèle : le fichier n'est jamais copié ni lu par un seul thread.
+ *
+ * Seules les lignes v (sommet), vn (normale) et f (face) sont lues ; les autres (vt, o, g, s, usemtl...) sont
+ * ignorées. Une face peut avoir plus de trois sommets, elle est alors découpée en éventail. Les indices peuvent
+ * être négatifs (comptés depuis le dernier sommet lu), comme le permet le format.
+ *
+ * @see TriangleMesh, MappedFile
+*/
+class ObjLoader {
+    private :
+        /**
+         * @brief Le nombre de threads utilisés, 0 pour tous les coeurs
+        */
+        int nb_threads_ ;
+        /**
+         * @brief Les positions des sommets lus, trois flottants par sommet
+        */
+        std::vector<float> positions_ ;
+        /**
+         * @brief Les normales lues, trois flottants par normale
+        */
+        std::vector<float> normals_ ;
+        /**
+         * @brief Les indices des sommets de chaque triangle
+        */
+        std::vector<int> triangles_ ;
+        /**
+         * @brief Les indices des normales des sommets de chaque triangle, -1 si la face n'en donne pas
+        */
+        std::vector<int> normal_ids_ ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         *
+         * @param nb_threads : le nombre de threads de la lecture et de la construction de la hiérarchie du maillage,
+         * 0 pour tous les coeurs
+        */
+        explicit ObjLoader(int nb_threads) ;
+
+        /**
+         * @brief Lit un fichier OBJ
+         *
+         * @param path : référence vers le chemin du fichier
+         *
+         * @return true si le fichier a été lu sans erreur et contient au moins un triangle, false sinon (l'erreur est affichée)
+        */
+        bool load(const std::string & path) ;
+
+        /**
+         * @brief Crée le maillage lu, dont les positions sont multipliées par echelle
+         *
+         * Les tableaux lus sont donnés au maillage : le chargeur est vide ensuite.
+         *
+         * @param matter : le matériel du maillage
+         * @param echelle : le facteur appliqué aux positions
+         * @param miroir : si le maillage est un miroir
+         *
+         * @return Pointeur vers le nouveau maillage, à libérer par l'appelant
+         * @see TriangleMesh
+        */
+        TriangleMesh * create_mesh(Material matter, float echelle, bool miroir) ;
+
+        /**
+         * @brief Donne le nombre de sommets lus
+         *
+         * @return Le nombre de sommets
+        */
+        int get_nb_vertices() const { return static_cast<int>(positions_.size() / 3) ; }
+        /**
+         * @brief Donne le nombre de triangles lus
+         *
+         * @return Le nombre de triangles
+        */
+        int get_nb_triangles() const { return static_cast<int>(triangles_.size() / 3) ; }
+} ;
+
+#endif
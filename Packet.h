@@ -0,0 +1,194 @@
+#ifndef PACKET_H
+#define PACKET_H
+
+#include "Ray3f.h"
+#include <cmath>
+
+// Paquets de rayons : PACKET_SIZE rayons voisins sont tracés ensemble, une voie SIMD par rayon.
+// La largeur est choisie à la compilation : 8 avec AVX (-mavx), 4 avec SSE2 (toujours présent en x86-64),
+// et 4 en calcul scalaire sur les autres processeurs.
+// Les opérations sont faites voie par voie, sans FMA : chaque rayon donne exactement le même résultat que seul.
+#if defined(__AVX__)
+# include <immintrin.h>
+# define PACKET_AVX
+const int PACKET_SIZE = 8 ;
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+# define PACKET_SSE
+const int PACKET_SIZE = 4 ;
+#else
+const int PACKET_SIZE = 4 ;
+#endif
+
+/**
+ * @brief Un flottant par rayon du paquet, dans un registre SIMD
+ *
+ * Les comparaisons donnent des masques : une voie vaut tous ses bits à 1 si la comparaison est vraie, 0 sinon.
+*/
+struct PacketFloat {
+#if defined(PACKET_AVX)
+    __m256 v_ ;
+    PacketFloat() {}
+    PacketFloat(__m256 v) : v_(v) {}
+    explicit PacketFloat(float x) : v_(_mm256_set1_ps(x)) {}
+    static PacketFloat load(const float * p) { return _mm256_loadu_ps(p) ; }
+    void store(float * p) const { _mm256_storeu_ps(p, v_) ; }
+#elif defined(PACKET_SSE)
+    __m128 v_ ;
+    PacketFloat() {}
+    PacketFloat(__m128 v) : v_(v) {}
+    explicit PacketFloat(float x) : v_(_mm_set1_ps(x)) {}
+    static PacketFloat load(const float * p) { return _mm_loadu_ps(p) ; }
+    void store(float * p) const { _mm_storeu_ps(p, v_) ; }
+#else
+    float v_[PACKET_SIZE] ;
+    PacketFloat() {}
+    explicit PacketFloat(float x) { for (int i = 0 ; i < PACKET_SIZE ; i++) v_[i] = x ; }
+    static PacketFloat load(const float * p) { PacketFloat r ; for (int i = 0 ; i < PACKET_SIZE ; i++) r.v_[i] = p[i] ; return r ; }
+    void store(float * p) const { for (int i = 0 ; i < PACKET_SIZE ; i++) p[i] = v_[i] ; }
+#endif
+} ;
+
+#if defined(PACKET_AVX)
+
+inline PacketFloat operator+ (PacketFloat a, PacketFloat b) { return _mm256_add_ps(a.v_, b.v_) ; }
+inline PacketFloat operator- (PacketFloat a, PacketFloat b) { return _mm256_sub_ps(a.v_, b.v_) ; }
+inline PacketFloat operator* (PacketFloat a, PacketFloat b) { return _mm256_mul_ps(a.v_, b.v_) ; }
+inline PacketFloat operator/ (PacketFloat a, PacketFloat b) { return _mm256_div_ps(a.v_, b.v_) ; }
+inline PacketFloat operator< (PacketFloat a, PacketFloat b) { return _mm256_cmp_ps(a.v_, b.v_, _CMP_LT_OQ) ; }
+inline PacketFloat operator<= (PacketFloat a, PacketFloat b) { return _mm256_cmp_ps(a.v_, b.v_, _CMP_LE_OQ) ; }
+inline PacketFloat operator& (PacketFloat a, PacketFloat b) { return _mm256_and_ps(a.v_, b.v_) ; }
+inline PacketFloat operator| (PacketFloat a, PacketFloat b) { return _mm256_or_ps(a.v_, b.v_) ; }
+inline PacketFloat packet_sqrt(PacketFloat a) { return _mm256_sqrt_ps(a.v_) ; }
+// Mêmes résultats que std::min(a, b) = (b < a) ? b : a et std::max(a, b) = (a < b) ? b : a, NaN compris
+inline PacketFloat packet_min(PacketFloat a, PacketFloat b) { return _mm256_min_ps(b.v_, a.v_) ; }
+inline PacketFloat packet_max(PacketFloat a, PacketFloat b) { return _mm256_max_ps(b.v_, a.v_) ; }
+inline PacketFloat packet_not(PacketFloat a) { return _mm256_xor_ps(a.v_, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) ; }
+// Voie par voie : b là où le masque est vrai, a ailleurs
+inline PacketFloat packet_select(PacketFloat masque, PacketFloat a, PacketFloat b) { return _mm256_blendv_ps(a.v_, b.v_, masque.v_) ; }
+inline int packet_mask(PacketFloat masque) { return _mm256_movemask_ps(masque.v_) ; }
+
+#elif defined(PACKET_SSE)
+
+inline PacketFloat operator+ (PacketFloat a, PacketFloat b) { return _mm_add_ps(a.v_, b.v_) ; }
+inline PacketFloat operator- (PacketFloat a, PacketFloat b) { return _mm_sub_ps(a.v_, b.v_) ; }
+inline PacketFloat operator* (PacketFloat a, PacketFloat b) { return _mm_mul_ps(a.v_, b.v_) ; }
+inline PacketFloat operator/ (PacketFloat a, PacketFloat b) { return _mm_div_ps(a.v_, b.v_) ; }
+inline PacketFloat operator< (PacketFloat a, PacketFloat b) { return _mm_cmplt_ps(a.v_, b.v_) ; }
+inline PacketFloat operator<= (PacketFloat a, PacketFloat b) { return _mm_cmple_ps(a.v_, b.v_) ; }
+inline PacketFloat operator& (PacketFloat a, PacketFloat b) { return _mm_and_ps(a.v_, b.v_) ; }
+inline PacketFloat operator| (PacketFloat a, PacketFloat b) { return _mm_or_ps(a.v_, b.v_) ; }
+inline PacketFloat packet_sqrt(PacketFloat a) { return _mm_sqrt_ps(a.v_) ; }
+// Mêmes résultats que std::min(a, b) = (b < a) ? b : a et std::max(a, b) = (a < b) ? b : a, NaN compris
+inline PacketFloat packet_min(PacketFloat a, PacketFloat b) { return _mm_min_ps(b.v_, a.v_) ; }
+inline PacketFloat packet_max(PacketFloat a, PacketFloat b) { return _mm_max_ps(b.v_, a.v_) ; }
+inline PacketFloat packet_not(PacketFloat a) { return _mm_xor_ps(a.v_, _mm_castsi128_ps(_mm_set1_epi32(-1))) ; }
+// Voie par voie : b là où le masque est vrai, a ailleurs
+inline PacketFloat packet_select(PacketFloat masque, PacketFloat a, PacketFloat b) {
+    return _mm_or_ps(_mm_and_ps(masque.v_, b.v_), _mm_andnot_ps(masque.v_, a.v_)) ;
+}
+inline int packet_mask(PacketFloat masque) { return _mm_movemask_ps(masque.v_) ; }
+
+#else
+
+// Version scalaire, voie par voie ; un masque vrai est représenté par un NaN dont tous les bits sont à 1
+# include <cstring>
+inline float packet_bool(bool b) { unsigned int u = b ? 0xFFFFFFFFu : 0u ; float f ; std::memcpy(&f, &u, 4) ; return f ; }
+inline unsigned int packet_bits(float f) { unsigned int u ; std::memcpy(&u, &f, 4) ; return u ; }
+# define PACKET_OP(nom, expression) \
+    inline PacketFloat nom (PacketFloat a, PacketFloat b) { \
+        PacketFloat r ; for (int i = 0 ; i < PACKET_SIZE ; i++) { float x = a.v_[i], y = b.v_[i] ; r.v_[i] = (expression) ; } return r ; }
+PACKET_OP(operator+, x + y)
+PACKET_OP(operator-, x - y)
+PACKET_OP(operator*, x * y)
+PACKET_OP(operator/, x / y)
+PACKET_OP(operator<, packet_bool(x < y))
+PACKET_OP(operator<=, packet_bool(x <= y))
+PACKET_OP(operator&, packet_bool(packet_bits(x) && packet_bits(y)))
+PACKET_OP(operator|, packet_bool(packet_bits(x) || packet_bits(y)))
+PACKET_OP(packet_min, (y < x) ? y : x)
+PACKET_OP(packet_max, (x < y) ? y : x)
+# undef PACKET_OP
+inline PacketFloat packet_sqrt(PacketFloat a) { PacketFloat r ; for (int i = 0 ; i < PACKET_SIZE ; i++) r.v_[i] = std::sqrt(a.v_[i]) ; return r ; }
+inline PacketFloat packet_not(PacketFloat a) { PacketFloat r ; for (int i = 0 ; i < PACKET_SIZE ; i++) r.v_[i] = packet_bool(!packet_bits(a.v_[i])) ; return r ; }
+inline PacketFloat packet_select(PacketFloat masque, PacketFloat a, PacketFloat b) {
+    PacketFloat r ; for (int i = 0 ; i < PACKET_SIZE ; i++) r.v_[i] = packet_bits(masque.v_[i]) ? b.v_[i] : a.v_[i] ; return r ;
+}
+inline int packet_mask(PacketFloat masque) {
+    int m = 0 ; for (int i = 0 ; i < PACKET_SIZE ; i++) m |= (packet_bits(masque.v_[i]) ? 1 : 0) << i ; return m ;
+}
+
+#endif
+
+/**
+ * @brief L'inverse d'une composante de direction, pour le test des boîtes du Bvh
+ *
+ * Une composante nulle donne un très grand nombre plutôt que l'infini : un rayon parallèle à une face de boîte
+ * et dont l'origine est exactement dans le plan de cette face donnerait sinon 0 * infini = NaN, et manquerait
+ * la boîte. C'est le cas des rayons qui longent les arêtes d'un maillage.
+ *
+ * @param d : la composante de la direction
+ *
+ * @return 1 / d, ou ±1E30 si d est nul
+*/
+inline float slab_inverse(float d) {
+    return (d != 0.0f) ? 1.0f / d : std::copysign(1E30f, d) ;
+}
+
+/**
+ * @brief Un paquet de PACKET_SIZE rayons, rangés une coordonnée par registre
+ *
+ * Seuls les rayons dont le bit est à 1 dans active_ sont tracés, les autres voies sont ignorées.
+ *
+ * @see PacketFloat
+*/
+struct RayPacket {
+    /**
+     * @brief Les origines des rayons
+    */
+    PacketFloat ox_, oy_, oz_ ;
+    /**
+     * @brief Les directions (unitaires) des rayons
+    */
+    PacketFloat dx_, dy_, dz_ ;
+    /**
+     * @brief L'inverse de chaque composante des directions, pour le parcours du Bvh
+    */
+    PacketFloat inv_dx_, inv_dy_, inv_dz_ ;
+    /**
+     * @brief Le masque des rayons actifs, un bit par voie
+    */
+    int active_ ;
+    /**
+     * @brief Les rayons du paquet, pour les formes testées rayon par rayon
+    */
+    Ray3f rays_[PACKET_SIZE] ;
+
+    /**
+     * @brief Constructeur paramétré
+     *
+     * Crée le paquet à partir des rayons donnés, les voies au-delà de nb_rays sont inactives
+     *
+     * @param rays : les rayons, au moins nb_rays
+     * @param nb_rays : le nombre de rayons du paquet, au plus PACKET_SIZE
+    */
+    RayPacket(const Ray3f * rays, int nb_rays) {
+        float o[3][PACKET_SIZE], d[3][PACKET_SIZE], inv[3][PACKET_SIZE] ;
+        for (int i = 0 ; i < PACKET_SIZE ; i++) {
+            // Les voies inactives reprennent le premier rayon, pour ne pas calculer sur des valeurs quelconques
+            const Ray3f & r = rays[i < nb_rays ? i : 0] ;
+            rays_[i] = r ;
+            Vector3f c = r.get_centre() ;
+            Vector3f v = r.get_direction() ;
+            o[0][i] = c.get_x() ; o[1][i] = c.get_y() ; o[2][i] = c.get_z() ;
+            d[0][i] = v.get_x() ; d[1][i] = v.get_y() ; d[2][i] = v.get_z() ;
+            inv[0][i] = slab_inverse(v.get_x()) ; inv[1][i] = slab_inverse(v.get_y()) ; inv[2][i] = slab_inverse(v.get_z()) ;
+        }
+        ox_ = PacketFloat::load(o[0]) ; oy_ = PacketFloat::load(o[1]) ; oz_ = PacketFloat::load(o[2]) ;
+        dx_ = PacketFloat::load(d[0]) ; dy_ = PacketFloat::load(d[1]) ; dz_ = PacketFloat::load(d[2]) ;
+        inv_dx_ = PacketFloat::load(inv[0]) ; inv_dy_ = PacketFloat::load(inv[1]) ; inv_dz_ = PacketFloat::load(inv[2]) ;
+        active_ = (nb_rays >= PACKET_SIZE) ? (1 << PACKET_SIZE) - 1 : (1 << nb_rays) - 1 ;
+    }
+} ;
+
+#endif
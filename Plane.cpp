@@ -0,0 +1,35 @@
+#include "Plane.h"
+
+Plane::Plane(Material matter, Vector3f point, Vector3f normal, bool miroir) : Shape(matter, miroir) {
+    normal_ = normal.get_normalised() ;
+    distance_ = normal_.get_x() * point.get_x() + normal_.get_y() * point.get_y() + normal_.get_z() * point.get_z() ;
+}
+
+HitRecord Plane::is_hit (const Ray3f & ray) const {
+    HitRecord hit = no_hit() ;
+    Vector3f o = ray.get_centre() ;
+    Vector3f d = ray.get_direction() ;
+    // Les mêmes calculs, dans le même ordre, que CompiledScene : un rayon parallèle au plan donne une
+    // division par 0, dont le résultat (infini ou NaN) échoue aux comparaisons
+    float cosinus = normal_.get_x() * d.get_x() + normal_.get_y() * d.get_y() + normal_.get_z() * d.get_z() ;
+    float t = (distance_ - (normal_.get_x() * o.get_x() + normal_.get_y() * o.get_y() + normal_.get_z() * o.get_z())) / cosinus ;
+    if (t > 0.0f && t < hit.t_) {
+        hit.t_ = t ;
+        hit.primitive_ = 0 ;
+    }
+    return hit ;
+}
+
+void Plane::finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const {
+    *P = ray.get_centre() + hit.t_*ray.get_direction() ;
+    *N = (dot(normal_, ray.get_direction()) > 0.0f) ? -1.0f * normal_ : normal_ ;
+}
+
+BoundingBox Plane::bounding_box() const {
+    return BoundingBox() ;
+}
+
+std::ostream & operator << (std::ostream & st, const Plane & p) {
+    st << "Plane : [ normal : " << p.get_normal() << ", distance : " << p.get_distance() << " ]" ;
+    return st ;
+}
@@ -0,0 +1,105 @@
+#ifndef PLANE_H
+#define PLANE_H
+
+#include "Shape.h"
+#include "Vector3f.h"
+#include "Material.h"
+#include "Ray3f.h"
+#include <cmath>
+#include <ostream>
+
+
+/**
+ * @brief La classe qui définit les plans infinis dans la scène
+ *
+ * Elle hérite de la classe Shape. Un plan est l'ensemble des points P tels que dot(normal_, P) = distance_.
+ * Il remplace les très grandes sphères qui faisaient le sol, le plafond et les murs : son intersection est une
+ * seule division, sans perte de précision loin de l'origine.
+ *
+ * Un plan n'a pas de boîte englobante : il n'est pas rangé dans le Bvh, mais testé avant chaque parcours.
+ *
+ * @see CompiledScene::move_planes_to_end
+*/
+class Plane : public Shape {
+    private :
+        /**
+         * @brief La normale (unitaire) du plan
+         * @see Vector3f
+        */
+        Vector3f normal_ ;
+        /**
+         * @brief La distance signée du plan à l'origine, le long de normal_
+        */
+        float distance_ ;
+    public :
+
+        /**
+         * @brief Constructeur paramétré
+         *
+         * @param matter : le matériel du plan
+         * @param point : un point du plan
+         * @param normal : la normale du plan, normalisée par le constructeur
+         * @param miroir : si le plan est un miroir, false par défaut
+         *
+         * @see Shape
+        */
+        Plane (Material matter, Vector3f point, Vector3f normal, bool miroir=false) ;
+
+        /**
+         * @brief Getter de l'attribut normal_
+         *
+         * @return L'attribut normal_ de la classe
+        */
+        Vector3f get_normal() const { return normal_ ; }
+        /**
+         * @brief Getter de l'attribut distance_
+         *
+         * @return L'attribut distance_ de la classe
+        */
+        float get_distance() const { return distance_ ; }
+
+        /**
+         * @brief Vérifie si le rayon intersecte le plan devant son origine
+         *
+         * @param ray : référence vers le rayon
+         *
+         * @return Le HitRecord de l'intersection, dont primitive_ vaut -1 s'il n'y a pas d'intersection
+         * @see HitRecord
+        */
+        HitRecord is_hit (const Ray3f & ray) const ;
+
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par is_hit
+         *
+         * La normale est tournée vers l'origine du rayon : le plan est vu des deux côtés.
+         *
+         * @param ray : référence vers le rayon qui a donné l'intersection
+         * @param hit : référence vers le HitRecord renvoyé par is_hit pour ce rayon
+         * @param P : pointeur vers le point d'intersection
+         * @param N : pointeur vers la normale (unitaire) associée au point P
+         * @see HitRecord
+        */
+        void finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const ;
+
+        /**
+         * @brief Donne la boîte englobante du plan
+         *
+         * @return Une boîte vide, le plan étant infini
+         * @see BoundingBox
+        */
+        BoundingBox bounding_box() const ;
+} ;
+
+/**
+ * @brief L'opérateur << pour afficher les informations du plan
+ *
+ * Affiche : Plane : [ normal : normal_, distance : distance_ ]
+ *
+ * @param st : le flux sur lequel on veut afficher le plan
+ * @param p : référence du plan dont on veut afficher les informations
+ *
+ * @return la référence vers le flux modifié
+*/
+std::ostream & operator << (std::ostream & st, const Plane & p) ;
+
+#endif
@@ -2,6 +2,7 @@
 #include "Vector3f.h"
 #include "Material.h"
 #include "Quad.h"
+#include "Packet.h"
 #include <cmath>
 #include <ostream>
 #include <math.h>
@@ -53,163 +54,47 @@ Vector3f Quad::get_center() const {
     return res;
 }
 
-//Trouve la normale d'un point de la boite
-Vector3f Quad::normal(const Vector3f P) const {
-    Vector3f b0 = boundMin();
-    Vector3f b1 = boundMax();
-    Vector3f center = this-> get_center();
-
-    //On initialise les paramètres que l'on va comparer
-
-    float Px = P.get_x();
-    float Py = P.get_y();
-    float Pz = P.get_z();
-
-    float B0x = b0.get_x();
-    float B0y = b0.get_y();
-    float B0z = b0.get_z();
-
-    float B1x = b1.get_x();
-    float B1y = b1.get_y();
-    float B1z = b1.get_z();
-
-    //On regarde alors les intersections avec les faces
-    // Intersection avec la face avant
-	if (Px > center.get_x() && (Px == B0x || Px == B1x)) {
-		// Intersection avec les arêtes haute et basse
-		if ((Py == B0y || Py == B1y) && (Pz != B0z && Pz != B1z) && Pz != center.get_z()) {
-			return Vector3f(1, 1, 0) * P;
-		}
-		// Intersection avec les arêtes de droite et de gauche
-		else if ((Py == B0z || Py == B1y) && (Pz != B0z && Pz != B1z) && Pz != center.get_z()) {
-			return Vector3f(1, 0, 1) * P;
-		}
-		// Intersection avec les coins
-		else if ((Py == B1y && Pz == B1z) || (Pz == B0z && Py == B1y) || (Pz == B1z && Py == B0y) || (Pz == B0z && Py == B0y)) {
-			return Vector3f(1, 1, 1) * P;
-		}
-		// Intersection au milieu de la face
-		else { return Vector3f(1, 0, 0) * P; }
-	}
-	// Intersection avec la face arrière
-    else if (Px < center.get_x() && (Px == B0x || Px == B1x)) {
-        // Intersection avec les arêtes 
-        if ((Pz == B0z || Pz == B1z) && (Py != B0y && Py != B1y) && Py != center.get_y()) {
-            return Vector3f(1, 0, 1) * P;
-        }
-        // Intersection avec les coins
-        else if ((Px == B1x && Py == B1y) || (Px == B0x && Py == B1y) || (Px == B1x && Py == B0y) || (Px == B0x && Py == B0y)) {
-            return Vector3f(1, 1, 1) * P;
-        }
-        // Intersection au milieu de la face
-        else {
-            return Vector3f(-1, 0, 0) * P;
-        }
-    }
-	// Intersection avec la face gauche
-    else if (Pz > center.get_z() && (Pz == B0z || Pz == B1z)) {
-        // Intersection avec les arêtes haute et basse
-        if ((Py == B0y || Py == B1y) && (Px != B0x && Px != B1x) && Py != center.get_y()) {
-            return Vector3f(0, 1, 1) * P;
-        }
-        // Intersection avec les arêtes de droite et de gauche
-        else if ((Px == B0x || Px == B1x) && (Py != B0y && Py != B1y) && Px != center.get_x()) {
-            return Vector3f(1, 0, 1) * P;
-        }
-        // Intersection au milieu de la face
-        else {
-            return Vector3f(0, 0, 1) * P;
-        }
-    }
-
-	// Intersection avec la face droite
-    else if (Pz < center.get_z() && (Pz == B0z || Pz == B1z)) {
-        // Intersection avec les arêtes haute et basse
-        if ((Py == B0y || Py == B1y) && (Px != B0x && Px != B1x) && Py != center.get_y()) {
-            return Vector3f(1, 1, 0) * P;
-        }
-        // Intersection avec les arêtes de droite et de gauche
-        else if ((Px == B0x || Px == B1x) && (Py != B0y && Py != B1y) && Px != center.get_x()) {
-            return Vector3f(1, 0, 1) * P;
-        }
-        // Intersection au milieu de la face
-        else {
-            return Vector3f(0, 0, -1) * P;
-        }
-    }
-
-	// Intersection avec la face haute
-    else if (Py > center.get_y() && (Py == B0y || Py == B1y)) {
-        // Intersection avec les arêtes haute et basse
-        if ((Px == B0x || Px == B1x) && (Pz != B0z && Pz != B1z) && Px != center.get_x()) {
-            return Vector3f(1, 1, 0) * P;
-        }
-        // Intersection avec les arêtes de droite et de gauche
-        else if ((Pz == B0z || Pz == B1z) && (Px != B0x && Px != B1x) && Pz != center.get_z()) {
-            return Vector3f(0, 1, 1) * P;
-        }
-        // Intersection au milieu de la face
-        else {
-            return Vector3f(0, 1, 0) * P;
-        }
-    }
-
-	// Intersection avec la face basse
-    else if (Py < center.get_y() && (Py == B0y || Py == B1y)) {
-        // Intersection avec les arêtes haute et basse
-        if ((Px == B0x || Px == B1x) && (Pz != B0z && Pz != B1z) && Px != center.get_x()) {
-            return Vector3f(1, 1, 0) * P;
-        }
-        // Intersection avec les arêtes de droite et de gauche
-        else if ((Pz == B0z || Pz == B1z) && (Px != B0x && Px != B1x) && Pz != center.get_z()) {
-            return Vector3f(1, 0, 1) * P;
-        }
-        // Intersection au milieu de la face
-        else {
-            return Vector3f(0, -1, 0) * P;
-        }
-    }
+Vector3f Quad::face_normal(int face) {
+    float n[3] = { 0.0f, 0.0f, 0.0f };
+    n[face / 2] = (face % 2 == 1) ? 1.0f : -1.0f;
+    return Vector3f(n[0], n[1], n[2]);
+}
 
-    return Vector3f();
+BoundingBox Quad::bounding_box() const {
+    return BoundingBox(boundMin(), boundMax()) ;
 }
 
-int Quad::is_hit (Ray3f ray, Vector3f * P, Vector3f * N, float * t)
+HitRecord Quad::is_hit (const Ray3f & ray) const
 { 
+    HitRecord hit = no_hit();
     Vector3f orig = ray.get_centre();
     Vector3f dir = ray.get_direction();
 
-    //On récupère les points min (coin arrière inférieur droit) et max (coin avant supérieur gauche) du quad 
-    Vector3f b0 = boundMin();
-    Vector3f b1 = boundMax();
-
-    float tx1, ty1, tz1, tx2, ty2, tz2;
-
-    //On calcule les points d'intersections possibles 
-    tx1 = (b0.get_x() - orig.get_x()) / dir.get_x();
-    ty1 = (b0.get_y() - orig.get_y()) / dir.get_y();
-    tz1 = (b0.get_z() - orig.get_z()) / dir.get_z();
-
-    tx2 = (b1.get_x() - orig.get_x()) / dir.get_x();
-    ty2 = (b1.get_y() - orig.get_y()) / dir.get_y();
-    tz2 = (b1.get_z() - orig.get_z()) / dir.get_z();
+    //On range les coins du quad par coordonnée, boundMin n'ayant pas toujours les plus petites
+    BoundingBox box = bounding_box();
+    Vector3f b0 = box.get_min();
+    Vector3f b1 = box.get_max();
 
-    //On détermine les points le plus proche et le plus loin
-    float tNear = std::max(std::min(tx1, tx2), std::max(std::min(ty1, ty2), std::min(tz1, tz2)));
-    float tFar = std::min(std::max(tx1, tx2), std::min(std::max(ty1, ty2), std::max(tz1, tz2)));
+    const float o[3] = { orig.get_x(), orig.get_y(), orig.get_z() };
+    const float inv[3] = { slab_inverse(dir.get_x()), slab_inverse(dir.get_y()), slab_inverse(dir.get_z()) };
+    const float lo[3] = { b0.get_x(), b0.get_y(), b0.get_z() };
+    const float hi[3] = { b1.get_x(), b1.get_y(), b1.get_z() };
 
-    //Si une des conditions suivantes est respectée, il n'y a pas d'intersection
-    if (tNear > tFar || tFar < 0) {
-        return 0;
+    float t;
+    int face;
+    if (!slab_hit(o, inv, lo, hi, &t, &face)) {
+        return hit;
     }
 
-    *t = tNear;
-
-    *P = orig + *t*dir;
-    //On détermine la normale, qui est unitaire dans le cas d'un quadrilatère
-
-    *N = normal(*P);
-
-    N->normalize();
+    hit.t_ = t;
+    //La face touchée donne la normale
+    hit.primitive_ = face;
+    return hit;
+}
 
-    return 1;
+void Quad::finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const
+{
+    *P = ray.get_centre() + hit.t_*ray.get_direction();
+    //La normale est celle de la face trouvée par is_hit
+    *N = face_normal(hit.primitive_);
 }
@@ -5,8 +5,8 @@
 #include "Vector3f.h"
 #include "Material.h"
 #include "Ray3f.h"
+#include <algorithm>
 #include <cmath>
-#include "Sdl.h"
 #include <ostream>
 #include <iostream>
 
@@ -153,20 +153,40 @@ class Quad : public Shape {
         /**
          * @brief Vérifie si le rayon intersecte le Quad
          * 
-         * La fonction permet aussi de récupérer le point P d'intersection du rayon, la normale N
-         * à ce point et la valeur de t à ce point.
+         * La fonction ne calcule que la valeur de t à l'intersection la plus proche devant le rayon, et la face
+         * touchée, rangée dans primitive_ (voir slab_hit).
          * Une fonction du même nom existe aussi pour les sphères
          * @see Sphere
          * 
-         * @param ray : le rayon avec lequel on veut voir s'il y a intersection
+         * @param ray : référence vers le rayon avec lequel on veut voir s'il y a intersection
+         * @see Ray3f
+         * 
+         * @return Le HitRecord de l'intersection, dont primitive_ vaut -1 s'il n'y a pas d'intersection
+         * @see HitRecord
+        */
+        HitRecord is_hit (const Ray3f & ray) const ;
+
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par is_hit
+         * 
+         * @param ray : référence vers le rayon qui a donné l'intersection
+         * @param hit : référence vers le HitRecord renvoyé par is_hit pour ce rayon
          * @param P : pointeur vers le point d'intersection entre le rayon et le Quad
-         * @param N : pointeur vers la normale associé au point P
-         * @param t : pointeur vers la valeur de t au point P
-         * @see Vector3f, Ray3f
+         * @param N : pointeur vers la normale (unitaire) associée au point P
+         * @see Vector3f, Ray3f, HitRecord
+        */
+        void finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const ;
+
+        /**
+         * @brief Donne la boîte englobante du Quad
          * 
-         * @return 1 s'il y a intersection, 0 sinon
+         * Le Quad étant aligné sur les axes, c'est la boîte formée par boundMin() et boundMax()
+         * 
+         * @return La boîte englobante du Quad
+         * @see BoundingBox
         */
-        int is_hit (Ray3f ray, Vector3f * P, Vector3f * N, float * t) ;
+        BoundingBox bounding_box() const ;
+
 
         /**
          * @brief Donne le centre du Quad
@@ -179,18 +199,65 @@ class Quad : public Shape {
         Vector3f get_center() const;
 
         /**
-         * @brief Donne la normale au point donné en entrée
+         * @brief Donne la normale d'une face d'une boîte alignée sur les axes
          * 
-         * La normale pour un Quad étant plus compliqué à trouver que pour une sphère, puisqu'elle implique
-         * de nombreuses comparaison, on fait une fonction qui fait toutes ces comparaisons, plutôt que 
-         * de surcharger la fonction is_hit
+         * Les faces sont numérotées 2 * axe pour la face du côté des plus petites coordonnées (normale vers les
+         * coordonnées négatives de l'axe) et 2 * axe + 1 pour la face opposée, l'axe valant 0 pour x, 1 pour y et 2 pour z.
          * 
-         * @param P : le point P dont on cherche la normale
+         * @param face : l'indice de la face, entre 0 et 5, donné par slab_hit
          * 
-         * @return le vecteur correspondant à la normale du point P
+         * @return le vecteur unitaire normal à la face, tourné vers l'extérieur de la boîte
          * @see Vector3f
         */
-        Vector3f normal(const Vector3f P) const;
+        static Vector3f face_normal(int face) ;
+        /**
+         * @brief Test d'intersection d'un rayon et d'une boîte alignée sur les axes, par la méthode des tranches
+         * 
+         * La face touchée est celle de la tranche qui donne t : la tranche d'entrée la plus lointaine si l'origine
+         * est hors de la boîte, la tranche de sortie la plus proche si elle est dedans. La normale est donc connue
+         * sans comparer le point d'intersection aux bords de la boîte.
+         * 
+         * @param o : l'origine du rayon
+         * @param inv : l'inverse de chaque composante de la direction, donné par slab_inverse
+         * @param lo : le coin de plus petites coordonnées
+         * @param hi : le coin de plus grandes coordonnées
+         * @param t : pointeur vers la distance de l'intersection
+         * @param face : pointeur vers l'indice de la face touchée (voir face_normal)
+         * 
+         * @return true s'il y a une intersection devant le rayon
+         * @see CompiledScene::intersect
+        */
+        static bool slab_hit(const float o[3], const float inv[3], const float lo[3], const float hi[3], float * t, int * face) {
+            int axe_entree = 0, axe_sortie = 0 ;
+            float t_entree = 0.0f, t_sortie = 0.0f ;
+            for (int k = 0 ; k < 3 ; k++) {
+                float t_lo = (lo[k] - o[k]) * inv[k] ;
+                float t_hi = (hi[k] - o[k]) * inv[k] ;
+                float t_min = std::min(t_lo, t_hi) ;
+                float t_max = std::max(t_lo, t_hi) ;
+                if (k == 0 || t_min > t_entree) {
+                    t_entree = t_min ;
+                    axe_entree = k ;
+                }
+                if (k == 0 || t_max < t_sortie) {
+                    t_sortie = t_max ;
+                    axe_sortie = k ;
+                }
+            }
+            if (t_entree > t_sortie || t_sortie < 0.0f) {
+                return false ;
+            }
+            // Un rayon qui avance vers les coordonnées positives entre par la face basse et sort par la face haute
+            if (t_entree >= 0.0f) {
+                *t = t_entree ;
+                *face = 2 * axe_entree + ((inv[axe_entree] < 0.0f) ? 1 : 0) ;
+            }
+            else {
+                *t = t_sortie ;
+                *face = 2 * axe_sortie + ((inv[axe_sortie] < 0.0f) ? 0 : 1) ;
+            }
+            return true ;
+        }
 
 } ;
 
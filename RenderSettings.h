@@ -0,0 +1,69 @@
+#ifndef RENDERSETTINGS_H
+#define RENDERSETTINGS_H
+
+#include <string>
+
+/**
+ * @brief Les paramètres d'un rendu, lus sur la ligne de commande
+ * 
+ * Ils sont regroupés pour ne pas avoir à passer une longue liste de paramètres aux fonctions de rendu de Scene.
+ * 
+ * @see Scene::render, Scene::render_to_file
+*/
+struct RenderSettings {
+    /**
+     * @brief La largeur de l'image
+    */
+    int width_ ;
+    /**
+     * @brief La hauteur de l'image
+    */
+    int height_ ;
+    /**
+     * @brief Le nombre de threads de calcul, 0 pour prendre le nombre de coeurs de la machine
+    */
+    int nb_threads_ ;
+    /**
+     * @brief Le nombre de passes en rendu progressif, un rayon par pixel et par passe
+    */
+    int nb_samples_ ;
+    /**
+     * @brief true pour le rendu progressif avec éclairage indirect (path tracing), false pour l'éclairage direct seul
+    */
+    bool path_tracing_ ;
+    /**
+     * @brief L'erreur (en niveaux de 0 à 255) sous laquelle une tuile a convergé en rendu progressif, 0 pour un nombre d'échantillons fixe
+    */
+    float threshold_ ;
+    /**
+     * @brief true pour tracer les chemins par vagues (Wavefront), false pour les tracer pixel par pixel (Scene::get_color)
+    */
+    bool wavefront_ ;
+    /**
+     * @brief true pour la visionneuse interactive, où l'on déplace la caméra (Viewer), false pour une seule image
+    */
+    bool interactive_ ;
+    /**
+     * @brief Le nom du fichier image produit (.bmp ou .ppm)
+    */
+    std::string output_ ;
+
+    /**
+     * @brief Constructeur par défaut
+     * 
+     * Image de 500x500, un rayon par pixel sur tous les coeurs, éclairage direct seul, intégrateur récursif, sans interaction
+    */
+    RenderSettings() {
+        width_ = 500 ;
+        height_ = 500 ;
+        nb_threads_ = 0 ;
+        nb_samples_ = 1 ;
+        path_tracing_ = false ;
+        threshold_ = 0.0f ;
+        wavefront_ = false ;
+        interactive_ = false ;
+        output_ = "rendu.bmp" ;
+    }
+} ;
+
+#endif
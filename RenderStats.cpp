@@ -0,0 +1,185 @@
+#include "RenderStats.h"
+
+#ifdef RT_STATS
+
+#include "Image.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+// Nombre de tuiles les plus lentes données par le bilan
+const int NB_TUILES_LENTES = 5 ;
+
+// Les couleurs de la carte de chaleur, de la plus petite valeur à la plus grande
+const float RAMPE_CHALEUR[5][3] = {
+    { 0.0f, 0.0f, 0.0f }, { 0.1f, 0.1f, 0.8f }, { 0.9f, 0.1f, 0.3f }, { 1.0f, 0.8f, 0.0f }, { 1.0f, 1.0f, 1.0f }
+} ;
+
+RenderStats::RenderStats() {
+    width_ = 0 ;
+    height_ = 0 ;
+}
+
+void RenderStats::resize(int width, int height) {
+    width_ = width ;
+    height_ = height ;
+    size_t n = static_cast<size_t>(width) * height ;
+    for (std::vector<double> * v : { &primary_, &closest_, &shadow_, &shape_tests_, &nodes_, &tile_time_ }) {
+        v->assign(n, 0.0) ;
+    }
+    depth_.assign(n, 0) ;
+    std::lock_guard<std::mutex> lock(tiles_mutex_) ;
+    tiles_.clear() ;
+}
+
+void RenderStats::add(const int * pixels, int nb_pixels, const StatCounters & debut) {
+    if (width_ == 0 || nb_pixels == 0) {
+        return ;
+    }
+    const StatCounters & fin = thread_stats() ;
+    double part = 1.0 / nb_pixels ;
+    for (int k = 0 ; k < nb_pixels ; k++) {
+        int p = pixels[k] ;
+        primary_[p] += (fin.primary_ - debut.primary_) * part ;
+        closest_[p] += (fin.closest_ - debut.closest_) * part ;
+        shadow_[p] += (fin.shadow_ - debut.shadow_) * part ;
+        shape_tests_[p] += (fin.shape_tests_ - debut.shape_tests_) * part ;
+        nodes_[p] += (fin.nodes_ - debut.nodes_) * part ;
+        depth_[p] = std::max(depth_[p], fin.depth_) ;
+    }
+}
+
+void RenderStats::add_tile_time(int x0, int y0, int x1, int y1, double secondes) {
+    if (width_ == 0) {
+        return ;
+    }
+    for (int y = y0 ; y < y1 ; y++) {
+        for (int x = x0 ; x < x1 ; x++) {
+            tile_time_[x + static_cast<size_t>(y) * width_] += secondes ;
+        }
+    }
+    std::lock_guard<std::mutex> lock(tiles_mutex_) ;
+    tiles_[std::make_pair(x0, y0)] += secondes ;
+}
+
+void RenderStats::add_batch_time(const int * pixels, const int * paths, int debut, int fin, double secondes) {
+    if (width_ == 0 || fin <= debut) {
+        return ;
+    }
+    double part = secondes / (fin - debut) ;
+    for (int i = debut ; i < fin ; i++) {
+        tile_time_[pixels[paths != nullptr ? paths[i] : i]] += part ;
+    }
+}
+
+bool RenderStats::save_heatmap(const std::string & filename, const std::vector<double> & valeurs, double * echelle) const {
+    // Le 99e centile, pour que les quelques pixels les plus chers ne rendent pas tous les autres noirs
+    std::vector<double> tri(valeurs) ;
+    size_t rang = std::min(tri.size() - 1, tri.size() * 99 / 100) ;
+    std::nth_element(tri.begin(), tri.begin() + rang, tri.end()) ;
+    *echelle = std::max(tri[rang], 1E-12) ;
+
+    std::vector<unsigned char> rgb(3 * valeurs.size()) ;
+    for (size_t i = 0 ; i < valeurs.size() ; i++) {
+        float v = static_cast<float>(std::min(1.0, valeurs[i] / *echelle)) * 4.0f ;
+        int k = std::min(static_cast<int>(v), 3) ;
+        float f = v - k ;
+        for (int c = 0 ; c < 3 ; c++) {
+            float couleur = RAMPE_CHALEUR[k][c] + f * (RAMPE_CHALEUR[k + 1][c] - RAMPE_CHALEUR[k][c]) ;
+            rgb[3 * i + c] = static_cast<unsigned char>(255.0f * couleur + 0.5f) ;
+        }
+    }
+    return save_image(filename, width_, height_, rgb) ;
+}
+
+bool RenderStats::save_heatmaps(const std::string & nom, const std::string & extension) const {
+    if (width_ == 0) {
+        return false ;
+    }
+    size_t n = primary_.size() ;
+    std::vector<double> rayons(n), profondeur(n) ;
+    for (size_t i = 0 ; i < n ; i++) {
+        // Les rayons primaires sont aussi comptés dans closest_
+        rayons[i] = closest_[i] + shadow_[i] ;
+        profondeur[i] = depth_[i] ;
+    }
+    const std::pair<const char *, const std::vector<double> *> cartes[] = {
+        { "rayons", &rayons }, { "ombres", &shadow_ }, { "tests", &shape_tests_ }, { "noeuds", &nodes_ },
+        { "profondeur", &profondeur }, { "temps", &tile_time_ }
+    } ;
+    bool ok = true ;
+    for (const auto & carte : cartes) {
+        double echelle ;
+        std::string fichier = nom + "_" + carte.first + extension ;
+        if (save_heatmap(fichier, *carte.second, &echelle)) {
+            std::cout << "Carte " << fichier << " (blanc : " << echelle << ")" << std::endl ;
+        }
+        else {
+            ok = false ;
+        }
+    }
+    return ok ;
+}
+
+void RenderStats::report(std::ostream & st) const {
+    if (width_ == 0) {
+        return ;
+    }
+    double primaires = 0.0, proches = 0.0, ombres = 0.0, tests = 0.0, noeuds = 0.0 ;
+    int profondeur_max = 0 ;
+    std::vector<long long> profondeurs ;
+    for (size_t i = 0 ; i < primary_.size() ; i++) {
+        primaires += primary_[i] ;
+        proches += closest_[i] ;
+        ombres += shadow_[i] ;
+        tests += shape_tests_[i] ;
+        noeuds += nodes_[i] ;
+        profondeur_max = std::max(profondeur_max, depth_[i]) ;
+        if (depth_[i] >= static_cast<int>(profondeurs.size())) {
+            profondeurs.resize(depth_[i] + 1, 0) ;
+        }
+        profondeurs[depth_[i]]++ ;
+    }
+    double nb_pixels = static_cast<double>(primary_.size()) ;
+    double rayons = proches + ombres ;
+
+    st << std::fixed << std::setprecision(2) ;
+    st << "Statistiques du rendu (" << width_ << "x" << height_ << ")" << std::endl ;
+    st << "  rayons primaires   : " << std::setw(14) << primaires << "  (" << primaires / nb_pixels << " par pixel)" << std::endl ;
+    st << "  rayons secondaires : " << std::setw(14) << proches - primaires << "  (" << (proches - primaires) / nb_pixels << " par pixel)" << std::endl ;
+    st << "  rayons d'ombre     : " << std::setw(14) << ombres << "  (" << ombres / nb_pixels << " par pixel)" << std::endl ;
+    st << "  tests de primitives: " << std::setw(14) << tests << "  (" << tests / std::max(rayons, 1.0) << " par rayon)" << std::endl ;
+    st << "  noeuds visités     : " << std::setw(14) << noeuds << "  (" << noeuds / std::max(rayons, 1.0) << " par rayon)" << std::endl ;
+    st << "  profondeur max     : " << profondeur_max << std::endl ;
+    st << "  pixels par profondeur max :" ;
+    for (size_t d = 0 ; d < profondeurs.size() ; d++) {
+        if (profondeurs[d] > 0) {
+            st << " " << d << ":" << profondeurs[d] ;
+        }
+    }
+    st << std::endl ;
+
+    // L'intégrateur par vagues n'a pas de tuiles : son temps n'est que dans la carte, partagé entre les pixels des lots
+    if (tiles_.empty()) {
+        st << "  tuiles les plus lentes : aucune tuile (intégrateur par vagues), le temps de chaque lot de rayons est"
+           << " partagé entre ses pixels dans la carte _temps" << std::endl ;
+    }
+    else {
+        std::vector<std::pair<double, std::pair<int, int>>> tuiles ;
+        for (const std::pair<const std::pair<int, int>, double> & tuile : tiles_) {
+            tuiles.push_back(std::make_pair(tuile.second, tuile.first)) ;
+        }
+        std::sort(tuiles.begin(), tuiles.end(), [](const std::pair<double, std::pair<int, int>> & a, const std::pair<double, std::pair<int, int>> & b) {
+            return a.first > b.first ;
+        }) ;
+        st << "  tuiles les plus lentes (coin haut gauche, ms) :" ;
+        for (int k = 0 ; k < std::min(NB_TUILES_LENTES, static_cast<int>(tuiles.size())) ; k++) {
+            st << " (" << tuiles[k].second.first << "," << tuiles[k].second.second << ") " << 1000.0 * tuiles[k].first ;
+        }
+        st << std::endl ;
+    }
+    st << std::defaultfloat ;
+}
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+/**
+ * Statistiques du rendu, pixel par pixel : rayons lancés par type, tests de primitives, noeuds de Bvh visités,
+ * profondeur des chemins et temps de calcul des tuiles. Elles servent à trouver les régions de l'image qui
+ * coûtent cher (incidences rasantes, longues suites de miroirs) et à régler les structures d'accélération.
+ *
+ * Elles n'existent que si le code est compilé avec -DRT_STATS : sinon les macros RT_STAT ne font rien,
+ * et le rendu normal ne paie rien.
+ *
+ * Les compteurs sont incrémentés sans synchronisation dans une StatCounters propre à chaque thread. Les boucles de
+ * rendu, qui savent quels pixels elles calculent, reportent ensuite sur ces pixels ce que les compteurs du thread
+ * ont gagné entre-temps (RT_STATS_PIXELS, qui prend les arguments d'un constructeur de PixelStatsScope). Le travail
+ * fait pour un paquet de rayons primaires (un noeud visité ou une forme testée pour tout le paquet compte une fois)
+ * est partagé à parts égales entre les pixels du paquet.
+ *
+ * Le banc d'essai (bench/bench.cpp), compilé avec -DRT_COUNT_RAYS, n'a besoin que des compteurs : RT_STAT compte
+ * alors dans les mêmes StatCounters, dont total_stats() fait la somme sur tous les threads, sans statistiques
+ * par pixel.
+*/
+
+#if defined(RT_STATS) || defined(RT_COUNT_RAYS)
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Les compteurs d'un thread, qui ne font que croître
+*/
+struct StatCounters {
+    /**
+     * @brief Les rayons qui partent de la caméra
+    */
+    uint64_t primary_ ;
+    /**
+     * @brief Tous les rayons dont on cherche l'intersection la plus proche (caméra, miroirs, rebonds)
+    */
+    uint64_t closest_ ;
+    /**
+     * @brief Les rayons d'ombre, vers les lumières
+    */
+    uint64_t shadow_ ;
+    /**
+     * @brief Les tests d'intersection d'une primitive (forme, plan ou triangle d'un maillage)
+    */
+    uint64_t shape_tests_ ;
+    /**
+     * @brief Les noeuds de Bvh visités, ceux des maillages et des géométries instanciées compris
+    */
+    uint64_t nodes_ ;
+    /**
+     * @brief Le nombre de surfaces touchées par le chemin le plus long depuis le dernier report sur un pixel
+    */
+    int depth_ ;
+
+    /**
+     * @brief Ajoute les compteurs d'un autre thread à ceux-ci (la profondeur n'est pas additionnée)
+     *
+     * @param c : référence vers les compteurs ajoutés
+    */
+    void add(const StatCounters & c) {
+        primary_ += c.primary_ ;
+        closest_ += c.closest_ ;
+        shadow_ += c.shadow_ ;
+        shape_tests_ += c.shape_tests_ ;
+        nodes_ += c.nodes_ ;
+    }
+} ;
+
+/**
+ * @brief La classe StatThreads connaît les compteurs de tous les threads, pour en faire la somme
+ *
+ * Les compteurs d'un thread qui se termine sont ajoutés à ceux des threads terminés : un pool détruit entre deux
+ * mesures ne fait pas perdre ses rayons.
+*/
+class StatThreads {
+    private :
+        std::mutex mutex_ ;
+        std::vector<const StatCounters *> vivants_ ;
+        StatCounters termines_ = {} ;
+    public :
+        void add(const StatCounters * c) {
+            std::lock_guard<std::mutex> lock(mutex_) ;
+            vivants_.push_back(c) ;
+        }
+        void remove(const StatCounters * c) {
+            std::lock_guard<std::mutex> lock(mutex_) ;
+            termines_.add(*c) ;
+            vivants_.erase(std::find(vivants_.begin(), vivants_.end(), c)) ;
+        }
+        /**
+         * @brief Fait la somme des compteurs de tous les threads
+         *
+         * Les compteurs des autres threads sont lus sans synchronisation : à appeler quand ils ne calculent pas,
+         * après la fin d'un rendu.
+         *
+         * @return Les compteurs de tous les threads, vivants et terminés, additionnés
+        */
+        StatCounters total() {
+            std::lock_guard<std::mutex> lock(mutex_) ;
+            StatCounters somme = termines_ ;
+            for (const StatCounters * c : vivants_) {
+                somme.add(*c) ;
+            }
+            return somme ;
+        }
+} ;
+
+/**
+ * @brief Donne la liste des compteurs de tous les threads
+ *
+ * @return Référence vers la liste, partagée par tous les threads
+*/
+inline StatThreads & get_stat_threads() {
+    static StatThreads threads ;
+    return threads ;
+}
+
+/**
+ * @brief Les compteurs d'un thread, inscrits dans get_stat_threads() pendant la vie du thread
+*/
+struct ThreadStats {
+    StatCounters counters_ = {} ;
+    ThreadStats() { get_stat_threads().add(&counters_) ; }
+    ~ThreadStats() { get_stat_threads().remove(&counters_) ; }
+} ;
+
+/**
+ * @brief Donne les compteurs du thread appelant
+ *
+ * @return Référence vers les compteurs, propres au thread
+*/
+inline StatCounters & thread_stats() {
+    static thread_local ThreadStats stats ;
+    return stats.counters_ ;
+}
+
+/**
+ * @brief Donne la somme des compteurs de tous les threads depuis le lancement du programme
+ *
+ * La différence entre deux appels donne le travail fait entre-temps, tous threads confondus.
+ *
+ * @return Les compteurs additionnés
+ * @see StatThreads::total
+*/
+inline StatCounters total_stats() {
+    return get_stat_threads().total() ;
+}
+
+# define RT_STAT(compteur) (thread_stats().compteur++)
+# define RT_STAT_N(compteur, n) (thread_stats().compteur += static_cast<uint64_t>(n))
+
+#else
+
+# define RT_STAT(compteur)
+# define RT_STAT_N(compteur, n)
+
+#endif
+
+#ifdef RT_STATS
+
+#include "Packet.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief La classe RenderStats garde les statistiques de chaque pixel de l'image rendue
+ *
+ * Deux threads ne calculent jamais le même pixel en même temps : chaque pixel est écrit sans synchronisation.
+ * Le temps de chaque tuile est aussi gardé tuile par tuile, sous un mutex pris une fois par tuile.
+*/
+class RenderStats {
+    private :
+        /**
+         * @brief La taille de l'image, 0 tant que les statistiques ne sont pas demandées
+        */
+        int width_, height_ ;
+        /**
+         * @brief Les compteurs de chaque pixel, cumulés sur toutes les passes
+        */
+        std::vector<double> primary_, closest_, shadow_, shape_tests_, nodes_ ;
+        /**
+         * @brief La plus grande profondeur de chemin de chaque pixel
+        */
+        std::vector<int> depth_ ;
+        /**
+         * @brief Le temps de chaque pixel, en secondes, cumulé sur toutes les passes : celui de sa tuile avec
+         * l'intégrateur récursif, sa part du temps des lots qui ont calculé son chemin avec l'intégrateur par vagues
+        */
+        std::vector<double> tile_time_ ;
+        /**
+         * @brief Le temps passé sur chaque tuile, en secondes, cumulé sur toutes les passes, repéré par le coin haut
+         * gauche (x0, y0) de la tuile
+        */
+        std::map<std::pair<int, int>, double> tiles_ ;
+        /**
+         * @brief Protège tiles_, que les threads complètent à la fin de chaque tuile
+        */
+        std::mutex tiles_mutex_ ;
+
+        /**
+         * @brief Enregistre une carte de chaleur d'une grandeur
+         *
+         * Les valeurs vont du noir (0) au blanc en passant par le bleu, le rouge et le jaune. Le blanc correspond
+         * au 99e centile, pour que quelques pixels extrêmes n'assombrissent pas toute l'image.
+         *
+         * @param filename : référence vers le nom du fichier
+         * @param valeurs : référence vers la valeur de chaque pixel
+         * @param echelle : pointeur vers la valeur représentée en blanc
+         *
+         * @return true si l'image a été enregistrée, false sinon
+        */
+        bool save_heatmap(const std::string & filename, const std::vector<double> & valeurs, double * echelle) const ;
+
+    public :
+        /**
+         * @brief Constructeur par défaut, sans pixel : les reports sont ignorés jusqu'à resize
+        */
+        RenderStats() ;
+
+        /**
+         * @brief Prépare et remet à zéro les statistiques d'une image
+         *
+         * @param width : la largeur de l'image
+         * @param height : la hauteur de l'image
+        */
+        void resize(int width, int height) ;
+
+        /**
+         * @brief Getter de l'attribut width_
+         *
+         * @return L'attribut width_ de la classe
+        */
+        int get_width() const { return width_ ; }
+
+        /**
+         * @brief Reporte sur des pixels le travail fait pour eux par le thread appelant
+         *
+         * @param pixels : les indices (x + y * largeur) des pixels, qui se partagent le travail à parts égales
+         * @param nb_pixels : le nombre de pixels
+         * @param debut : référence vers les compteurs du thread avant ce travail
+        */
+        void add(const int * pixels, int nb_pixels, const StatCounters & debut) ;
+        /**
+         * @brief Ajoute le temps passé sur une tuile de l'intégrateur récursif à la tuile et à chacun de ses pixels
+         *
+         * @param x0 : l'abscisse du coin haut gauche de la tuile
+         * @param y0 : l'ordonnée du coin haut gauche de la tuile
+         * @param x1 : l'abscisse qui suit le coin bas droit de la tuile
+         * @param y1 : l'ordonnée qui suit le coin bas droit de la tuile
+         * @param secondes : le temps passé sur la tuile
+        */
+        void add_tile_time(int x0, int y0, int x1, int y1, double secondes) ;
+        /**
+         * @brief Partage le temps passé sur un lot de rayons de l'intégrateur par vagues entre les pixels de ses chemins
+         *
+         * Le rayon i du lot appartient au chemin paths[i] (au chemin i si paths est nullptr), qui calcule le pixel
+         * pixels[chemin]. Les chemins d'un lot sont distincts et ne sont dans aucun autre lot de la même étape.
+         *
+         * @param pixels : le pixel de chaque chemin de la vague
+         * @param paths : le chemin de chaque rayon, ou nullptr si le rayon i est celui du chemin i
+         * @param debut : le premier rayon du lot
+         * @param fin : le rayon qui suit le dernier rayon du lot
+         * @param secondes : le temps passé sur le lot
+        */
+        void add_batch_time(const int * pixels, const int * paths, int debut, int fin, double secondes) ;
+
+        /**
+         * @brief Enregistre une carte de chaleur par grandeur : nom_rayons, nom_ombres, nom_tests, nom_noeuds,
+         * nom_profondeur et nom_temps, suivis de l'extension
+         *
+         * @param nom : référence vers le début du nom des fichiers
+         * @param extension : référence vers l'extension des fichiers (.bmp ou .ppm)
+         *
+         * @return true si toutes les images ont été enregistrées, false sinon
+        */
+        bool save_heatmaps(const std::string & nom, const std::string & extension) const ;
+        /**
+         * @brief Affiche le bilan de l'image : totaux, moyennes par pixel et par rayon, profondeurs, tuiles les plus lentes
+         *
+         * @param st : le flux sur lequel on écrit le bilan
+        */
+        void report(std::ostream & st) const ;
+} ;
+
+/**
+ * @brief Donne les statistiques du rendu en cours
+ *
+ * @return Référence vers les statistiques, partagées par tous les threads
+*/
+inline RenderStats & get_render_stats() {
+    static RenderStats stats ;
+    return stats ;
+}
+
+/**
+ * @brief Reporte sur des pixels, à la fin de sa portée, le travail fait par le thread pendant sa portée
+ *
+ * Les pixels sont donnés par leurs indices, ou par leurs abscisses sur une ligne : au plus PACKET_SIZE pixels,
+ * ceux d'un paquet de rayons primaires.
+*/
+class PixelStatsScope {
+    private :
+        int pixels_[PACKET_SIZE] ;
+        int nb_pixels_ ;
+        StatCounters debut_ ;
+
+        void start() {
+            thread_stats().depth_ = 0 ;
+            debut_ = thread_stats() ;
+        }
+    public :
+        PixelStatsScope(const int * pixels, int nb_pixels) : nb_pixels_(nb_pixels) {
+            std::copy(pixels, pixels + nb_pixels, pixels_) ;
+            start() ;
+        }
+        PixelStatsScope(int x, int y, int nb_pixels) : nb_pixels_(nb_pixels) {
+            for (int k = 0 ; k < nb_pixels ; k++) {
+                pixels_[k] = x + k + y * get_render_stats().get_width() ;
+            }
+            start() ;
+        }
+        PixelStatsScope(const int * xs, int nb_pixels, int y) : nb_pixels_(nb_pixels) {
+            for (int k = 0 ; k < nb_pixels ; k++) {
+                pixels_[k] = xs[k] + y * get_render_stats().get_width() ;
+            }
+            start() ;
+        }
+        ~PixelStatsScope() { get_render_stats().add(pixels_, nb_pixels_, debut_) ; }
+} ;
+
+/**
+ * @brief Partage entre les pixels d'un lot de rayons, à la fin de sa portée, le temps passé pendant sa portée
+ *
+ * @see RenderStats::add_batch_time
+*/
+class BatchStatsScope {
+    private :
+        const int * pixels_ ;
+        const int * paths_ ;
+        int debut_, fin_ ;
+        std::chrono::steady_clock::time_point temps_ ;
+    public :
+        BatchStatsScope(const int * pixels, const int * paths, int debut, int fin) : pixels_(pixels), paths_(paths),
+                                                                                   debut_(debut), fin_(fin),
+                                                                                   temps_(std::chrono::steady_clock::now()) {}
+        ~BatchStatsScope() {
+            std::chrono::duration<double> duree = std::chrono::steady_clock::now() - temps_ ;
+            get_render_stats().add_batch_time(pixels_, paths_, debut_, fin_, duree.count()) ;
+        }
+} ;
+
+/**
+ * @brief Ajoute à une tuile, à la fin de sa portée, le temps passé pendant sa portée
+*/
+class TileStatsScope {
+    private :
+        int x0_, y0_, x1_, y1_ ;
+        std::chrono::steady_clock::time_point debut_ ;
+    public :
+        TileStatsScope(int x0, int y0, int x1, int y1) : x0_(x0), y0_(y0), x1_(x1), y1_(y1),
+                                                         debut_(std::chrono::steady_clock::now()) {}
+        ~TileStatsScope() {
+            std::chrono::duration<double> duree = std::chrono::steady_clock::now() - debut_ ;
+            get_render_stats().add_tile_time(x0_, y0_, x1_, y1_, duree.count()) ;
+        }
+} ;
+
+# define RT_STAT_DEPTH(profondeur) (thread_stats().depth_ = std::max(thread_stats().depth_, static_cast<int>(profondeur)))
+# define RT_STATS_PIXELS(...) PixelStatsScope rt_stats_pixels_(__VA_ARGS__)
+# define RT_STATS_TILE(x0, y0, x1, y1) TileStatsScope rt_stats_tile_(x0, y0, x1, y1)
+# define RT_STATS_BATCH(pixels, paths, debut, fin) BatchStatsScope rt_stats_batch_(pixels, paths, debut, fin)
+
+#else
+
+# define RT_STAT_DEPTH(profondeur)
+# define RT_STATS_PIXELS(...)
+# define RT_STATS_TILE(x0, y0, x1, y1)
+# define RT_STATS_BATCH(pixels, paths, debut, fin)
+
+#endif
+
+#endif
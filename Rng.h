@@ -0,0 +1,75 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+/**
+ * @brief La classe Rng est un générateur de nombres pseudo-aléatoires rapide (PCG32)
+ * 
+ * Chaque thread, ou chaque pixel, possède son propre générateur : il n'y a aucun état partagé entre
+ * les threads. Le générateur est entièrement défini dans l'en-tête pour que ses appels, très fréquents
+ * dans l'éclairage indirect, soient remplacés par leur code.
+*/
+class Rng {
+    private :
+        /**
+         * @brief L'état interne du générateur
+        */
+        uint64_t state_ ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         * 
+         * Crée un générateur à partir d'une graine. Deux graines différentes, même proches, donnent
+         * des suites indépendantes.
+         * 
+         * @param seed : la graine du générateur
+        */
+        explicit Rng(uint64_t seed = 0) {
+            // On mélange la graine (splitmix64) pour que des graines proches donnent des états éloignés
+            uint64_t z = seed + 0x9E3779B97F4A7C15ull ;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull ;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull ;
+            state_ = z ^ (z >> 31) ;
+        }
+
+        /**
+         * @brief Crée le générateur d'un pixel pour un échantillon donné
+         * 
+         * Le résultat ne dépend que du pixel et du numéro de l'échantillon, et pas du thread qui le calcule :
+         * l'image est donc la même quel que soit le nombre de threads.
+         * 
+         * @param pixel : l'indice du pixel dans l'image
+         * @param sample : le numéro de l'échantillon du pixel
+         * 
+         * @return Le générateur du pixel pour cet échantillon
+        */
+        static Rng for_pixel(uint32_t pixel, uint32_t sample) {
+            return Rng((static_cast<uint64_t>(sample) << 32) | pixel) ;
+        }
+
+        /**
+         * @brief Donne le prochain entier pseudo-aléatoire sur 32 bits
+         * 
+         * @return Un entier uniformément réparti sur [0, 2^32[
+        */
+        uint32_t next() {
+            uint64_t old = state_ ;
+            state_ = old * 6364136223846793005ull + 1442695040888963407ull ;
+            uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u) ;
+            uint32_t rot = static_cast<uint32_t>(old >> 59u) ;
+            return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31)) ;
+        }
+
+        /**
+         * @brief Donne le prochain flottant pseudo-aléatoire
+         * 
+         * @return Un flottant uniformément réparti sur [0, 1[
+        */
+        float uniform() {
+            return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f) ;
+        }
+} ;
+
+#endif
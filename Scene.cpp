@@ -4,42 +4,102 @@
 #include "Shape.h"
 #include "Sdl.h"
 #include "Quad.h"
+#include "ThreadPool.h"
+#include "Image.h"
+#include "Framebuffer.h"
+#include "Accumulator.h"
+#include "RenderStats.h"
+#include "Trace.h"
+#include "Wavefront.h"
+#include "MappedFile.h"
 #include <algorithm>
-#include <random>
-// #include <omp.h>
+#include <utility>
+#include <iostream>
 #include <stdio.h>
+#include <cstdint>
+#include <cstring>
 
 #ifndef M_PI
 # define M_PI 3.1415926535
 #endif
 
-std::default_random_engine engine ;
-std::uniform_real_distribution<double> uniform(0,1) ;
+Scene::Scene() {
+    camera_ = Camera();
+    nb_shadow_rays_ = 1;
+    nb_threads_ = 0;
+}
 
-Scene::Scene(Camera camera, std::vector<Shape*> shapes, Ray3f source) {
+Scene::Scene(Camera camera, std::vector<Shape*> shapes, std::vector<Light> lights, int nb_threads) {
     camera_ = camera;
-    shapes_ = shapes;
-    source_ = source;
+    set_lights(lights);
+    nb_shadow_rays_ = 1;
+    nb_threads_ = nb_threads;
+    set_shapes(shapes);
 }
 
 Scene::Scene(const Scene& s) {
     camera_ = s.get_camera();
     shapes_ = s.get_shapes();
-    source_ = s.get_source();
+    owned_shapes_ = s.owned_shapes_;
+    lights_ = s.get_lights();
+    light_sampler_ = s.light_sampler_;
+    nb_shadow_rays_ = s.nb_shadow_rays_;
+    nb_threads_ = s.nb_threads_;
+    bvh_ = s.get_bvh();
+    compiled_ = s.compiled_;
+    file_ = s.file_;
 }
 
 Scene& Scene::operator=(const Scene& s) {
     if (this != &s) {
         camera_ = s.get_camera();
         shapes_ = s.get_shapes();
-        source_ = s.get_source();
+        owned_shapes_ = s.owned_shapes_;
+        lights_ = s.get_lights();
+        light_sampler_ = s.light_sampler_;
+        nb_shadow_rays_ = s.nb_shadow_rays_;
+        nb_threads_ = s.nb_threads_;
+        bvh_ = s.get_bvh();
+        compiled_ = s.compiled_;
+        file_ = s.file_;
     }
     return *this;
 }
 
+void Scene::set_shapes(std::vector<Shape*> shapes) {
+    std::shared_ptr<std::vector<std::unique_ptr<Shape>>> owned = std::make_shared<std::vector<std::unique_ptr<Shape>>>() ;
+    owned->reserve(shapes.size()) ;
+    for (Shape * shape : shapes) {
+        owned->emplace_back(shape) ;
+    }
+    owned_shapes_ = std::move(owned) ;
+    shapes_ = std::move(shapes) ;
+    build_bvh() ;
+}
+
+void Scene::build_bvh() {
+    // Les plans, infinis, sont rangés après les autres formes et restent hors du Bvh
+    CompiledScene::move_planes_to_end(shapes_) ;
+    bvh_.build(CompiledScene::bounded_boxes(shapes_), nb_threads_) ;
+    compiled_.build(shapes_, bvh_) ;
+    file_.reset() ;
+}
+
+void Scene::set_compiled(Bvh bvh, CompiledScene compiled, std::vector<std::unique_ptr<Shape>> owned,
+                         std::shared_ptr<const MappedFile> file) {
+    shapes_.clear() ;
+    owned_shapes_ = std::make_shared<std::vector<std::unique_ptr<Shape>>>(std::move(owned)) ;
+    bvh_ = std::move(bvh) ;
+    compiled_ = std::move(compiled) ;
+    file_ = file ;
+}
+
 std::ostream & operator<<(std::ostream& st, const Scene& s) {
     st << "Camera : " << s.get_camera() << std::endl ;
-    st << "Source : " << s.get_source() << std::endl ;
+    st << "Lights : " << std::endl ;
+    for (const Light & l : s.get_lights()) {
+        st << l << std::endl ;
+    }
     st << "Shapes : " << std::endl ;
 
     std::vector<Shape*> shapes = s.get_shapes() ;
@@ -49,192 +109,572 @@ std::ostream & operator<<(std::ostream& st, const Scene& s) {
     return st ;
 }
 
+HitRecord Scene::closest_hit (const Ray3f & d) const {
+    RT_STAT(closest_) ;
+    // On va stocker dans closest le point d'intersection le plus proche
+    HitRecord closest = no_hit() ;
+    // On parcourt le BVH : seuls les objets des feuilles traversées par le rayon sont testés,
+    // et les noeuds plus lointains que l'intersection la plus proche trouvée sont élagués.
+    // Pendant le parcours, on ne garde que t et l'id de la forme : P et N seront calculés à la fin.
+    // Les primitives de chaque feuille sont testées type par type dans les tableaux de compiled_
+    // Les plans sont testés d'abord : dans une pièce fermée, ils bornent tout de suite le parcours
+    compiled_.intersect_planes(d, &closest) ;
+    bvh_.traverse(d, closest.t_, [&](int first, int count, float & t_max) {
+        compiled_.intersect(d, first, count, &closest) ;
+        t_max = closest.t_ ;
+        return false ;
+    }) ;
+    return closest ;
+}
+
 bool Scene::intersection (const Ray3f & d, Vector3f * P, Vector3f * N, int * shape_id, float * min_t) const {
-    bool has_inter = false ;
-    // On va stocker dans min_t le point d'intersection le plus proche
-    *min_t = 1E10f ;
-    // Pour chaque objet, on appelle la fonction is_hit
-    // S'il y a intersection, has_inter passe à true
-    // et on récupère le point d'intersection le plus proche
-    for (size_t i = 0;i < shapes_.size();i++){
-        Vector3f localP, localN ;
-        float t ;
-        int local_has_inter = shapes_[i]->is_hit(d,&localP,&localN,&t);
-        if (local_has_inter == 1){
-            has_inter = true ;
-                if(t < *min_t){
-                    *min_t = t ;
-                    *P = localP ;
-                    *N = localN ;
-                    *shape_id = static_cast<int>(i);
-                    // A la fin, on aura bien le vecteur normale N à la sphère la plus proche
-                    // Le point d'intersection P, et l'id de la sphère
-                }
-         }
+    HitRecord hit = closest_hit(d) ;
+    *min_t = hit.t_ ;
+    if (!hit.hit()){
+        return false ;
+    }
+    // On calcule le point d'intersection P et la normale N une seule fois, pour la forme la plus proche
+    *shape_id = hit.shape_id_ ;
+    compiled_.finalize_hit(d,hit,P,N) ;
+    return true ;
+}
+
+bool Scene::occluded (const Ray3f & ray, float t_max) const {
+    RT_STAT(shadow_) ;
+    if (compiled_.occluded_planes(ray, t_max)) {
+        return true ;
     }
+    bool has_inter = false ;
+    // On s'arrête dès le premier objet trouvé avant t_max, peu importe lequel est le plus proche
+    bvh_.traverse(ray, t_max, [&](int first, int count, float &) {
+        has_inter = compiled_.occluded(ray, first, count, t_max) ;
+        return has_inter ;
+    }) ;
     return has_inter ;
 }
 
-const float INTENSITE_LUMIERE = 3000000000.0f ;
+// Nombre de rebonds toujours suivis avant que la roulette russe puisse arrêter un chemin
+const int REBONDS_AVANT_ROULETTE = 3 ;
 
-Material Scene::get_color(const Ray3f & ray, int nb_rebonds) const {
+Material Scene::get_color(const Ray3f & ray, int nb_rebonds, Rng * rng) const {
 
     if (nb_rebonds == 0){
         return Material(0.0f,0.0f,0.0f,0.0f) ;
     }
+    return shade(ray, closest_hit(ray), nb_rebonds, rng) ;
+}
 
-    // N est le vecteur normal à la sphère en ce point, si intersection
-    // P est le point d'intersection avec la sphère, si intersection
-    // Ces vecteurs prendront des valeurs dans la fonction is_hit
-    Vector3f P,N ;
-
-    // Numéro de la sphère intersectée dans sphère
-    // Le numéro sera trouvée avec la fonction scene::intersection
-    int shape_id ;
-    float t ;
-    bool has_inter = intersection(ray,&P,&N,&shape_id,&t) ;       
-    // Pour chaque pixel, on regarde s'il y a intersection avec la sphère
-    // Si oui, on remplit ce pixel, en prenant bien en compte la source de lumière
+Material Scene::shade(const Ray3f & ray, const HitRecord & hit, int nb_rebonds, Rng * rng) const {
+    // Le chemin est suivi dans une boucle : à chaque rebond, on ajoute l'éclairage direct du point touché,
+    // pondéré par poids, la fraction de lumière que les rebonds précédents renvoient vers le pixel
     Material intensite_pixel(0.0f,0.0f,0.0f,0.0f) ;
-    // -- A utiliser si utilisation de l'éclairage indirect
-    // if (ray.get_direction() == Vector3f (0.0f)){
-    //     has_inter = false ;
-    // }
-    // else 
-    if (has_inter) {
-        if (shapes_[shape_id]->get_miroir()){
-            Vector3f direction_miroir = ray.get_direction() - 2 * dot(N,ray.get_direction())*N ;
-            Ray3f rayon_miroir(P + 0.01*N, direction_miroir) ;
-            intensite_pixel = get_color(rayon_miroir,nb_rebonds-1);
+    Vector3f poids(1.0f,1.0f,1.0f) ;
+    Ray3f rayon = ray ;
+    HitRecord inter = hit ;
+
+    for (int rebond = 0 ; inter.hit() ; rebond++) {
+        RT_STAT_DEPTH(rebond + 1) ;
+        // N est le vecteur normal à la forme au point d'intersection P
+        Vector3f P,N ;
+        int shape_id = inter.shape_id_ ;
+        hit_point(rayon,inter,&P,&N) ;
+        // Le dernier rebond permis est éclairé, mais ne relance pas de rayon
+        bool dernier = (rebond + 1 == nb_rebonds) ;
+
+        if (compiled_.get_miroir(shape_id)){
+            if (dernier) {
+                break ;
+            }
+            rayon = reflected_ray(rayon,P,N) ;
         }
         else {
-            // Vecteur qui va du point d'intersection sphère-rayon à la source de lumière
-            Vector3f L = source_.get_centre() - P ;
-
             // -- Code pour faire apparaitre les ombres
-            // On trace un rayon qui part du point d'intersection vers la lumière
-            // On regarde s'il s'intersecte avec un autre objet avant d'arriver à la lumière
-            // Si oui, il est l'ombre d'un objet, et donc on lui met un pixel noir
-            Ray3f ray_light(P+0.01f*N,L.get_normalised()) ;
-            Vector3f P_light, N_light ;
-            int sphere_id_light ;
-            float t_light ;
-            bool has_inter_light = intersection(ray_light,&P_light,&N_light,&sphere_id_light,&t_light) ;
-            double d_light2 = L.norme2() ;
-            if (has_inter_light && t_light*t_light < d_light2){
-                intensite_pixel = Material(0.0f,0.0f,0.0f,0.0f) ;
+            // On trace des rayons qui partent du point d'intersection vers des points des lumières
+            // On regarde si chacun s'intersecte avec un autre objet avant d'arriver à la lumière
+            // Si oui, il est dans l'ombre d'un objet, et n'apporte pas de lumière directe
+            // Les rayons d'une lumière étendue dont seule une partie est cachée donnent une ombre douce
+            Vector3f decalage = light_offset(P,rng) ;
+            int nb_ombres = get_shadow_rays() ;
+            for (int k = 0 ; k < nb_ombres ; k++) {
+                Ray3f ray_light ;
+                float d_light ;
+                Material lumiere = direct_light(P,N,shape_id,decalage,k,&ray_light,&d_light) ;
+                if (!occluded(ray_light, d_light)){
+                    intensite_pixel += lumiere * poids ;
+                }
             }
-            else {
-                // -- Contribution de l'éclairage direct
-                // -- Modèle d'éclairage lambertien
-   
-                // Calcul intensité du pixel
-                float cos_theta = std::max(0.0f, dot(L.get_normalised(), N));
 
-                Vector3f intensite_pixel_vector = shapes_[shape_id]->get_albedo() * INTENSITE_LUMIERE * cos_theta /d_light2 ;
-                intensite_pixel = Material(1.0f,1.0f,1.0f,0.0f) * intensite_pixel_vector;
+            // -- Contribution de l'éclairage indirect
+            // L'éclairage indirect va permettre d'avoir un rendu plus réaliste, des ombres plus douces
+            // Il n'est calculé qu'avec un générateur aléatoire, c'est-à-dire en rendu progressif.
+            // Il s'ajoute aussi aux points à l'ombre, qui ne sont éclairés que par lui
+            // Quad::normal ne donne pas toujours une normale (elle est alors nulle) : dans ce cas on ne relance pas
+            // de rayon, sa direction serait nulle et donnerait des NaN qui se propageraient aux pixels qui voient ce point
+            if (rng == nullptr || dernier || !(dot(N,N) > 0.0f)){
+                break ;
+            }
+            rayon = diffuse_ray(P,N,*rng) ;
+            poids = poids * compiled_.get_albedo(shape_id) ;
+        }
 
-                // -- Contribution de l'éclairage indirect
-                // L'éclairage indirect va permettre d'avoir un rendu plus réaliste, des ombres plus douces
+        if (rng != nullptr && !russian_roulette(rebond, &poids, *rng)) {
+            break ;
+        }
+        inter = closest_hit(rayon) ;
+    }
+    return intensite_pixel ;
+}
 
-                // double r1 = uniform(engine) ;
-                // double r2 = uniform(engine) ;
-                // Vector3f direction_aleatoire_repere_local(static_cast<float>(cos(2*M_PI*r1)*sqrt(1-r2)),static_cast<float>(sin(2*M_PI*r1)*sqrt(1-r2)),static_cast<float>(sqrt(r2))) ;
-                // Vector3f aleatoire(uniform(engine)-0.5,uniform(engine)-0.5,uniform(engine)-0.5) ;
-                // Vector3f tangent1 = cross(N,aleatoire) ; tangent1.normalize() ;
-                // Vector3f tangent2 = cross (tangent1, N) ;
+bool Scene::russian_roulette(int rebond, Vector3f * poids, Rng & rng) {
+    if (rebond + 1 < REBONDS_AVANT_ROULETTE) {
+        return true ;
+    }
+    // Le chemin continue avec une probabilité qui suit son poids : les chemins qui ne renvoient presque plus
+    // de lumière s'arrêtent vite. Le poids des chemins qui continuent est divisé par cette probabilité,
+    // pour que la moyenne reste la même (pas de biais). Elle ne dépasse pas 0.95, pour que même une
+    // suite de miroirs s'arrête
+    float q = std::min(0.95f, std::max(poids->get_x(), std::max(poids->get_y(), poids->get_z()))) ;
+    if (rng.uniform() >= q) {
+        return false ;
+    }
+    *poids /= Vector3f(q) ;
+    return true ;
+}
 
-                // Vector3f direction_aleatoire = direction_aleatoire_repere_local.get_z() * N + direction_aleatoire_repere_local.get_x() * tangent1 + 
-                //     direction_aleatoire_repere_local.get_y() * tangent2 ;
+void Scene::hit_point(const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const {
+    compiled_.finalize_hit(ray,hit,P,N) ;
+}
 
-                // Ray3f rayon_aleatoire(P + 0.001*N,direction_aleatoire) ;
+Ray3f Scene::reflected_ray(const Ray3f & ray, const Vector3f & P, const Vector3f & N) const {
+    Vector3f direction_miroir = ray.get_direction() - 2 * dot(N,ray.get_direction())*N ;
+    return Ray3f(P + 0.01*N, direction_miroir) ;
+}
 
-                // intensite_pixel += get_color (rayon_aleatoire,nb_rebonds - 1)* shapes_[shape_id]->get_albedo() ;
-            }
-        }
+// Un générateur qui ne dépend que de la position du point, pour tirer les échantillons de lumière sans générateur
+// aléatoire
+static Rng point_rng(const Vector3f & P) {
+    uint32_t x, y, z ;
+    float px = P.get_x(), py = P.get_y(), pz = P.get_z() ;
+    std::memcpy(&x, &px, sizeof(x)) ;
+    std::memcpy(&y, &py, sizeof(y)) ;
+    std::memcpy(&z, &pz, sizeof(z)) ;
+    return Rng((static_cast<uint64_t>(x) << 32) ^ (static_cast<uint64_t>(y) << 16) ^ z) ;
+}
+
+// La suite R3 de Roberts : les multiples de ces nombres, modulo 1, sont bien répartis dans [0, 1[^3 pour
+// tout nombre d'échantillons (ce sont les puissances de l'inverse du nombre plastique généralisé)
+const float R3_X = 0.8191725134f ;
+const float R3_Y = 0.6710436067f ;
+const float R3_Z = 0.5497004779f ;
+
+static float fraction(float x) {
+    return x - std::floor(x) ;
+}
+
+Vector3f Scene::light_offset(const Vector3f & P, Rng * rng) const {
+    // Tous les échantillons d'une seule lumière ponctuelle sont le même point
+    if (lights_.size() <= 1 && (lights_.empty() || !lights_[0].is_area())) {
+        return Vector3f(0.0f,0.0f,0.0f) ;
     }
-    return intensite_pixel ;
+    Rng local = point_rng(P) ;
+    Rng & generateur = (rng != nullptr) ? *rng : local ;
+    float x = generateur.uniform() ;
+    float y = generateur.uniform() ;
+    float z = generateur.uniform() ;
+    return Vector3f(x,y,z) ;
 }
 
+Material Scene::direct_light(const Vector3f & P, const Vector3f & N, int shape_id, const Vector3f & decalage, int k,
+                             Ray3f * ray_light, float * d_light) const {
+    // -- Choix de la lumière selon sa puissance, puis d'un point de cette lumière
+    float u0 = fraction(decalage.get_x() + k * R3_X) ;
+    float u1 = fraction(decalage.get_y() + k * R3_Y) ;
+    float u2 = fraction(decalage.get_z() + k * R3_Z) ;
+    float pdf = 0.0f ;
+    int l = light_sampler_.sample(u0, &pdf) ;
+    if (l < 0 || !(pdf > 0.0f)) {
+        *ray_light = Ray3f(P+0.01f*N,N) ;
+        *d_light = 0.0f ;
+        return Material(0.0f,0.0f,0.0f,0.0f) ;
+    }
+    const Light & lumiere = lights_[l] ;
+    float facteur ;
+    Vector3f Y = lumiere.sample(u1, u2, P, &facteur) ;
+
+    // Vecteur qui va du point d'intersection au point de la lumière
+    Vector3f L = Y - P ;
+    *ray_light = Ray3f(P+0.01f*N,L.get_normalised()) ;
+    double d_light2 = L.norme2() ;
+    *d_light = static_cast<float>(std::sqrt(d_light2)) ;
+
+    // -- Contribution de l'éclairage direct
+    // -- Modèle d'éclairage lambertien
+    float cos_theta = std::max(0.0f, dot(L.get_normalised(), N));
+    // Divisée par la probabilité de l'échantillon, pour que la somme des échantillons soit en moyenne celle de toutes les lumières
+    float puissance = lumiere.get_puissance() * facteur / (pdf * get_shadow_rays()) ;
+    Vector3f intensite_pixel_vector = compiled_.get_albedo(shape_id) * puissance * cos_theta /d_light2 ;
+    return Material(1.0f,1.0f,1.0f,0.0f) * intensite_pixel_vector;
+}
 
-void Scene::render(int largeur, int hauteur, const std::string & filename){
-    // On crée l'objet sdl
-    Sdl sdl(largeur, hauteur, filename);
+Ray3f Scene::diffuse_ray(const Vector3f & P, const Vector3f & N, Rng & rng) const {
+    // Direction aléatoire selon une loi en cosinus autour de la normale
+    double r1 = rng.uniform() ;
+    double r2 = rng.uniform() ;
+    Vector3f direction_aleatoire_repere_local(static_cast<float>(cos(2*M_PI*r1)*sqrt(1-r2)),static_cast<float>(sin(2*M_PI*r1)*sqrt(1-r2)),static_cast<float>(sqrt(r2))) ;
+    Vector3f aleatoire(rng.uniform()-0.5f,rng.uniform()-0.5f,rng.uniform()-0.5f) ;
+    Vector3f tangent1 = cross(N,aleatoire) ; tangent1.normalize() ;
+    Vector3f tangent2 = cross (tangent1, N) ;
 
-    if (!sdl.isValid()) {
-        std::cerr << "Erreur lors de l'initialisation de SDL." << std::endl ;
+    Vector3f direction_aleatoire = direction_aleatoire_repere_local.get_z() * N + direction_aleatoire_repere_local.get_x() * tangent1 + 
+        direction_aleatoire_repere_local.get_y() * tangent2 ;
+
+    return Ray3f(P + 0.001*N,direction_aleatoire) ;
+}
+
+Ray3f Scene::get_camera_ray(int x, int y, Rng * rng) const {
+    RT_STAT(primary_) ;
+    // Vecteur qui part de la caméra et qui va jusqu'au pixel, sur le plan de mise au point
+    Vector3f origine = camera_.get_position() ;
+    Vector3f direction_camera = camera_.pixel_direction(static_cast<float>(x), static_cast<float>(y)) ;
+    // Avec une lentille, le rayon part d'un point de la lentille et vise le même point du plan net
+    if (rng != nullptr && camera_.get_aperture() > 0.0f) {
+        float u1 = rng->uniform() ;
+        float u2 = rng->uniform() ;
+        Vector3f lentille = camera_.lens_offset(u1, u2) ;
+        origine += lentille ;
+        direction_camera -= lentille ;
+    }
+    // On le normalise
+    direction_camera.normalize();
+
+    // Rayon qui part de la caméra dont la direction est vers le pixel
+    return Ray3f(origine, direction_camera);
+}
+
+void Scene::get_camera_rays(const int * xs, int y, int nb_rays, Ray3f * rays, Rng * rngs) const {
+    if (rngs != nullptr && camera_.get_aperture() > 0.0f) {
+        for (int k = 0 ; k < nb_rays ; k++) {
+            rays[k] = get_camera_ray(xs[k], y, &rngs[k]) ;
+        }
         return ;
     }
+    RT_STAT_N(primary_, nb_rays) ;
 
-    SDL_Renderer* renderer = sdl.getRenderer();
+    // Le début de la ligne est commun aux rayons, puis chaque voie avance de x pas : les mêmes calculs, dans le
+    // même ordre, que pixel_direction et normalize, donc les mêmes rayons que get_camera_ray
+    float x[PACKET_SIZE] = {} ;
+    for (int k = 0 ; k < nb_rays ; k++) {
+        x[k] = static_cast<float>(xs[k]) ;
+    }
+    PacketFloat px = PacketFloat::load(x) ;
+    Vector3f ligne = camera_.row_direction(static_cast<float>(y)) ;
+    Vector3f pas = camera_.get_du() ;
+    PacketFloat dx = PacketFloat(ligne.get_x()) + px * PacketFloat(pas.get_x()) ;
+    PacketFloat dy = PacketFloat(ligne.get_y()) + px * PacketFloat(pas.get_y()) ;
+    PacketFloat dz = PacketFloat(ligne.get_z()) + px * PacketFloat(pas.get_z()) ;
+    PacketFloat longueur = packet_sqrt(dx * dx + dy * dy + dz * dz) ;
+    float d[3][PACKET_SIZE] ;
+    (dx / longueur).store(d[0]) ;
+    (dy / longueur).store(d[1]) ;
+    (dz / longueur).store(d[2]) ;
+
+    Vector3f origine = camera_.get_position() ;
+    for (int k = 0 ; k < nb_rays ; k++) {
+        rays[k] = Ray3f(origine, Vector3f(d[0][k], d[1][k], d[2][k])) ;
+    }
+}
 
-    // -- Partie à utiliser si utilisation de l'éclairage indirect
-    // int nrays = 30 ;
-    // --
+Material Scene::get_pixel_color(int x, int y) const {
+    return get_color(get_camera_ray(x, y),NB_REBONDS_MAX) ;
+}
 
-    // Sert pour enregistrer l'image
-    SDL_Surface *surface = SDL_CreateRGBSurface(0, largeur, hauteur, 32, 0, 0, 0, 0);
+Material Scene::get_pixel_sample(int x, int y, Rng & rng) const {
+    Ray3f ray = get_camera_ray(x, y, &rng) ;
+    return get_color(ray,NB_REBONDS_MAX,&rng) ;
+}
 
-    // On parcourt chaque pixel
-    for (int y = 0; y < hauteur; ++y) {
-        for (int x = 0; x < largeur; ++x) {
+void Scene::closest_hit_packet(const Ray3f * rays, int nb_rays, HitRecord * hits) const {
+    RT_STAT_N(closest_, nb_rays) ;
+    RayPacket packet(rays, nb_rays) ;
+    PacketHit closest ;
+    closest.t_ = PacketFloat(no_hit().t_) ;
+    for (int k = 0 ; k < PACKET_SIZE ; k++) {
+        closest.shape_id_[k] = -1 ;
+        closest.primitive_[k] = -1 ;
+    }
 
-            // Point correspondant au pixel
-            Vector3f worldPoint(x, y, 0);
+    // Le même parcours que closest_hit, mais un noeud est visité dès qu'un des rayons le traverse
+    compiled_.intersect_planes_packet(packet, &closest) ;
+    bvh_.traverse_packet(packet, closest.t_, [&](int first, int count, PacketFloat & t_max) {
+        compiled_.intersect_packet(packet, first, count, &closest) ;
+        t_max = closest.t_ ;
+    }) ;
+
+    float t[PACKET_SIZE] ;
+    closest.t_.store(t) ;
+    for (int k = 0 ; k < nb_rays ; k++) {
+        hits[k].t_ = t[k] ;
+        hits[k].shape_id_ = closest.shape_id_[k] ;
+        hits[k].primitive_ = closest.primitive_[k] ;
+    }
+}
+
+void Scene::get_pixel_colors(int x, int y, int nb_pixels, Material * colors) const {
+    // Les rayons primaires de pixels voisins sont presque parallèles : on cherche leurs intersections ensemble,
+    // puis chaque rayon continue seul (ombre, miroir)
+    Ray3f rays[PACKET_SIZE] ;
+    HitRecord hits[PACKET_SIZE] ;
+    {
+        RT_STATS_PIXELS(x, y, nb_pixels) ;
+        int xs[PACKET_SIZE] ;
+        for (int k = 0 ; k < PACKET_SIZE ; k++) {
+            xs[k] = x + k ;
+        }
+        get_camera_rays(xs, y, nb_pixels, rays, nullptr) ;
+        closest_hit_packet(rays, nb_pixels, hits) ;
+    }
+
+    for (int k = 0 ; k < nb_pixels ; k++) {
+        RT_STATS_PIXELS(x + k, y, 1) ;
+        colors[k] = shade(rays[k], hits[k], NB_REBONDS_MAX, nullptr) ;
+    }
+}
+
+// Côté d'une tuile en pixels : assez petit pour bien équilibrer la charge entre les threads,
+// assez grand pour que le coût de la prise d'une tâche reste négligeable
+const int TAILLE_TUILE = 16 ;
+
+// Nombre d'échantillons qu'un pixel doit avoir avant qu'on fasse confiance à sa variance
+const int MIN_SAMPLES_ADAPTATIF = 16 ;
+
+int Scene::accumulate_pass(Accumulator & accumulator, ThreadPool & pool, float threshold, Wavefront * wavefront,
+                           const std::function<bool()> & cancelled) const {
+    RT_TRACE("passe") ;
+    if (wavefront != nullptr) {
+        wavefront->add_samples(accumulator, pool, cancelled) ;
+    }
+    else {
+        trace_pass(accumulator, pool, cancelled) ;
+    }
+    accumulator.end_pass() ;
+
+    if (threshold > 0.0f) {
+        return accumulator.retire_converged(threshold, MIN_SAMPLES_ADAPTATIF, TAILLE_TUILE) ;
+    }
+    return accumulator.get_nb_active() ;
+}
 
-            // Vecteur qui part de la caméra et qui va jusqu'au pixel
-            Vector3f direction_camera = Vector3f(x-camera_.get_position().get_x(),y-camera_.get_position().get_y(),-camera_.get_position().get_z()); // -largeur / (2.0 * tan(fov / 2.0)));
-            // On le normalise
-            direction_camera.normalize();
-            
-            // Rayon qui part de la caméra dont la direction est vers le pixel
-            Ray3f ray(camera_.get_position(), direction_camera);
+void Scene::trace_pass(Accumulator & accumulator, ThreadPool & pool, const std::function<bool()> & cancelled) const {
+    int largeur = accumulator.get_width() ;
+    int hauteur = accumulator.get_height() ;
+    int nb_tuiles_x = (largeur + TAILLE_TUILE - 1) / TAILLE_TUILE ;
+    int nb_tuiles_y = (hauteur + TAILLE_TUILE - 1) / TAILLE_TUILE ;
+
+    // Chaque pixel a son propre générateur, qui ne dépend que du pixel et de son nombre d'échantillons :
+    // aucun état aléatoire n'est partagé entre les threads, et l'image ne dépend pas du nombre de threads
+    pool.parallel_for(nb_tuiles_x * nb_tuiles_y, [&](int tuile) {
+        // Une passe abandonnée ne prend plus de tuile : les threads vident la file sans calculer
+        if (cancelled && cancelled()) {
+            return ;
+        }
+        int x0 = (tuile % nb_tuiles_x) * TAILLE_TUILE ;
+        int y0 = (tuile / nb_tuiles_x) * TAILLE_TUILE ;
+        int x1 = std::min(x0 + TAILLE_TUILE, largeur) ;
+        int y1 = std::min(y0 + TAILLE_TUILE, hauteur) ;
+        RT_TRACE("tuile") ;
+        RT_STATS_TILE(x0, y0, x1, y1) ;
+        for (int y = y0 ; y < y1 ; ++y) {
+            // Les pixels de la ligne qui n'ont pas convergé sont tracés par paquets de rayons primaires
+            Ray3f rays[PACKET_SIZE] ;
+            HitRecord hits[PACKET_SIZE] ;
+            Rng rngs[PACKET_SIZE] ;
+            int xs[PACKET_SIZE] ;
+            int x = x0 ;
+            while (x < x1) {
+                int nb = 0 ;
+                for ( ; x < x1 && nb < PACKET_SIZE ; ++x) {
+                    // Les pixels qui ont convergé ne reçoivent plus d'échantillons
+                    if (!accumulator.is_converged(x, y)) {
+                        xs[nb] = x ;
+                        nb++ ;
+                    }
+                }
+                if (nb == 0) {
+                    continue ;
+                }
+                {
+                    RT_STATS_PIXELS(xs, nb, y) ;
+                    // Le générateur du pixel sert dès le rayon primaire, qui part d'un point de la lentille
+                    for (int k = 0 ; k < nb ; k++) {
+                        uint32_t sample = static_cast<uint32_t>(accumulator.get_count(xs[k], y)) ;
+                        rngs[k] = Rng::for_pixel(static_cast<uint32_t>(xs[k] + y * largeur), sample) ;
+                    }
+                    get_camera_rays(xs, y, nb, rays, rngs) ;
+                    closest_hit_packet(rays, nb, hits) ;
+                }
+                for (int k = 0 ; k < nb ; k++) {
+                    RT_STATS_PIXELS(xs[k], y, 1) ;
+                    accumulator.add_sample(xs[k], y, shade(rays[k], hits[k], NB_REBONDS_MAX, &rngs[k])) ;
+                }
+            }
+        }
+    }) ;
+}
 
-            Material color = get_color(ray,5) ;
+void Scene::render_pixels(Framebuffer & image, int nb_threads) const {
+    ThreadPool pool(nb_threads) ;
+    render_pixels(image, pool) ;
+}
 
-            // -- Partie à utiliser si utilisation de l'éclairage indirect
-            // Material color(0.0f,0.0f,0.0f,0.0f) ;
-            // // #pragma omp parallel for
-            // for (int k = 0 ; k < nrays ; k++){
-            //     color += get_color(ray,5) ;
-            // }
-            // color /= static_cast<float>(nrays) ;
-            // --
+void Scene::render_pixels(Framebuffer & image, ThreadPool & pool, const std::function<bool()> & cancelled) const {
+    RT_TRACE("calcul des pixels") ;
+    int largeur = image.get_width() ;
+    int hauteur = image.get_height() ;
 
-            // On remplit le pixel de couleur
-            // On limite les composantes de couleur entre 0 et 255
-            // + correction Gamma
-            float r = std::min(255.0, std::max(0.0, std::pow(static_cast<double>(color.get_r()),1/2.2)));
-            float g = std::min(255.0, std::max(0.0, std::pow(static_cast<double>(color.get_g()),1/2.2)));
-            float b = std::min(255.0, std::max(0.0, std::pow(static_cast<double>(color.get_b()),1/2.2)));
-            SDL_SetRenderDrawColor(renderer,r,g,b, 255);
+    // On découpe l'image en tuiles, chaque tuile est une tâche du pool de threads
+    int nb_tuiles_x = (largeur + TAILLE_TUILE - 1) / TAILLE_TUILE ;
+    int nb_tuiles_y = (hauteur + TAILLE_TUILE - 1) / TAILLE_TUILE ;
 
-            // SDL_SetRenderDrawColor(renderer,color.get_r(),color.get_g(),color.get_b(), 255);
-            SDL_RenderDrawPoint(renderer, x, y);
+    // Chaque pixel ne dépend que de sa position : le résultat est identique quel que soit le nombre de threads
+    pool.parallel_for(nb_tuiles_x * nb_tuiles_y, [&](int tuile) {
+        if (cancelled && cancelled()) {
+            return ;
+        }
+        int x0 = (tuile % nb_tuiles_x) * TAILLE_TUILE ;
+        int y0 = (tuile / nb_tuiles_x) * TAILLE_TUILE ;
+        int x1 = std::min(x0 + TAILLE_TUILE, largeur) ;
+        int y1 = std::min(y0 + TAILLE_TUILE, hauteur) ;
+        RT_TRACE("tuile") ;
+        RT_STATS_TILE(x0, y0, x1, y1) ;
+        Material colors[PACKET_SIZE] ;
+        for (int y = y0 ; y < y1 ; ++y) {
+            // Les rayons primaires d'une ligne de la tuile sont tracés par paquets de PACKET_SIZE pixels
+            for (int x = x0 ; x < x1 ; x += PACKET_SIZE) {
+                int nb = std::min(PACKET_SIZE, x1 - x) ;
+                get_pixel_colors(x, y, nb, colors) ;
+                for (int k = 0 ; k < nb ; ++k) {
+                    image.set_pixel(x + k, y, colors[k]) ;
+                }
+            }
+        }
+    }) ;
+}
 
-            // Sert pour l'enregistrement de l'image
-            Uint32 pixelColor = SDL_MapRGB(surface->format, color.get_r(), color.get_g(), color.get_b());
-            int pixelIndex = x + y * largeur;
-            Uint32 *pixels = static_cast<Uint32 *>(surface->pixels);
-            pixels[pixelIndex] = pixelColor;
+void Scene::render_preview(Framebuffer & image, ThreadPool & pool, int width, int height, int pas,
+                           const std::function<bool()> & cancelled) const {
+    RT_TRACE("aperçu") ;
+    int largeur = (width + pas - 1) / pas ;
+    int hauteur = (height + pas - 1) / pas ;
+    image.resize(largeur, hauteur) ;
+
+    // Une tâche par ligne de l'aperçu : elles sont peu nombreuses et courtes
+    pool.parallel_for(hauteur, [&](int y) {
+        if (cancelled && cancelled()) {
+            return ;
+        }
+        int y_image = std::min(y * pas + pas / 2, height - 1) ;
+        for (int x = 0 ; x < largeur ; ++x) {
+            int x_image = std::min(x * pas + pas / 2, width - 1) ;
+            image.set_pixel(x, y, get_pixel_color(x_image, y_image)) ;
+        }
+    }) ;
+}
 
+bool Scene::render_to_file(const RenderSettings & settings) const {
+    RT_TRACE("rendu") ;
+    // L'image est calculée en mémoire, sans fenêtre
+    Framebuffer image(settings.width_, settings.height_) ;
+    if (settings.path_tracing_) {
+        // Rendu progressif : une passe par échantillon, la moyenne donne l'image
+        ThreadPool pool(settings.nb_threads_) ;
+        Accumulator accumulator(settings.width_, settings.height_) ;
+        Wavefront wavefront(*this) ;
+        for (int k = 0 ; k < settings.nb_samples_ ; k++) {
+            if (accumulate_pass(accumulator, pool, settings.threshold_, settings.wavefront_ ? &wavefront : nullptr) == 0) {
+                break ;
             }
         }
+        accumulator.resolve(image) ;
+        if (settings.threshold_ > 0.0f) {
+            std::cout << "Echantillons : " << accumulator.get_nb_samples() << " ("
+                      << static_cast<double>(accumulator.get_nb_samples()) / (settings.width_ * settings.height_)
+                      << " par pixel en moyenne, " << accumulator.get_nb_active() << " pixels non convergés)" << std::endl ;
+        }
+    }
+    else if (settings.wavefront_) {
+        ThreadPool pool(settings.nb_threads_) ;
+        Wavefront(*this).render(image, pool) ;
+    }
+    else {
+        render_pixels(image, settings.nb_threads_) ;
+    }
 
-    // Maj de l'affichage
-    SDL_RenderPresent(renderer);
+    // Correction gamma et enregistrement, comme pour l'affichage dans la fenêtre
+    return image.save(settings.output_) ;
+}
+
+#ifndef NO_SDL
+
+void Scene::render(const RenderSettings & settings){
+    int largeur = settings.width_ ;
+    int hauteur = settings.height_ ;
+
+    // On crée l'objet sdl
+    Sdl sdl(largeur, hauteur, settings.output_);
+
+    if (!sdl.isValid()) {
+        std::cerr << "Erreur lors de l'initialisation de SDL." << std::endl ;
+        return ;
+    }
 
-    // Enregistrement de l'image
-    SDL_SaveBMP(surface, filename.c_str());
-    
+    Framebuffer image(largeur, hauteur) ;
+    std::vector<unsigned char> rgb ;
     bool quit = false;
     SDL_Event event;
 
-    while (!quit) {
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) { // si la fenêtre est fermée
-                quit = true ; // fin de la boucle
+    if (settings.path_tracing_) {
+        // Rendu progressif : l'image affichée s'affine après chaque passe,
+        // et on peut fermer la fenêtre à tout moment
+        ThreadPool pool(settings.nb_threads_) ;
+        Accumulator accumulator(largeur, hauteur) ;
+        Wavefront wavefront(*this) ;
+        bool converged = false ;
+        for (int k = 0 ; k < settings.nb_samples_ && !quit && !converged ; k++) {
+            converged = (accumulate_pass(accumulator, pool, settings.threshold_, settings.wavefront_ ? &wavefront : nullptr) == 0) ;
+            accumulator.resolve(image) ;
+            image.to_rgb8(rgb) ;
+            sdl.display(rgb) ;
+            while (SDL_PollEvent(&event)) {
+                if (event.type == SDL_QUIT) {
+                    quit = true ;
+                }
             }
         }
     }
-} 
\ No newline at end of file
+    else {
+        // On calcule tous les pixels en parallèle, en couleurs linéaires flottantes
+        if (settings.wavefront_) {
+            ThreadPool pool(settings.nb_threads_) ;
+            Wavefront(*this).render(image, pool) ;
+        }
+        else {
+            render_pixels(image, settings.nb_threads_) ;
+        }
+
+        // Une seule passe de correction gamma pour toute l'image, puis un seul envoi à la carte graphique
+        image.to_rgb8(rgb) ;
+        sdl.display(rgb) ;
+    }
+
+    // Enregistrement de l'image, la même que celle affichée
+    save_image(settings.output_, largeur, hauteur, rgb) ;
+
+    // On attend les évènements sans boucler à vide : le thread dort tant que rien ne se passe
+    while (!quit && SDL_WaitEvent(&event)) {
+        if (event.type == SDL_QUIT) { // si la fenêtre est fermée
+            quit = true ; // fin de la boucle
+        }
+    }
+}
+
+#endif
@@ -6,11 +6,31 @@
 #include "Sphere.h"
 #include "Quad.h"
 #include "Material.h"
+#include "Light.h"
+#include "LightSampler.h"
+#include "Bvh.h"
+#include "CompiledScene.h"
+#include "Framebuffer.h"
+#include "Accumulator.h"
+#include "RenderSettings.h"
+#include "Rng.h"
+#include "ThreadPool.h"
+#include <algorithm>
 #include <cmath>
+#include <functional>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
+class Wavefront ;
+class MappedFile ;
+
+// Nombre maximum de rebonds d'un chemin. Seule une suite de miroirs sans générateur aléatoire (éclairage direct)
+// peut l'atteindre : en rendu progressif, la roulette russe arrête les chemins bien avant
+const int NB_REBONDS_MAX = 64 ;
+
 /**
  * @brief La classe qui crée la scène qui sera ensuite affichée dans une fenêtre
  * 
@@ -32,13 +52,83 @@ class Scene {
         */
         std::vector<Shape*> shapes_ ;
         /**
-         * @brief La source de lumière qui éclaire la scène 
-         * @see Ray3f
+         * @brief Les formes de shapes_, qui appartiennent à la scène
+         * 
+         * Les copies d'une scène partagent ses formes, comme elles partagent file_ : elles sont détruites
+         * avec la dernière copie.
+        */
+        std::shared_ptr<const std::vector<std::unique_ptr<Shape>>> owned_shapes_ ;
+        /**
+         * @brief Les lumières qui éclairent la scène
+         * @see Light
+        */
+        std::vector<Light> lights_ ;
+        /**
+         * @brief La table de tirage des lumières selon leur puissance, reconstruite avec lights_
+         * @see LightSampler
+        */
+        LightSampler light_sampler_ ;
+        /**
+         * @brief Le nombre de rayons d'ombre tracés par point éclairé
+         *
+         * Ils sont répartis entre les lumières et sur la surface des lumières étendues. Une scène éclairée par une
+         * seule lumière ponctuelle n'en trace qu'un, ils seraient tous identiques.
+        */
+        int nb_shadow_rays_ ;
+        /**
+         * @brief Le nombre de threads de la construction de bvh_ (et des hiérarchies des formes), 0 pour tous les coeurs
+        */
+        int nb_threads_ ;
+        /**
+         * @brief La hiérarchie de volumes englobants construite sur shapes_
+         * 
+         * Elle est reconstruite à chaque modification de shapes_, et donc une seule fois avant le rendu
+         * @see Bvh
+        */
+        Bvh bvh_ ;
+        /**
+         * @brief Les formes de shapes_ rangées par type en tableaux contigus, dans l'ordre des feuilles de bvh_
+         * 
+         * Elles sont reconstruites avec bvh_, et servent aux tests d'intersection pendant le rendu
+         * @see CompiledScene
+        */
+        CompiledScene compiled_ ;
+        /**
+         * @brief Le cache de scène projeté en mémoire, quand bvh_ et compiled_ en ont été relus (nullptr sinon)
+         *
+         * Les tableaux de bvh_ et de compiled_ désignent alors ses octets : il est partagé entre les copies de la scène
+         * et n'est fermé qu'avec la dernière.
+         * @see SceneCache
+        */
+        std::shared_ptr<const MappedFile> file_ ;
+
+        /**
+         * @brief Construit la hiérarchie de volumes englobants bvh_ à partir des boîtes englobantes de shapes_,
+         * puis range les formes par type dans compiled_
+         *
+         * Les plans, qui n'ont pas de boîte, sont déplacés à la fin de shapes_ et restent hors de bvh_.
+        */
+        void build_bvh() ;
+
+        /**
+         * @brief Ajoute un échantillon à chaque pixel de l'accumulateur qui n'a pas convergé, tuile par tuile
+         *
+         * C'est l'intégrateur récursif de accumulate_pass : chaque pixel est tracé de bout en bout par get_color.
+         *
+         * @param accumulator : référence vers l'accumulateur
+         * @param pool : référence vers le pool de threads
+         * @param cancelled : référence vers le test d'abandon, vide pour aller jusqu'au bout
         */
-        Ray3f source_ ;
+        void trace_pass(Accumulator & accumulator, ThreadPool & pool, const std::function<bool()> & cancelled) const ;
 
     public :
         
+        /**
+         * @brief Constructeur par défaut
+         * 
+         * Crée une scène vide, avec la caméra par défaut et sans lumière
+        */
+        Scene() ;
         /**
          * @brief Constructeur paramétré
          * 
@@ -46,10 +136,11 @@ class Scene {
          * 
          * @param camera : la caméra de la scène
          * @param shapes : l'ensemble des shapes dans la scène
-         * @param source : la source de lumière de la scène
-         * @see Camera, Shape, Ray3f
+         * @param lights : les lumières de la scène
+         * @param nb_threads : le nombre de threads de la construction de la hiérarchie, 0 pour tous les coeurs
+         * @see Camera, Shape, Light
         */
-        Scene(Camera camera, std::vector<Shape*> shapes, Ray3f source) ;
+        Scene(Camera camera, std::vector<Shape*> shapes, std::vector<Light> lights, int nb_threads) ;
         /**
          * @brief Constructeur de copie
          * 
@@ -72,11 +163,18 @@ class Scene {
         */
         std::vector<Shape*> get_shapes() const { return shapes_; }
         /**
-         * @brief Getter de l'attribut source_
+         * @brief Getter de l'attribut lights_
          * 
-         * @return L'attribut source_ de la classe
+         * @return Référence vers l'attribut lights_ de la classe
         */
-        Ray3f get_source() const { return source_; }
+        const std::vector<Light> & get_lights() const { return lights_; }
+
+        /**
+         * @brief Getter de l'attribut bvh_
+         * 
+         * @return Référence vers l'attribut bvh_ de la classe
+        */
+        const Bvh & get_bvh() const { return bvh_; }
 
         /**
          * @brief Setter de l'attribut camera_
@@ -87,15 +185,58 @@ class Scene {
         /**
          * @brief Setter de l'attribut shapes_
          * 
+         * La scène devient propriétaire des formes, allouées par new : elle les détruit quand plus aucune
+         * de ses copies ne s'en sert. Les formes qu'elle avait avant sont libérées de la même façon.
+         * 
          * @param shapes : l'ensemble des shape que l'on veut donner à la scène
         */
-        void set_shapes(std::vector<Shape*> shapes) { shapes_ = shapes; }
+        void set_shapes(std::vector<Shape*> shapes) ;
         /**
-         * @brief Setter de l'attribut source_
+         * @brief Setter de l'attribut lights_, qui reconstruit light_sampler_
          * 
-         * @param source : la source de lumière que l'on veut donner à la scène
+         * @param lights : les lumières que l'on veut donner à la scène
         */
-        void set_source(Ray3f source) { source_ = source; }
+        void set_lights(std::vector<Light> lights) { lights_ = std::move(lights); light_sampler_.build(lights_); }
+        /**
+         * @brief Setter de l'attribut nb_shadow_rays_
+         * 
+         * @param nb_shadow_rays : le nombre de rayons d'ombre par point éclairé, au moins 1
+        */
+        void set_shadow_rays(int nb_shadow_rays) { nb_shadow_rays_ = std::max(1, nb_shadow_rays); }
+        /**
+         * @brief Setter de l'attribut nb_threads_, à appeler avant set_shapes
+         * 
+         * @param nb_threads : le nombre de threads de la construction des hiérarchies, 0 pour tous les coeurs
+        */
+        void set_nb_threads(int nb_threads) { nb_threads_ = nb_threads; }
+        /**
+         * @brief Getter de l'attribut nb_threads_
+         * 
+         * @return L'attribut nb_threads_ de la classe
+        */
+        int get_nb_threads() const { return nb_threads_; }
+        /**
+         * @brief Donne le nombre de rayons d'ombre réellement tracés par point éclairé
+         * 
+         * @return nb_shadow_rays_, ou 1 si la scène n'a qu'une lumière ponctuelle (ou aucune)
+        */
+        int get_shadow_rays() const {
+            return (lights_.size() > 1 || (lights_.size() == 1 && lights_[0].is_area())) ? nb_shadow_rays_ : 1;
+        }
+        /**
+         * @brief Remplace la scène par une scène déjà compilée
+         *
+         * Sert à rendre une scène relue d'un cache : shapes_ est vidé, et bvh_ et compiled_ ne sont pas reconstruits.
+         *
+         * @param bvh : la hiérarchie de volumes englobants
+         * @param compiled : les formes rangées par type, dans l'ordre des feuilles de bvh
+         * @param owned : les formes testées par un appel virtuel (maillages, instances) désignées par compiled,
+         * dont la scène devient propriétaire
+         * @param file : le fichier dont bvh, compiled et les formes désignent les octets, gardé ouvert par la scène
+         * @see SceneCache
+        */
+        void set_compiled(Bvh bvh, CompiledScene compiled, std::vector<std::unique_ptr<Shape>> owned,
+                          std::shared_ptr<const MappedFile> file) ;
 
         /**
          * @brief L'opérateur = de la classe
@@ -111,6 +252,7 @@ class Scene {
          * 
          * Elle est utilisée dans scene.render et instancie les valeurs des paramètres P, N et t si il y a intersection. 
          * Sinon, garde les valeurs en entrée.
+         * Seules les formes dont la boîte englobante est traversée par le rayon sont testées, grâce à bvh_.
          * 
          * @param d : référence vers le rayon dont on veut savoir s'il y a intersection
          * @param P : pointeur vers le point avec lequel il y a une intersection, si elle existe
@@ -124,31 +266,324 @@ class Scene {
         bool intersection (const Ray3f & d, Vector3f * P, Vector3f * N, int * sphere_id, float * t) const ;
 
         /**
-         * @brief 
+         * @brief Fonction qui trouve l'intersection la plus proche d'un rayon, sans calculer le point ni la normale
          * 
-         * Cette fonction retourne un Material pour le rayon donné. La fonction prend en entrée un rayon donné et un nombre de rebonds de ce rayon.
-         * La fonction vérifie s'il y a une intersection, et si oui prend la plus proche, en faisant un appel à la fonction
-         * Scene::intersection. Ensuite, s'il y a intersection, elle regarde si l'objet intersecté est un miroir, si oui,
-         * elle fait un appel récursif. Sinon, elle applique l'éclairage direct (+ éclairage indirect mais ce dernier commenté)
-         * afin d'obtenir les composantes de couleur du Material.
+         * Le parcours ne garde que t et l'identifiant de la forme. Pour obtenir P et N, il suffit d'appeler
+         * hit_point sur le résultat, ce que fait Scene::intersection.
          * 
-         * @param ray : référence
-         * @param nb_rebonds : 
+         * @param d : référence vers le rayon
          * @see Ray3f
          * 
-         * @return 
+         * @return Le HitRecord de l'intersection la plus proche, dont hit() est false s'il n'y en a pas
+         * @see HitRecord
+        */
+        HitRecord closest_hit (const Ray3f & d) const ;
+
+        /**
+         * @brief Fonction qui permet de savoir si un objet se trouve sur le rayon avant la distance t_max
+         * 
+         * Contrairement à Scene::intersection, elle s'arrête au premier objet trouvé, quel qu'il soit,
+         * et ne calcule ni le point d'intersection ni la normale. Elle sert aux rayons d'ombre, pour
+         * lesquels on veut seulement savoir si la lumière est cachée.
+         * 
+         * @param ray : référence vers le rayon
+         * @param t_max : la distance au-delà de laquelle les objets ne comptent pas (ex : distance à la lumière)
+         * @see Ray3f
+         * 
+         * @return true s'il y a un objet sur le rayon avant t_max, false sinon
+        */
+        bool occluded (const Ray3f & ray, float t_max) const ;
+
+        /**
+         * @brief Calcule la couleur que renvoie un rayon vers la caméra
+         * 
+         * Cette fonction retourne un Material pour le rayon donné. Elle cherche l'intersection la plus proche avec
+         * Scene::closest_hit, puis suit le chemin du rayon avec Scene::shade.
+         * 
+         * @param ray : référence vers le rayon
+         * @param nb_rebonds : le nombre maximum d'intersections éclairées le long du chemin, 0 pour n'en éclairer aucune
+         * @param rng : pointeur vers le générateur aléatoire du pixel, nullptr pour l'éclairage direct seul
+         * @see Ray3f, Rng
+         * 
+         * @return La couleur du rayon, avant correction gamma
          * @see Material
         */
-        Material get_color(const Ray3f & ray, int nb_rebonds) const ;
+        Material get_color(const Ray3f & ray, int nb_rebonds, Rng * rng = nullptr) const ;
+
+        /**
+         * @brief Calcule la couleur d'un rayon dont l'intersection la plus proche est déjà connue
+         * 
+         * C'est la suite de get_color une fois l'intersection trouvée. Le chemin est suivi dans une boucle, de rebond
+         * en rebond (miroir, éclairage indirect), en gardant le poids du chemin (la fraction de lumière renvoyée
+         * jusqu'au pixel) et la lumière déjà accumulée. Chaque point touché ajoute son éclairage direct, pondéré par
+         * le poids. Avec un générateur, la roulette russe arrête le chemin.
+         * 
+         * @param ray : référence vers le rayon
+         * @param hit : référence vers l'intersection la plus proche du rayon, trouvée par closest_hit ou closest_hit_packet
+         * @param nb_rebonds : le nombre maximum d'intersections éclairées, au moins 1
+         * @param rng : pointeur vers le générateur aléatoire du pixel, nullptr pour l'éclairage direct seul
+         * @see get_color
+         * 
+         * @return La couleur du rayon, avant correction gamma
+        */
+        Material shade(const Ray3f & ray, const HitRecord & hit, int nb_rebonds, Rng * rng) const ;
 
+        /**
+         * @brief Roulette russe : décide si un chemin continue après un rebond
+         *
+         * Les premiers rebonds sont toujours suivis. Ensuite, le chemin continue avec une probabilité q qui
+         * suit son poids, et le poids est divisé par q pour que la moyenne des échantillons ne change pas.
+         *
+         * @param rebond : le numéro du rebond qui vient d'être calculé, à partir de 0
+         * @param poids : pointeur vers le poids du chemin, mis à jour s'il continue
+         * @param rng : référence vers le générateur aléatoire du pixel
+         *
+         * @return true si le chemin continue, false sinon
+        */
+        static bool russian_roulette(int rebond, Vector3f * poids, Rng & rng) ;
+
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par closest_hit
+         *
+         * @param ray : référence vers le rayon
+         * @param hit : référence vers l'intersection, dont hit() est true
+         * @param P : pointeur vers le point d'intersection
+         * @param N : pointeur vers la normale au point P
+         * @see CompiledScene::finalize_hit
+        */
+        void hit_point(const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const ;
+
+        /**
+         * @brief Donne le rayon réfléchi par un miroir
+         *
+         * @param ray : référence vers le rayon incident
+         * @param P : référence vers le point d'intersection avec le miroir
+         * @param N : référence vers la normale au point P
+         *
+         * @return Le rayon réfléchi, qui part juste au-dessus de P
+        */
+        Ray3f reflected_ray(const Ray3f & ray, const Vector3f & P, const Vector3f & N) const ;
+
+        /**
+         * @brief Tire le décalage des échantillons de lumière d'un point éclairé
+         *
+         * Les get_shadow_rays() échantillons du point suivent la suite à faible discrépance R3, décalée de ce vecteur
+         * (rotation de Cranley-Patterson) : ils sont bien répartis entre les lumières et sur leur surface, et deux
+         * points voisins n'ont pas les mêmes échantillons.
+         *
+         * Sans générateur aléatoire (éclairage direct seul), le décalage ne dépend que de P, pour que l'image ne
+         * dépende pas de l'ordre du rendu. Avec une seule lumière ponctuelle, il est nul et aucun nombre n'est tiré.
+         *
+         * @param P : référence vers le point éclairé
+         * @param rng : pointeur vers le générateur aléatoire du pixel, nullptr sans éclairage indirect
+         *
+         * @return Le décalage, dont chaque coordonnée est dans [0, 1[
+        */
+        Vector3f light_offset(const Vector3f & P, Rng * rng) const ;
+
+        /**
+         * @brief Calcule l'éclairage direct apporté en un point par un de ses échantillons de lumière, s'il n'est pas caché
+         *
+         * L'échantillon tire une lumière avec light_sampler_, quel que soit leur nombre, puis un point de cette
+         * lumière. Sa contribution est divisée par la probabilité de la lumière et par le nombre d'échantillons :
+         * la somme des échantillons du point est, en moyenne, l'éclairage de toutes les lumières. Le rayon d'ombre
+         * n'est pas tracé : il est donné en sortie, pour que l'appelant le teste avec occluded.
+         *
+         * @param P : référence vers le point éclairé
+         * @param N : référence vers la normale au point P
+         * @param shape_id : l'identifiant de la forme à laquelle appartient P
+         * @param decalage : référence vers le décalage des échantillons du point, donné par light_offset
+         * @param k : le numéro de l'échantillon, de 0 à get_shadow_rays() - 1
+         * @param ray_light : pointeur vers le rayon d'ombre, de P vers la lumière
+         * @param d_light : pointeur vers la distance de P à la lumière
+         *
+         * @return La couleur reçue en P (modèle lambertien), avant correction gamma, noire si la scène n'a pas de lumière
+        */
+        Material direct_light(const Vector3f & P, const Vector3f & N, int shape_id, const Vector3f & decalage, int k,
+                              Ray3f * ray_light, float * d_light) const ;
+
+        /**
+         * @brief Tire la direction d'un rebond diffus, selon une loi en cosinus autour de la normale
+         *
+         * @param P : référence vers le point de rebond
+         * @param N : référence vers la normale au point P, non nulle
+         * @param rng : référence vers le générateur aléatoire du pixel
+         *
+         * @return Le rayon du rebond, qui part juste au-dessus de P
+        */
+        Ray3f diffuse_ray(const Vector3f & P, const Vector3f & N, Rng & rng) const ;
+
+        /**
+         * @brief Getter de l'attribut compiled_
+         *
+         * @return Référence vers l'attribut compiled_ de la classe
+        */
+        const CompiledScene & get_compiled() const { return compiled_; }
+
+        /**
+         * @brief Cherche ensemble l'intersection la plus proche de plusieurs rayons cohérents
+         * 
+         * Les rayons sont tracés en un paquet, une voie SIMD par rayon : le Bvh est parcouru une fois pour
+         * tous, et chaque sphère ou quad est testé sur tous les rayons à la fois. Le résultat de chaque rayon
+         * est exactement celui de closest_hit.
+         * 
+         * @param rays : les rayons, typiquement les rayons primaires de pixels voisins
+         * @param nb_rays : le nombre de rayons, au plus PACKET_SIZE
+         * @param hits : les intersections les plus proches, une par rayon
+         * @see closest_hit, RayPacket
+        */
+        void closest_hit_packet(const Ray3f * rays, int nb_rays, HitRecord * hits) const ;
+
+        /**
+         * @brief Construit le rayon qui part de la caméra et passe par le pixel (x, y)
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * @param rng : pointeur vers le générateur du pixel, qui tire le point de départ sur la lentille de la
+         * caméra ; sans générateur (nullptr), ou sans ouverture, le rayon part du centre de la caméra
+         * 
+         * @return Le rayon primaire du pixel, de direction unitaire
+        */
+        Ray3f get_camera_ray(int x, int y, Rng * rng = nullptr) const ;
+        /**
+         * @brief Construit les rayons primaires de pixels d'une même ligne, une voie SIMD par pixel
+         * 
+         * Les rayons sont exactement ceux de get_camera_ray. Avec une lentille, chaque rayon est tiré seul.
+         * 
+         * @param xs : les colonnes des pixels
+         * @param y : la ligne des pixels
+         * @param nb_rays : le nombre de pixels, au plus PACKET_SIZE
+         * @param rays : les rayons construits, un par pixel
+         * @param rngs : les générateurs des pixels, un par pixel, ou nullptr
+         * @see get_camera_ray
+        */
+        void get_camera_rays(const int * xs, int y, int nb_rays, Ray3f * rays, Rng * rngs) const ;
+
+        /**
+         * @brief Calcule la couleur du pixel (x, y) en lançant le rayon qui part de la caméra
+         * 
+         * Sans éclairage indirect, rien n'est aléatoire : un seul rayon suffit, d'autres donneraient la même couleur.
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * 
+         * @return La couleur du pixel, avant correction gamma
+         * @see Material
+        */
+        Material get_pixel_color(int x, int y) const ;
+
+        /**
+         * @brief Calcule un échantillon aléatoire du pixel (x, y), éclairage indirect compris
+         * 
+         * @param x : la colonne du pixel
+         * @param y : la ligne du pixel
+         * @param rng : référence vers le générateur aléatoire du pixel
+         * 
+         * @return La couleur de l'échantillon, avant correction gamma
+        */
+        Material get_pixel_sample(int x, int y, Rng & rng) const ;
+
+        /**
+         * @brief Calcule la couleur de pixels voisins d'une même ligne, en traçant leurs rayons primaires en un paquet
+         * 
+         * Donne exactement les mêmes couleurs que get_pixel_color sur chaque pixel.
+         * 
+         * @param x : la colonne du premier pixel
+         * @param y : la ligne des pixels
+         * @param nb_pixels : le nombre de pixels, au plus PACKET_SIZE
+         * @param colors : les couleurs des pixels, avant correction gamma
+         * @see closest_hit_packet
+        */
+        void get_pixel_colors(int x, int y, int nb_pixels, Material * colors) const ;
+
+        /**
+         * @brief Ajoute un échantillon à chaque pixel de l'accumulateur qui n'a pas convergé : c'est une passe du rendu progressif
+         * 
+         * Les tuiles sont réparties sur le pool de threads. Le générateur de chaque pixel ne dépend que du pixel
+         * et de son nombre d'échantillons, le résultat ne dépend donc pas du nombre de threads.
+         * Avec un seuil, les tuiles dont l'erreur est passée dessous sont ensuite retirées.
+         * Dès que cancelled répond true, les tuiles (ou les vagues) restantes ne sont plus tracées : l'accumulateur,
+         * incomplet, est à remettre à zéro.
+         * 
+         * @param accumulator : référence vers l'accumulateur, sa taille donne celle du rendu
+         * @param pool : référence vers le pool de threads, gardé d'une passe à l'autre
+         * @param threshold : l'erreur (en niveaux de 0 à 255) sous laquelle une tuile a convergé, 0 pour échantillonner tous les pixels
+         * @param wavefront : pointeur vers l'intégrateur par vagues qui trace les échantillons, nullptr pour les tracer pixel par pixel
+         * @param cancelled : référence vers le test d'abandon, appelé par chaque tuile, vide pour aller jusqu'au bout
+         * @see Accumulator, ThreadPool, Wavefront
+         * 
+         * @return Le nombre de pixels qui n'ont pas encore convergé
+        */
+        int accumulate_pass(Accumulator & accumulator, ThreadPool & pool, float threshold = 0.0f, Wavefront * wavefront = nullptr,
+                            const std::function<bool()> & cancelled = std::function<bool()>()) const ;
+
+        /**
+         * @brief Calcule la couleur de tous les pixels de l'image, en parallèle
+         * 
+         * L'image est découpée en tuiles carrées qui sont réparties sur un pool de threads avec vol de tâches.
+         * Le résultat est identique pixel par pixel au calcul sur un seul thread.
+         * 
+         * @param image : référence vers l'image qui reçoit la couleur linéaire de chaque pixel, sa taille donne celle du rendu
+         * @param nb_threads : le nombre de threads voulu, 0 pour prendre le nombre de coeurs de la machine
+         * @see ThreadPool, Framebuffer
+        */
+        void render_pixels(Framebuffer & image, int nb_threads = 0) const ;
+        /**
+         * @brief Calcule la couleur de tous les pixels de l'image sur un pool de threads existant
+         * 
+         * Dès que cancelled répond true, les tuiles restantes ne sont plus calculées et l'image reste incomplète.
+         * 
+         * @param image : référence vers l'image qui reçoit la couleur linéaire de chaque pixel, sa taille donne celle du rendu
+         * @param pool : référence vers le pool de threads, gardé d'une image à l'autre
+         * @param cancelled : référence vers le test d'abandon, appelé par chaque tuile, vide pour aller jusqu'au bout
+         * @see render_pixels
+        */
+        void render_pixels(Framebuffer & image, ThreadPool & pool, const std::function<bool()> & cancelled = std::function<bool()>()) const ;
+
+        /**
+         * @brief Calcule un aperçu de l'image en basse résolution, avec l'éclairage direct seul
+         * 
+         * Chaque pixel de l'aperçu couvre un carré de pas x pas pixels de l'image, dont on ne calcule que le centre.
+         * 
+         * @param image : référence vers l'aperçu, redimensionné à la taille de l'image divisée par pas
+         * @param pool : référence vers le pool de threads
+         * @param width : la largeur de l'image complète
+         * @param height : la hauteur de l'image complète
+         * @param pas : le côté en pixels de l'image du carré couvert par un pixel de l'aperçu
+         * @param cancelled : référence vers le test d'abandon, appelé par chaque ligne, vide pour aller jusqu'au bout
+         * @see get_pixel_color
+        */
+        void render_preview(Framebuffer & image, ThreadPool & pool, int width, int height, int pas,
+                            const std::function<bool()> & cancelled = std::function<bool()>()) const ;
+
+        /**
+         * @brief Calcule l'image de la scène sans ouvrir de fenêtre et l'enregistre dans un fichier
+         * 
+         * C'est le mode hors-ligne, qui ne dépend pas de la SDL. L'image enregistrée est celle qui serait
+         * affichée dans la fenêtre, correction gamma comprise.
+         * 
+         * En rendu progressif, les nb_samples_ passes sont toutes calculées avant l'enregistrement,
+         * sauf si tous les pixels ont convergé avant.
+         * 
+         * @param settings : référence vers les paramètres du rendu (taille, threads, échantillons, mode, fichier)
+         * @see save_image, RenderSettings
+         * 
+         * @return true si l'image a été enregistrée, false sinon
+        */
+        bool render_to_file(const RenderSettings & settings) const ;
+
+#ifndef NO_SDL
         /**
          * @brief Crée la fenêtre qui s'ouvre pour afficher la scène et enregistre aussi la scène au format BNG.
          * 
-         * @param width : la largeur voulue de la fenêtre
-         * @param height : la hauteur voulue de la fenêtre
-         * @param filename : référence vers le nom du fichier de la fenêtre
+         * N'existe que si la SDL est disponible (compilation sans -DNO_SDL). En rendu progressif, la fenêtre
+         * est mise à jour après chaque passe.
+         * 
+         * @param settings : référence vers les paramètres du rendu (taille, threads, échantillons, mode, fichier)
+         * @see RenderSettings
         */
-        void render(int width, int height, const std::string & filename);
+        void render(const RenderSettings & settings);
+#endif
 };
 
 /**
@@ -156,7 +591,7 @@ class Scene {
  * 
  * Affiche les informations de la scène donnée sous le format suivant : 
  * Camera : camera_
- * Source : source_
+ * Lights : lights_
  * Shapes : 
  * 
  * @param st : le flux sur lequel on veut afficher la scène
@@ -0,0 +1,434 @@
+#include "SceneCache.h"
+#include "Trace.h"
+#include "MappedFile.h"
+#include "Camera.h"
+#include "Ray3f.h"
+#include "Light.h"
+#include "TriangleMesh.h"
+#include "Instance.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Le début du fichier, pour reconnaître un cache de scène
+const char MAGIC_CACHE[8] = { 'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0' } ;
+// À changer à chaque modification du format ou de l'ordre des tableaux de SceneCache::for_each_array
+const uint32_t VERSION_CACHE = 6 ;
+// Relu tel quel sur une machine de même boutisme seulement
+const uint32_t BOUTISME_CACHE = 0x01020304 ;
+// Le nombre de tableaux enregistrés par SceneCache::for_each_array
+const int NB_SECTIONS = 42 ;
+// Alignement du début de chaque tableau dans le fichier, une ligne de cache
+const uint64_t ALIGNEMENT_CACHE = 64 ;
+
+// Les tableaux sont lus en place : ils ne doivent contenir que des octets
+static_assert(std::is_trivially_copyable<BvhNode>::value, "BvhNode doit pouvoir être copié octet par octet") ;
+static_assert(std::is_trivially_copyable<Light>::value, "Light doit pouvoir être copié octet par octet") ;
+static_assert(std::is_trivially_copyable<Camera>::value, "Camera doit pouvoir être copiée octet par octet") ;
+static_assert(std::is_trivially_copyable<Transform>::value, "Transform doit pouvoir être copiée octet par octet") ;
+
+/**
+ * @brief L'en-tête du fichier
+*/
+struct EnTeteCache {
+    char magic_[8] ;
+    uint32_t version_ ;
+    uint32_t boutisme_ ;
+    // Le côté de l'image pour lequel la scène a été construite
+    int32_t size_ ;
+    int32_t nb_sections_ ;
+    // La caméra, copiée octet par octet avec ses axes et ses pas par pixel déjà calculés
+    unsigned char camera_[sizeof(Camera)] ;
+} ;
+
+/**
+ * @brief La place d'un tableau dans le fichier, l'en-tête étant suivi d'une SectionCache par tableau
+*/
+struct SectionCache {
+    uint64_t offset_ ;
+    uint64_t count_ ;
+    uint32_t element_size_ ;
+    uint32_t reserve_ ;
+} ;
+
+// Ajoute les éléments d'un tableau à la fin d'un vecteur
+template <typename T>
+static void append(std::vector<T> & v, const MappedArray<T> & a) {
+    v.insert(v.end(), a.data(), a.data() + a.size()) ;
+}
+
+// Vérifie une hiérarchie relue, de nb_nodes noeuds sur n primitives : enfants et primitives des noeuds, indices,
+// et profondeur bornée par la pile des parcours
+static bool check_bvh(const BvhNode * nodes, int64_t nb_nodes, const int * indices, int64_t n) {
+    if ((nb_nodes == 0) != (n == 0)) {
+        return false ;
+    }
+    // Les noeuds sont rangés en profondeur d'abord : l'enfant gauche suit son parent, l'enfant droit vient après.
+    // Chaque noeud est donc vu après son parent, qui lui a déjà donné sa profondeur ; un noeud sans parent ou
+    // avec deux parents n'est pas un arbre
+    std::vector<int> profondeur(nb_nodes, -1) ;
+    if (nb_nodes > 0) {
+        profondeur[0] = 0 ;
+    }
+    for (int64_t id = 0 ; id < nb_nodes ; id++) {
+        const BvhNode & node = nodes[id] ;
+        if (profondeur[id] < 0) {
+            return false ;
+        }
+        if (node.count_ > 0) {
+            if (node.first_ < 0 || node.first_ + static_cast<int64_t>(node.count_) > n) {
+                return false ;
+            }
+            continue ;
+        }
+        int64_t left = id + 1 ;
+        int64_t right = node.first_ ;
+        // Bvh::traverse empile au plus un noeud par niveau, dans une pile de TAILLE_PILE_BVH places
+        if (node.count_ < 0 || right <= left || right >= nb_nodes || profondeur[id] + 1 >= TAILLE_PILE_BVH
+            || profondeur[left] >= 0 || profondeur[right] >= 0) {
+            return false ;
+        }
+        profondeur[left] = profondeur[id] + 1 ;
+        profondeur[right] = profondeur[id] + 1 ;
+    }
+    for (int64_t i = 0 ; i < n ; i++) {
+        if (indices[i] < 0 || indices[i] >= n) {
+            return false ;
+        }
+    }
+    return true ;
+}
+
+bool SceneCache::check(const MappedArray<BvhNode> & nodes, const MappedArray<int> & indices, const CompiledScene & compiled,
+                       const Geometries & geometries) {
+    RT_TRACE("vérification du cache") ;
+    int64_t n = static_cast<int64_t>(indices.size()) ;
+    if (!check_bvh(nodes.data(), static_cast<int64_t>(nodes.size()), indices.data(), n)) {
+        return false ;
+    }
+
+    // Chaque place de l'ordre des feuilles contient exactement une sphère, un quad ou une autre forme
+    if (compiled.sphere_start_[0] != 0 || compiled.quad_start_[0] != 0 || compiled.other_start_[0] != 0) {
+        return false ;
+    }
+    for (int64_t k = 0 ; k < n ; k++) {
+        int spheres = compiled.sphere_start_[k + 1] - compiled.sphere_start_[k] ;
+        int quads = compiled.quad_start_[k + 1] - compiled.quad_start_[k] ;
+        int others = compiled.other_start_[k + 1] - compiled.other_start_[k] ;
+        if (spheres < 0 || quads < 0 || others < 0 || spheres + quads + others != 1) {
+            return false ;
+        }
+    }
+
+    int64_t nb_shapes = static_cast<int64_t>(compiled.material_ids_.size()) ;
+    int64_t nb_materials = static_cast<int64_t>(compiled.miroirs_.size()) ;
+    for (const MappedArray<int> * shapes : { &compiled.sphere_shape_, &compiled.quad_shape_, &compiled.plane_shape_,
+                                             &compiled.other_shape_ }) {
+        for (size_t i = 0 ; i < shapes->size() ; i++) {
+            if ((*shapes)[i] < 0 || (*shapes)[i] >= nb_shapes) {
+                return false ;
+            }
+        }
+    }
+    for (int64_t s = 0 ; s < nb_shapes ; s++) {
+        int64_t slot = compiled.shape_slot_[s] ;
+        size_t nb_slots = 0 ;
+        switch (compiled.shape_type_[s]) {
+            case CompiledScene::TYPE_SPHERE : nb_slots = compiled.sphere_shape_.size() ; break ;
+            case CompiledScene::TYPE_QUAD : nb_slots = compiled.quad_shape_.size() ; break ;
+            case CompiledScene::TYPE_PLANE : nb_slots = compiled.plane_shape_.size() ; break ;
+            case CompiledScene::TYPE_OTHER : nb_slots = compiled.other_shape_.size() ; break ;
+            default : return false ;
+        }
+        if (slot < 0 || slot >= static_cast<int64_t>(nb_slots)
+            || compiled.material_ids_[s] < 0 || compiled.material_ids_[s] >= nb_materials) {
+            return false ;
+        }
+    }
+
+    // Chaque maillage : ses tableaux se suivent, ses triangles désignent ses sommets et ses normales, et sa
+    // hiérarchie ses triangles
+    const Geometries & g = geometries ;
+    int64_t nb_meshes = static_cast<int64_t>(g.nodes_start_.size()) - 1 ;
+    if (g.positions_start_[0] != 0 || g.normals_start_[0] != 0 || g.triangles_start_[0] != 0 || g.nodes_start_[0] != 0) {
+        return false ;
+    }
+    for (int64_t m = 0 ; m < nb_meshes ; m++) {
+        int64_t p0 = g.positions_start_[m], p1 = g.positions_start_[m + 1] ;
+        int64_t n0 = g.normals_start_[m], n1 = g.normals_start_[m + 1] ;
+        int64_t t0 = g.triangles_start_[m], t1 = g.triangles_start_[m + 1] ;
+        int64_t b0 = g.nodes_start_[m], b1 = g.nodes_start_[m + 1] ;
+        if (p1 < p0 || n1 < n0 || t1 < t0 || b1 < b0 || (p1 - p0) % 3 != 0 || (n1 - n0) % 3 != 0 || t0 % 3 != 0 || t1 % 3 != 0) {
+            return false ;
+        }
+        int64_t nb_vertices = (p1 - p0) / 3 ;
+        int64_t nb_normals = (n1 - n0) / 3 ;
+        for (int64_t i = t0 ; i < t1 ; i++) {
+            if (g.triangles_[i] < 0 || g.triangles_[i] >= nb_vertices || g.normal_ids_[i] < -1 || g.normal_ids_[i] >= nb_normals) {
+                return false ;
+            }
+        }
+        if (!check_bvh(g.nodes_.data() + b0, b1 - b0, g.indices_.data() + t0 / 3, (t1 - t0) / 3)) {
+            return false ;
+        }
+    }
+    for (size_t i = 0 ; i < g.other_mesh_.size() ; i++) {
+        if (g.other_mesh_[i] < 0 || g.other_mesh_[i] >= nb_meshes || g.other_instance_[i] > 1) {
+            return false ;
+        }
+    }
+    return true ;
+}
+
+bool SceneCache::collect(const CompiledScene & compiled, Geometries * geometries) {
+    std::vector<float> positions, normals ;
+    std::vector<int> triangles, normal_ids, indices ;
+    std::vector<BvhNode> nodes ;
+    std::vector<int> positions_start(1, 0), normals_start(1, 0), triangles_start(1, 0), nodes_start(1, 0) ;
+    std::vector<int> other_mesh ;
+    std::vector<unsigned char> other_instance ;
+    std::vector<Transform> other_transform ;
+    // Le numéro de chaque maillage déjà rangé : un maillage partagé par plusieurs instances n'est rangé qu'une fois
+    std::map<const TriangleMesh*, int> numeros ;
+    for (const Shape * shape : compiled.other_) {
+        const Instance * instance = dynamic_cast<const Instance*>(shape) ;
+        const TriangleMesh * mesh = dynamic_cast<const TriangleMesh*>(instance != nullptr ? instance->get_geometry().get() : shape) ;
+        if (mesh == nullptr) {
+            return false ;
+        }
+        std::map<const TriangleMesh*, int>::iterator it = numeros.find(mesh) ;
+        if (it == numeros.end()) {
+            it = numeros.emplace(mesh, static_cast<int>(numeros.size())).first ;
+            append(positions, mesh->get_positions()) ;
+            append(normals, mesh->get_normals()) ;
+            append(triangles, mesh->get_triangles()) ;
+            append(normal_ids, mesh->get_normal_ids()) ;
+            append(nodes, mesh->get_bvh().get_nodes()) ;
+            append(indices, mesh->get_bvh().get_indices()) ;
+            positions_start.push_back(static_cast<int>(positions.size())) ;
+            normals_start.push_back(static_cast<int>(normals.size())) ;
+            triangles_start.push_back(static_cast<int>(triangles.size())) ;
+            nodes_start.push_back(static_cast<int>(nodes.size())) ;
+        }
+        other_mesh.push_back(it->second) ;
+        other_instance.push_back(instance != nullptr ? 1 : 0) ;
+        other_transform.push_back(instance != nullptr ? instance->get_transform() : Transform()) ;
+    }
+
+    geometries->positions_ = MappedArray<float>(std::move(positions)) ;
+    geometries->normals_ = MappedArray<float>(std::move(normals)) ;
+    geometries->triangles_ = MappedArray<int>(std::move(triangles)) ;
+    geometries->normal_ids_ = MappedArray<int>(std::move(normal_ids)) ;
+    geometries->nodes_ = MappedArray<BvhNode>(std::move(nodes)) ;
+    geometries->indices_ = MappedArray<int>(std::move(indices)) ;
+    geometries->positions_start_ = MappedArray<int>(std::move(positions_start)) ;
+    geometries->normals_start_ = MappedArray<int>(std::move(normals_start)) ;
+    geometries->triangles_start_ = MappedArray<int>(std::move(triangles_start)) ;
+    geometries->nodes_start_ = MappedArray<int>(std::move(nodes_start)) ;
+    geometries->other_mesh_ = MappedArray<int>(std::move(other_mesh)) ;
+    geometries->other_instance_ = MappedArray<unsigned char>(std::move(other_instance)) ;
+    geometries->other_transform_ = MappedArray<Transform>(std::move(other_transform)) ;
+    return true ;
+}
+
+std::vector<std::unique_ptr<Shape>> SceneCache::create_shapes(const Geometries & geometries, CompiledScene * compiled) {
+    const Geometries & g = geometries ;
+    // Chaque maillage désigne ses octets du fichier, sans copie ni reconstruction. Son matériel ne sert pas :
+    // le rendu lit la couleur et le miroir de chaque forme dans la scène compilée
+    auto create_mesh = [&](int m) {
+        int p0 = g.positions_start_[m], p1 = g.positions_start_[m + 1] ;
+        int n0 = g.normals_start_[m], n1 = g.normals_start_[m + 1] ;
+        int t0 = g.triangles_start_[m], t1 = g.triangles_start_[m + 1] ;
+        int b0 = g.nodes_start_[m], b1 = g.nodes_start_[m + 1] ;
+        Bvh bvh(MappedArray<BvhNode>(g.nodes_.data() + b0, b1 - b0), MappedArray<int>(g.indices_.data() + t0 / 3, (t1 - t0) / 3)) ;
+        return new TriangleMesh(Material(), MappedArray<float>(g.positions_.data() + p0, p1 - p0),
+                                MappedArray<float>(g.normals_.data() + n0, n1 - n0), MappedArray<int>(g.triangles_.data() + t0, t1 - t0),
+                                MappedArray<int>(g.normal_ids_.data() + t0, t1 - t0), std::move(bvh), false) ;
+    } ;
+
+    std::vector<std::unique_ptr<Shape>> shapes ;
+    // Les instances d'un même maillage le partagent, comme à la construction de la scène
+    std::vector<std::shared_ptr<const Shape>> partages(g.nodes_start_.size() - 1) ;
+    compiled->other_.clear() ;
+    for (size_t i = 0 ; i < g.other_mesh_.size() ; i++) {
+        int m = g.other_mesh_[i] ;
+        if (g.other_instance_[i] != 0) {
+            if (!partages[m]) {
+                partages[m].reset(create_mesh(m)) ;
+            }
+            shapes.emplace_back(new Instance(Material(), partages[m], g.other_transform_[i])) ;
+        }
+        else {
+            shapes.emplace_back(create_mesh(m)) ;
+        }
+        compiled->other_.push_back(shapes.back().get()) ;
+    }
+    return shapes ;
+}
+
+bool SceneCache::save(const Scene & scene, int size, const std::string & path) {
+    RT_TRACE("écriture du cache") ;
+    const CompiledScene & compiled = scene.get_compiled() ;
+    Geometries geometries ;
+    if (!collect(compiled, &geometries)) {
+        std::cerr << "Le cache de scène ne prend en charge que les sphères, les quads, les plans, les maillages et leurs instances" << std::endl ;
+        return false ;
+    }
+
+    EnTeteCache en_tete ;
+    std::memset(&en_tete, 0, sizeof(en_tete)) ;
+    std::memcpy(en_tete.magic_, MAGIC_CACHE, sizeof(MAGIC_CACHE)) ;
+    en_tete.version_ = VERSION_CACHE ;
+    en_tete.boutisme_ = BOUTISME_CACHE ;
+    en_tete.size_ = size ;
+    en_tete.nb_sections_ = NB_SECTIONS ;
+    Camera camera = scene.get_camera() ;
+    std::memcpy(en_tete.camera_, &camera, sizeof(Camera)) ;
+
+    // Place de chaque tableau, à la suite de l'en-tête et de la table des sections
+    std::vector<SectionCache> sections ;
+    uint64_t offset = sizeof(EnTeteCache) + NB_SECTIONS * sizeof(SectionCache) ;
+    const Bvh & bvh = scene.get_bvh() ;
+    for_each_array(bvh.get_nodes(), bvh.get_indices(), compiled, geometries, scene.get_lights(), [&](const auto & a) {
+        SectionCache section ;
+        offset = (offset + ALIGNEMENT_CACHE - 1) / ALIGNEMENT_CACHE * ALIGNEMENT_CACHE ;
+        section.offset_ = offset ;
+        section.count_ = a.size() ;
+        section.element_size_ = sizeof(*a.data()) ;
+        section.reserve_ = 0 ;
+        sections.push_back(section) ;
+        offset += section.count_ * section.element_size_ ;
+    }) ;
+
+    FILE * f = std::fopen(path.c_str(), "wb") ;
+    if (f == nullptr) {
+        std::cerr << "Impossible de créer le cache de scène " << path << std::endl ;
+        return false ;
+    }
+    bool ok = std::fwrite(&en_tete, sizeof(en_tete), 1, f) == 1
+              && std::fwrite(sections.data(), sizeof(SectionCache), sections.size(), f) == sections.size() ;
+    uint64_t ecrit = sizeof(EnTeteCache) + NB_SECTIONS * sizeof(SectionCache) ;
+    int k = 0 ;
+    const char zeros[ALIGNEMENT_CACHE] = {} ;
+    for_each_array(bvh.get_nodes(), bvh.get_indices(), compiled, geometries, scene.get_lights(), [&](const auto & a) {
+        const SectionCache & section = sections[k++] ;
+        if (ok && section.offset_ > ecrit) {
+            ok = std::fwrite(zeros, 1, section.offset_ - ecrit, f) == section.offset_ - ecrit ;
+        }
+        if (ok && section.count_ > 0) {
+            ok = std::fwrite(a.data(), section.element_size_, section.count_, f) == section.count_ ;
+        }
+        ecrit = section.offset_ + section.count_ * section.element_size_ ;
+    }) ;
+    ok = (std::fclose(f) == 0) && ok ;
+    if (!ok) {
+        std::cerr << "Erreur d'écriture du cache de scène " << path << std::endl ;
+        std::remove(path.c_str()) ;
+    }
+    return ok ;
+}
+
+bool SceneCache::load(const std::string & path, int size, Scene * scene) {
+    RT_TRACE("projection du cache") ;
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>() ;
+    if (!file->open(path)) {
+        return false ;
+    }
+    const unsigned char * data = file->get_data() ;
+    uint64_t taille = file->get_size() ;
+
+    EnTeteCache en_tete ;
+    if (taille < sizeof(EnTeteCache) + NB_SECTIONS * sizeof(SectionCache)) {
+        std::cerr << path << " : fichier trop court pour être un cache de scène" << std::endl ;
+        return false ;
+    }
+    std::memcpy(&en_tete, data, sizeof(en_tete)) ;
+    if (std::memcmp(en_tete.magic_, MAGIC_CACHE, sizeof(MAGIC_CACHE)) != 0) {
+        std::cerr << path << " : ce n'est pas un cache de scène" << std::endl ;
+        return false ;
+    }
+    if (en_tete.version_ != VERSION_CACHE || en_tete.boutisme_ != BOUTISME_CACHE || en_tete.nb_sections_ != NB_SECTIONS) {
+        std::cerr << path << " : cache écrit par une autre version du programme ou une autre machine, à refaire avec --cache" << std::endl ;
+        return false ;
+    }
+    if (en_tete.size_ != size) {
+        std::cerr << path << " : cache construit pour --size " << en_tete.size_ << ", pas " << size << std::endl ;
+        return false ;
+    }
+
+    // Chaque tableau désigne sa section du fichier, après vérification de sa place
+    std::vector<SectionCache> sections(NB_SECTIONS) ;
+    std::memcpy(sections.data(), data + sizeof(EnTeteCache), NB_SECTIONS * sizeof(SectionCache)) ;
+    MappedArray<BvhNode> nodes ;
+    MappedArray<int> indices ;
+    CompiledScene compiled ;
+    Geometries geometries ;
+    MappedArray<Light> lights ;
+    bool ok = true ;
+    int k = 0 ;
+    for_each_array(nodes, indices, compiled, geometries, lights, [&](auto & a) {
+        typedef typename std::decay<decltype(*a.data())>::type T ;
+        const SectionCache & section = sections[k++] ;
+        if (!ok) {
+            return ;
+        }
+        if (section.element_size_ != sizeof(T) || section.offset_ % ALIGNEMENT_CACHE != 0 || section.offset_ > taille
+            || section.count_ > (taille - section.offset_) / sizeof(T)) {
+            ok = false ;
+            return ;
+        }
+        a = typename std::decay<decltype(a)>::type(reinterpret_cast<const T *>(data + section.offset_), section.count_) ;
+    }) ;
+
+    // Les tailles des tableaux doivent correspondre entre elles, le rendu ne les vérifie plus
+    size_t n = indices.size() ;
+    size_t nb_spheres = compiled.sphere_shape_.size() ;
+    size_t nb_quads = compiled.quad_shape_.size() ;
+    size_t nb_planes = compiled.plane_shape_.size() ;
+    size_t nb_others = compiled.other_shape_.size() ;
+    size_t nb_shapes = compiled.material_ids_.size() ;
+    const Geometries & g = geometries ;
+    size_t nb_meshes = g.nodes_start_.size() - 1 ;
+    ok = ok && nodes.empty() == (n == 0)
+         && compiled.sphere_x_.size() == nb_spheres && compiled.sphere_y_.size() == nb_spheres
+         && compiled.sphere_z_.size() == nb_spheres && compiled.sphere_radius_.size() == nb_spheres
+         && compiled.quad_x0_.size() == nb_quads && compiled.quad_y0_.size() == nb_quads && compiled.quad_z0_.size() == nb_quads
+         && compiled.quad_x1_.size() == nb_quads && compiled.quad_y1_.size() == nb_quads && compiled.quad_z1_.size() == nb_quads
+         && compiled.plane_nx_.size() == nb_planes && compiled.plane_ny_.size() == nb_planes
+         && compiled.plane_nz_.size() == nb_planes && compiled.plane_d_.size() == nb_planes
+         && compiled.sphere_start_.size() == n + 1 && compiled.quad_start_.size() == n + 1 && compiled.other_start_.size() == n + 1
+         && static_cast<size_t>(compiled.sphere_start_[n]) == nb_spheres && static_cast<size_t>(compiled.quad_start_[n]) == nb_quads
+         && static_cast<size_t>(compiled.other_start_[n]) == nb_others && nb_spheres + nb_quads + nb_others == n
+         && n + nb_planes == nb_shapes
+         && compiled.shape_type_.size() == nb_shapes && compiled.shape_slot_.size() == nb_shapes
+         && compiled.albedos_.size() == 3 * compiled.miroirs_.size()
+         && !g.nodes_start_.empty() && g.positions_start_.size() == nb_meshes + 1
+         && g.normals_start_.size() == nb_meshes + 1 && g.triangles_start_.size() == nb_meshes + 1
+         && static_cast<size_t>(g.positions_start_[nb_meshes]) == g.positions_.size()
+         && static_cast<size_t>(g.normals_start_[nb_meshes]) == g.normals_.size()
+         && static_cast<size_t>(g.triangles_start_[nb_meshes]) == g.triangles_.size()
+         && static_cast<size_t>(g.nodes_start_[nb_meshes]) == g.nodes_.size()
+         && g.normal_ids_.size() == g.triangles_.size() && g.triangles_.size() == 3 * g.indices_.size()
+         && g.other_mesh_.size() == nb_others && g.other_instance_.size() == nb_others && g.other_transform_.size() == nb_others ;
+    ok = ok && check(nodes, indices, compiled, geometries) ;
+    if (!ok) {
+        std::cerr << path << " : cache de scène abîmé" << std::endl ;
+        return false ;
+    }
+
+    Camera camera ;
+    std::memcpy(&camera, en_tete.camera_, sizeof(Camera)) ;
+    scene->set_camera(camera) ;
+    // Les lumières sont copiées, leur table de tirage étant reconstruite
+    scene->set_lights(std::vector<Light>(lights.data(), lights.data() + lights.size())) ;
+    // Les maillages et les instances sont recréés autour des octets du fichier, que la scène garde ouvert
+    std::vector<std::unique_ptr<Shape>> owned = create_shapes(geometries, &compiled) ;
+    scene->set_compiled(Bvh(std::move(nodes), std::move(indices)), std::move(compiled), std::move(owned), file) ;
+    return true ;
+}
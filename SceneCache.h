@@ -0,0 +1,162 @@
+#ifndef SCENECACHE_H
+#define SCENECACHE_H
+
+#include "Scene.h"
+#include "Bvh.h"
+#include "CompiledScene.h"
+#include "MappedArray.h"
+#include "Transform.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief La classe SceneCache enregistre une scène compilée dans un fichier binaire, et la relit sans la reconstruire
+ *
+ * Le fichier (.rtc) contient, après un en-tête versionné, chaque tableau de CompiledScene et du Bvh tel qu'il est
+ * en mémoire, aligné sur 64 octets. À la lecture, le fichier est projeté en mémoire (MappedFile) et les tableaux
+ * de la scène désignent directement ses octets : rien n'est analysé, copié ni reconstruit, et seules les pages
+ * touchées par le rendu sont lues sur le disque.
+ *
+ * Les maillages (TriangleMesh) et leurs instances (Instance) sont enregistrés à part, avec la hiérarchie de
+ * chaque maillage : à la lecture, ils sont recréés autour des octets du fichier, sans reconstruire leur hiérarchie.
+ * Un maillage partagé par plusieurs instances n'est enregistré qu'une fois.
+ *
+ * Le format est celui de la machine (boutisme, taille des types) et de la version du programme qui l'a écrit ;
+ * un fichier d'une autre machine ou d'une autre version est refusé. Les autres formes (les groupes ShapeGroup
+ * notamment) ne peuvent pas être enregistrées.
+ *
+ * @see CompiledScene, Bvh, MappedFile, TriangleMesh, Instance
+*/
+class SceneCache {
+    private :
+        /**
+         * @brief Les maillages et les instances de la scène compilée (CompiledScene::other_), rangés en tableaux
+         *
+         * Les tableaux de tous les maillages sont mis bout à bout. Les éléments du maillage m commencent à
+         * positions_start_[m], normals_start_[m], triangles_start_[m] (pour triangles_ et normal_ids_, dont
+         * indices_ a trois fois moins d'éléments) et nodes_start_[m] ; ces tableaux ont un élément de plus que de maillages.
+        */
+        struct Geometries {
+            /**
+             * @brief Les tableaux de TriangleMesh, ceux de tous les maillages à la suite
+            */
+            MappedArray<float> positions_, normals_ ;
+            MappedArray<int> triangles_, normal_ids_ ;
+            /**
+             * @brief Les noeuds et les indices des hiérarchies des maillages
+            */
+            MappedArray<BvhNode> nodes_ ;
+            MappedArray<int> indices_ ;
+            /**
+             * @brief Le début de chaque maillage dans les tableaux, avec la fin du dernier
+            */
+            MappedArray<int> positions_start_, normals_start_, triangles_start_, nodes_start_ ;
+            /**
+             * @brief Pour chaque autre forme de la scène compilée, le maillage qu'elle est ou qu'elle place
+            */
+            MappedArray<int> other_mesh_ ;
+            /**
+             * @brief Pour chaque autre forme, 1 si c'est une instance du maillage, 0 si c'est le maillage lui-même
+            */
+            MappedArray<unsigned char> other_instance_ ;
+            /**
+             * @brief Pour chaque autre forme, la transformation de l'instance (l'identité pour un maillage)
+            */
+            MappedArray<Transform> other_transform_ ;
+        } ;
+
+        /**
+         * @brief Appelle f sur chaque tableau de la scène compilée, toujours dans l'ordre du fichier
+         *
+         * L'écriture et la lecture parcourent ainsi les sections dans le même ordre.
+         *
+         * @param nodes : référence vers les noeuds du Bvh
+         * @param indices : référence vers les indices des primitives du Bvh
+         * @param compiled : référence vers la scène compilée
+         * @param geometries : référence vers les maillages et les instances de la scène compilée
+         * @param lights : référence vers les lumières de la scène
+         * @param f : la fonction appelée pour chaque tableau
+        */
+        template <typename Nodes, typename Indices, typename Compiled, typename Meshes, typename Lights, typename F>
+        static void for_each_array(Nodes & nodes, Indices & indices, Compiled & compiled, Meshes & geometries, Lights & lights, F f) {
+            f(nodes) ; f(indices) ;
+            f(compiled.sphere_x_) ; f(compiled.sphere_y_) ; f(compiled.sphere_z_) ; f(compiled.sphere_radius_) ;
+            f(compiled.sphere_shape_) ;
+            f(compiled.quad_x0_) ; f(compiled.quad_y0_) ; f(compiled.quad_z0_) ;
+            f(compiled.quad_x1_) ; f(compiled.quad_y1_) ; f(compiled.quad_z1_) ;
+            f(compiled.quad_shape_) ;
+            f(compiled.plane_nx_) ; f(compiled.plane_ny_) ; f(compiled.plane_nz_) ; f(compiled.plane_d_) ;
+            f(compiled.plane_shape_) ; f(compiled.other_shape_) ;
+            f(compiled.sphere_start_) ; f(compiled.quad_start_) ; f(compiled.other_start_) ;
+            f(compiled.shape_type_) ; f(compiled.shape_slot_) ;
+            f(compiled.material_ids_) ; f(compiled.albedos_) ; f(compiled.miroirs_) ;
+            f(geometries.positions_) ; f(geometries.normals_) ; f(geometries.triangles_) ; f(geometries.normal_ids_) ;
+            f(geometries.nodes_) ; f(geometries.indices_) ;
+            f(geometries.positions_start_) ; f(geometries.normals_start_) ; f(geometries.triangles_start_) ;
+            f(geometries.nodes_start_) ;
+            f(geometries.other_mesh_) ; f(geometries.other_instance_) ; f(geometries.other_transform_) ;
+            f(lights) ;
+        }
+        /**
+         * @brief Range les maillages et les instances de la scène compilée en tableaux
+         *
+         * @param compiled : référence vers la scène compilée
+         * @param geometries : pointeur vers les tableaux remplis
+         *
+         * @return true si toutes les autres formes sont des maillages ou des instances de maillages, false sinon
+        */
+        static bool collect(const CompiledScene & compiled, Geometries * geometries) ;
+        /**
+         * @brief Recrée les maillages et les instances relus, autour des octets du fichier, et les donne à la scène compilée
+         *
+         * @param geometries : référence vers les tableaux relus, déjà vérifiés par check
+         * @param compiled : pointeur vers la scène compilée, dont other_ est rempli
+         *
+         * @return Les formes recréées, qui doivent vivre aussi longtemps que la scène compilée
+        */
+        static std::vector<std::unique_ptr<Shape>> create_shapes(const Geometries & geometries, CompiledScene * compiled) ;
+        /**
+         * @brief Vérifie que les indices relus restent dans leurs tableaux, le rendu ne les vérifiant plus
+         *
+         * Un seul parcours de chaque tableau : enfants et primitives des noeuds, indices du Bvh, places et types
+         * des formes, matériaux, et profondeur de l'arbre, bornée par la pile de Bvh::traverse ; de même pour
+         * les sommets, les normales et la hiérarchie de chaque maillage.
+         * Les tailles des tableaux doivent déjà correspondre entre elles.
+         *
+         * @param nodes : référence vers les noeuds du Bvh
+         * @param indices : référence vers les indices des primitives du Bvh
+         * @param compiled : référence vers la scène compilée
+         * @param geometries : référence vers les maillages et les instances
+         *
+         * @return true si la scène peut être rendue sans sortir d'un tableau, false sinon
+        */
+        static bool check(const MappedArray<BvhNode> & nodes, const MappedArray<int> & indices, const CompiledScene & compiled,
+                          const Geometries & geometries) ;
+
+    public :
+        /**
+         * @brief Enregistre la scène compilée, sa caméra et ses lumières
+         *
+         * @param scene : référence vers la scène, déjà construite
+         * @param size : le côté de l'image pour lequel la scène a été construite
+         * @param path : référence vers le chemin du fichier écrit
+         *
+         * @return true si le fichier a été écrit, false sinon (l'erreur est affichée)
+        */
+        static bool save(const Scene & scene, int size, const std::string & path) ;
+        /**
+         * @brief Relit une scène enregistrée par save
+         *
+         * La scène garde le fichier projeté tant qu'elle (ou une de ses copies) l'utilise.
+         *
+         * @param path : référence vers le chemin du fichier
+         * @param size : le côté de l'image rendue, qui doit être celui de l'enregistrement
+         * @param scene : pointeur vers la scène à remplir, qui n'est modifiée que si le fichier est correct
+         *
+         * @return true si le fichier a été relu, false sinon (l'erreur est affichée)
+        */
+        static bool load(const std::string & path, int size, Scene * scene) ;
+} ;
+
+#endif
@@ -0,0 +1,514 @@
+#include "SceneParser.h"
+#include "Trace.h"
+#include "Sphere.h"
+#include "Quad.h"
+#include "Plane.h"
+#include "ObjLoader.h"
+#include "Instance.h"
+#include "Transform.h"
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// Taille des blocs lus dans le fichier : le fichier n'est jamais chargé en entier
+const size_t TAILLE_BLOC = 1 << 20 ;
+
+// Les séparateurs des valeurs d'une ligne (\r pour les fichiers écrits sous Windows)
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' ;
+}
+
+// Compare un mot de la ligne à un mot-clé
+static bool same_word(const char * debut, const char * fin, const char * mot) {
+    size_t n = std::strlen(mot) ;
+    return static_cast<size_t>(fin - debut) == n && std::memcmp(debut, mot, n) == 0 ;
+}
+
+SceneParser::SceneParser(int size, int nb_threads) {
+    size_ = size ;
+    nb_threads_ = nb_threads ;
+    line_ = 0 ;
+    echelle_ = 1.0f ;
+    scene_commencee_ = false ;
+    has_camera_ = false ;
+    dernier_materiau_ = -1 ;
+    curseur_ = nullptr ;
+    fin_ = nullptr ;
+}
+
+SceneParser::~SceneParser() {
+    clear() ;
+}
+
+void SceneParser::clear() {
+    for (Shape * shape : shapes_) {
+        delete shape ;
+    }
+    shapes_.clear() ;
+    geometries_.clear() ;
+    lights_.clear() ;
+}
+
+bool SceneParser::error(const std::string & message) const {
+    std::cerr << file_ << ":" << line_ << " : " << message << std::endl ;
+    return false ;
+}
+
+bool SceneParser::next_word(const char ** debut, const char ** fin) {
+    while (curseur_ < fin_ && is_space(*curseur_)) {
+        curseur_++ ;
+    }
+    if (curseur_ == fin_) {
+        return false ;
+    }
+    *debut = curseur_ ;
+    while (curseur_ < fin_ && !is_space(*curseur_)) {
+        curseur_++ ;
+    }
+    *fin = curseur_ ;
+    return true ;
+}
+
+bool SceneParser::read_floats(float * valeurs, int n, const char * quoi) {
+    for (int i = 0 ; i < n ; i++) {
+        const char * debut ;
+        const char * fin ;
+        if (!next_word(&debut, &fin)) {
+            return error(std::string(quoi) + " : " + std::to_string(n) + " valeurs attendues, " + std::to_string(i) + " trouvées") ;
+        }
+        // from_chars ne dépend pas de la locale et ne crée pas de chaîne intermédiaire
+        std::from_chars_result r = std::from_chars(debut, fin, valeurs[i]) ;
+        if (r.ec != std::errc() || r.ptr != fin) {
+            return error(std::string(quoi) + " : nombre invalide '" + std::string(debut, fin) + "'") ;
+        }
+    }
+    return true ;
+}
+
+bool SceneParser::read_optional_floats(float * valeurs, int max, const char * quoi, int * n) {
+    *n = 0 ;
+    const char * debut ;
+    const char * fin ;
+    while (next_word(&debut, &fin)) {
+        if (*n == max) {
+            return error("valeur en trop '" + std::string(debut, fin) + "'") ;
+        }
+        std::from_chars_result r = std::from_chars(debut, fin, valeurs[*n]) ;
+        if (r.ec != std::errc() || r.ptr != fin) {
+            return error(std::string(quoi) + " : nombre invalide '" + std::string(debut, fin) + "'") ;
+        }
+        (*n)++ ;
+    }
+    return true ;
+}
+
+bool SceneParser::read_material(int * id) {
+    const char * debut ;
+    const char * fin ;
+    if (!next_word(&debut, &fin)) {
+        return error("nom de matériau attendu en fin de ligne") ;
+    }
+    // Les formes qui se suivent ont souvent le même matériau : on évite alors la recherche dans noms_
+    if (dernier_materiau_ >= 0 && same_word(debut, fin, dernier_nom_.c_str())) {
+        *id = dernier_materiau_ ;
+        return true ;
+    }
+    std::unordered_map<std::string, int>::const_iterator it = noms_.find(std::string(debut, fin)) ;
+    if (it == noms_.end()) {
+        return error("matériau inconnu '" + std::string(debut, fin) + "'") ;
+    }
+    *id = it->second ;
+    dernier_nom_ = it->first ;
+    dernier_materiau_ = it->second ;
+    return true ;
+}
+
+bool SceneParser::read_power(float * puissance, const char * quoi) {
+    *puissance = PUISSANCE_LUMIERE ;
+    const char * debut ;
+    const char * fin ;
+    if (!next_word(&debut, &fin)) {
+        return true ;
+    }
+    std::from_chars_result r = std::from_chars(debut, fin, *puissance) ;
+    if (r.ec != std::errc() || r.ptr != fin || *puissance < 0.0f) {
+        return error(std::string(quoi) + " : puissance invalide '" + std::string(debut, fin) + "'") ;
+    }
+    return end_of_line() ;
+}
+
+bool SceneParser::end_of_line() {
+    const char * debut ;
+    const char * fin ;
+    if (next_word(&debut, &fin)) {
+        return error("valeur en trop '" + std::string(debut, fin) + "'") ;
+    }
+    return true ;
+}
+
+bool SceneParser::parse_line(const char * debut, const char * fin) {
+    // Le commentaire est retiré avant l'analyse
+    const char * commentaire = static_cast<const char *>(std::memchr(debut, '#', fin - debut)) ;
+    curseur_ = debut ;
+    fin_ = (commentaire != nullptr) ? commentaire : fin ;
+
+    const char * mot ;
+    const char * fin_mot ;
+    if (!next_word(&mot, &fin_mot)) {
+        return true ; // ligne vide
+    }
+
+    float v[9] ;
+    int id ;
+
+    // Les lignes les plus fréquentes d'abord
+    if (same_word(mot, fin_mot, "sphere")) {
+        if (!read_floats(v, 4, "sphere") || !read_material(&id) || !end_of_line()) {
+            return false ;
+        }
+        if (!(v[3] > 0.0f)) {
+            return error("sphere : le rayon doit être positif") ;
+        }
+        scene_commencee_ = true ;
+        shapes_.push_back(new Sphere(materiaux_[id], echelle_ * Vector3f(v[0], v[1], v[2]), v[3] * echelle_, miroirs_[id])) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "quad")) {
+        if (!read_floats(v, 9, "quad") || !read_material(&id) || !end_of_line()) {
+            return false ;
+        }
+        scene_commencee_ = true ;
+        shapes_.push_back(new Quad(materiaux_[id], echelle_ * Vector3f(v[0], v[1], v[2]), echelle_ * Vector3f(v[3], v[4], v[5]),
+                                   echelle_ * Vector3f(v[6], v[7], v[8]), miroirs_[id])) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "plane")) {
+        if (!read_floats(v, 6, "plane") || !read_material(&id) || !end_of_line()) {
+            return false ;
+        }
+        if (v[3] == 0.0f && v[4] == 0.0f && v[5] == 0.0f) {
+            return error("plane : la normale ne doit pas être nulle") ;
+        }
+        scene_commencee_ = true ;
+        shapes_.push_back(new Plane(materiaux_[id], echelle_ * Vector3f(v[0], v[1], v[2]), Vector3f(v[3], v[4], v[5]), miroirs_[id])) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "material")) {
+        const char * nom ;
+        const char * fin_nom ;
+        if (!next_word(&nom, &fin_nom)) {
+            return error("material : nom attendu") ;
+        }
+        if (!read_floats(v, 3, "material")) {
+            return false ;
+        }
+        bool miroir = false ;
+        const char * option ;
+        const char * fin_option ;
+        if (next_word(&option, &fin_option)) {
+            if (!same_word(option, fin_option, "mirror")) {
+                return error("material : option inconnue '" + std::string(option, fin_option) + "' (seul mirror est possible)") ;
+            }
+            miroir = true ;
+            if (!end_of_line()) {
+                return false ;
+            }
+        }
+        if (!noms_.emplace(std::string(nom, fin_nom), static_cast<int>(materiaux_.size())).second) {
+            return error("material : le matériau '" + std::string(nom, fin_nom) + "' est déjà défini") ;
+        }
+        scene_commencee_ = true ;
+        materiaux_.push_back(Material(v[0], v[1], v[2], 0.0f)) ;
+        miroirs_.push_back(miroir) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "camera")) {
+        int nb_options ;
+        if (!read_floats(v, 3, "camera") || !read_optional_floats(&v[3], 6, "camera", &nb_options)) {
+            return false ;
+        }
+        if (has_camera_) {
+            return error("camera : la caméra est déjà définie") ;
+        }
+        if (nb_options > 0 && nb_options < 3) {
+            return error("camera : le point visé doit avoir 3 coordonnées") ;
+        }
+        Vector3f position = echelle_ * Vector3f(v[0], v[1], v[2]) ;
+        // Sans point visé, la caméra regarde l'écran en z = 0, vers les z positifs
+        Vector3f cible = (nb_options == 0) ? Vector3f(position.get_x(), position.get_y(), 0.0f)
+                                            : echelle_ * Vector3f(v[3], v[4], v[5]) ;
+        Vector3f visee = cible - position ;
+        if (nb_options == 0 && position.get_z() >= 0.0f) {
+            return error("camera : sans point visé, la caméra doit être en z < 0") ;
+        }
+        if (visee.longueur() == 0.0f) {
+            return error("camera : le point visé est la position de la caméra") ;
+        }
+        if (cross(visee.get_normalised(), Vector3f(0.0f, -1.0f, 0.0f)).longueur() < 1e-3f) {
+            return error("camera : la caméra ne peut pas regarder à la verticale") ;
+        }
+        double champ = (nb_options > 3) ? v[6] : Camera::screen_fov(size_, visee.longueur()) ;
+        if (champ <= 0.0 || champ >= 180.0) {
+            return error("camera : l'angle de champ doit être entre 0 et 180 degrés") ;
+        }
+        float ouverture = (nb_options > 4) ? echelle_ * v[7] : 0.0f ;
+        float mise_au_point = (nb_options > 5) ? echelle_ * v[8] : 0.0f ;
+        if (ouverture < 0.0f || (nb_options > 5 && mise_au_point <= 0.0f)) {
+            return error("camera : l'ouverture doit être positive et la mise au point strictement positive") ;
+        }
+        scene_commencee_ = true ;
+        has_camera_ = true ;
+        camera_ = Camera(position, cible, Vector3f(0.0f, -1.0f, 0.0f), champ, size_, size_, ouverture, mise_au_point) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "light")) {
+        if (!read_floats(v, 3, "light") || !read_power(&v[3], "light")) {
+            return false ;
+        }
+        scene_commencee_ = true ;
+        lights_.push_back(Light(echelle_ * Vector3f(v[0], v[1], v[2]), v[3])) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "sphere_light")) {
+        if (!read_floats(v, 4, "sphere_light") || !read_power(&v[4], "sphere_light")) {
+            return false ;
+        }
+        if (v[3] < 0.0f) {
+            return error("sphere_light : rayon négatif") ;
+        }
+        scene_commencee_ = true ;
+        lights_.push_back(Light::sphere(echelle_ * Vector3f(v[0], v[1], v[2]), v[3] * echelle_, v[4])) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "rect_light")) {
+        float puissance ;
+        if (!read_floats(v, 9, "rect_light") || !read_power(&puissance, "rect_light")) {
+            return false ;
+        }
+        Vector3f cote_u(v[3], v[4], v[5]) ;
+        Vector3f cote_v(v[6], v[7], v[8]) ;
+        if (!(cross(cote_u, cote_v).norme2() > 0.0f)) {
+            return error("rect_light : les côtés doivent être non nuls et non parallèles") ;
+        }
+        scene_commencee_ = true ;
+        lights_.push_back(Light::rectangle(echelle_ * Vector3f(v[0], v[1], v[2]), echelle_ * cote_u, echelle_ * cote_v, puissance)) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "size")) {
+        if (!read_floats(v, 1, "size") || !end_of_line()) {
+            return false ;
+        }
+        if (scene_commencee_) {
+            return error("size : doit précéder toutes les autres lignes") ;
+        }
+        if (!(v[0] > 0.0f)) {
+            return error("size : la taille doit être positive") ;
+        }
+        echelle_ = size_ / v[0] ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "mesh")) {
+        const char * nom ;
+        const char * fin_nom ;
+        if (!next_word(&nom, &fin_nom)) {
+            return error("mesh : fichier .obj attendu") ;
+        }
+        if (!read_material(&id) || !end_of_line()) {
+            return false ;
+        }
+        std::string chemin = scene_path(nom, fin_nom) ;
+        ObjLoader loader(nb_threads_) ;
+        if (!loader.load(chemin)) {
+            return error("mesh : impossible de lire " + chemin) ;
+        }
+        scene_commencee_ = true ;
+        shapes_.push_back(loader.create_mesh(materiaux_[id], echelle_, miroirs_[id])) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "instance")) {
+        const char * nom ;
+        const char * fin_nom ;
+        if (!next_word(&nom, &fin_nom)) {
+            return error("instance : nom de géométrie attendu") ;
+        }
+        std::unordered_map<std::string, std::shared_ptr<const Shape>>::const_iterator geometrie = geometries_.find(std::string(nom, fin_nom)) ;
+        if (geometrie == geometries_.end()) {
+            return error("instance : géométrie inconnue '" + std::string(nom, fin_nom) + "'") ;
+        }
+        Transform transformation ;
+        if (!read_transform(&transformation) || !read_material(&id) || !end_of_line()) {
+            return false ;
+        }
+        scene_commencee_ = true ;
+        shapes_.push_back(new Instance(materiaux_[id], geometrie->second, transformation, miroirs_[id])) ;
+        return true ;
+    }
+    if (same_word(mot, fin_mot, "geometry")) {
+        const char * nom ;
+        const char * fin_nom ;
+        const char * fichier ;
+        const char * fin_fichier ;
+        if (!next_word(&nom, &fin_nom) || !next_word(&fichier, &fin_fichier)) {
+            return error("geometry : nom et fichier .obj attendus") ;
+        }
+        if (!end_of_line()) {
+            return false ;
+        }
+        if (geometries_.count(std::string(nom, fin_nom)) > 0) {
+            return error("geometry : la géométrie '" + std::string(nom, fin_nom) + "' est déjà définie") ;
+        }
+        std::string chemin = scene_path(fichier, fin_fichier) ;
+        ObjLoader loader(nb_threads_) ;
+        if (!loader.load(chemin)) {
+            return error("geometry : impossible de lire " + chemin) ;
+        }
+        scene_commencee_ = true ;
+        // Le matériau de la géométrie n'est pas utilisé : chaque instance donne le sien
+        geometries_[std::string(nom, fin_nom)] = std::shared_ptr<const Shape>(loader.create_mesh(Material(), echelle_, false)) ;
+        return true ;
+    }
+    return error("mot-clé inconnu '" + std::string(mot, fin_mot) + "'") ;
+}
+
+std::string SceneParser::scene_path(const char * debut, const char * fin) const {
+    // Un chemin relatif part du dossier du fichier de scène
+    std::string chemin(debut, fin) ;
+    size_t dossier = file_.find_last_of('/') ;
+    if (chemin[0] != '/' && dossier != std::string::npos) {
+        chemin = file_.substr(0, dossier + 1) + chemin ;
+    }
+    return chemin ;
+}
+
+bool SceneParser::read_transform(Transform * transformation) {
+    while (true) {
+        // Le mot qui n'est pas une transformation est le matériau : il est laissé à read_material
+        const char * avant = curseur_ ;
+        const char * mot ;
+        const char * fin_mot ;
+        if (!next_word(&mot, &fin_mot)) {
+            return true ;
+        }
+        float v[3] ;
+        Transform t ;
+        if (same_word(mot, fin_mot, "translate")) {
+            if (!read_floats(v, 3, "translate")) {
+                return false ;
+            }
+            t = Transform::translation(echelle_ * Vector3f(v[0], v[1], v[2])) ;
+        }
+        else if (same_word(mot, fin_mot, "rotate")) {
+            const char * axe ;
+            const char * fin_axe ;
+            if (!next_word(&axe, &fin_axe) || fin_axe - axe != 1 || *axe < 'x' || *axe > 'z') {
+                return error("rotate : axe x, y ou z attendu") ;
+            }
+            if (!read_floats(v, 1, "rotate")) {
+                return false ;
+            }
+            t = Transform::rotation(*axe - 'x', v[0]) ;
+        }
+        else if (same_word(mot, fin_mot, "scale")) {
+            if (!read_floats(v, 1, "scale")) {
+                return false ;
+            }
+            // Un facteur pour les trois axes, ou un facteur par axe
+            const char * apres = curseur_ ;
+            const char * suivant ;
+            const char * fin_suivant ;
+            float valeur ;
+            if (next_word(&suivant, &fin_suivant) && std::from_chars(suivant, fin_suivant, valeur).ptr == fin_suivant) {
+                curseur_ = apres ;
+                if (!read_floats(v + 1, 2, "scale")) {
+                    return false ;
+                }
+            }
+            else {
+                curseur_ = apres ;
+                v[1] = v[0] ;
+                v[2] = v[0] ;
+            }
+            if (v[0] == 0.0f || v[1] == 0.0f || v[2] == 0.0f) {
+                return error("scale : un facteur nul n'est pas inversible") ;
+            }
+            t = Transform::scaling(Vector3f(v[0], v[1], v[2])) ;
+        }
+        else {
+            curseur_ = avant ;
+            return true ;
+        }
+        // Les transformations s'appliquent dans l'ordre où elles sont écrites
+        *transformation = t * *transformation ;
+    }
+}
+
+bool SceneParser::parse_file(const std::string & path, Scene * scene) {
+    RT_TRACE("lecture de la scène") ;
+    file_ = path ;
+    FILE * f = std::fopen(path.c_str(), "rb") ;
+    if (f == nullptr) {
+        std::cerr << "Impossible d'ouvrir le fichier de scène " << path << std::endl ;
+        return false ;
+    }
+
+    // Le fichier est lu par blocs : les lignes complètes d'un bloc sont analysées aussitôt,
+    // et la ligne coupée à la fin du bloc est recopiée au début du suivant
+    std::vector<char> tampon(TAILLE_BLOC) ;
+    size_t plein = 0 ;
+    bool ok = true ;
+    bool fin_fichier = false ;
+    while (ok && !fin_fichier) {
+        if (plein == tampon.size()) {
+            // Une ligne plus longue qu'un bloc
+            tampon.resize(tampon.size() * 2) ;
+        }
+        size_t lus = std::fread(tampon.data() + plein, 1, tampon.size() - plein, f) ;
+        plein += lus ;
+        fin_fichier = (lus == 0) ;
+
+        const char * p = tampon.data() ;
+        const char * fin = p + plein ;
+        while (ok) {
+            const char * nl = static_cast<const char *>(std::memchr(p, '\n', fin - p)) ;
+            if (nl == nullptr) {
+                // La dernière ligne du fichier n'a pas forcément de fin de ligne
+                if (fin_fichier && p < fin) {
+                    line_++ ;
+                    ok = parse_line(p, fin) ;
+                    p = fin ;
+                }
+                break ;
+            }
+            line_++ ;
+            ok = parse_line(p, nl) ;
+            p = nl + 1 ;
+        }
+        plein = static_cast<size_t>(fin - p) ;
+        std::memmove(tampon.data(), p, plein) ;
+    }
+    bool erreur_lecture = std::ferror(f) != 0 ;
+    std::fclose(f) ;
+
+    if (!ok) {
+        clear() ;
+        return false ;
+    }
+    if (erreur_lecture) {
+        std::cerr << "Erreur de lecture du fichier de scène " << path << std::endl ;
+        clear() ;
+        return false ;
+    }
+    if (!has_camera_ || lights_.empty()) {
+        std::cerr << path << " : la scène doit définir une caméra (camera) et au moins une lumière (light)" << std::endl ;
+        clear() ;
+        return false ;
+    }
+
+    scene->set_camera(camera_) ;
+    scene->set_lights(lights_) ;
+    // Les formes appartiennent maintenant à la scène, qui les détruira
+    scene->set_shapes(shapes_) ;
+    shapes_.clear() ;
+    return true ;
+}
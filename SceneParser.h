@@ -0,0 +1,239 @@
+#ifndef SCENEPARSER_H
+#define SCENEPARSER_H
+
+#include "Scene.h"
+#include "Shape.h"
+#include "Camera.h"
+#include "Light.h"
+#include "Material.h"
+#include "Transform.h"
+#include "Vector3f.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief La classe SceneParser lit une scène décrite dans un fichier texte
+ *
+ * Le fichier est lu par blocs et analysé en une seule passe, ligne par ligne, sans construire de représentation
+ * intermédiaire : chaque ligne crée directement sa forme. Une ligne est un mot-clé suivi de ses valeurs, séparés
+ * par des espaces ; tout ce qui suit un # est un commentaire.
+ *
+ *     size N                       les coordonnées sont données pour une image de côté N (1 unité = 1 pixel sinon)
+ *     camera x y z [cx cy cz [champ [ouverture [mise_au_point]]]]
+ *                                  la position de la caméra et le point visé (x, y, 0 par défaut), l'angle de
+ *                                  champ vertical en degrés (par défaut, le plan du point visé montre N unités de
+ *                                  haut), le rayon de la lentille (0, un sténopé, par défaut) et la distance de
+ *                                  mise au point (la distance au point visé par défaut)
+ *     light x y z [puissance]      une lumière ponctuelle, la scène peut en avoir autant que voulu
+ *     sphere_light x y z rayon [puissance]
+ *                                  une lumière sphérique, qui donne des ombres douces
+ *     rect_light x y z ux uy uz vx vy vz [puissance]
+ *                                  une lumière rectangulaire de coin (x, y, z) et de côtés u et v
+ *     material nom r g b [mirror]  un matériau, couleur de 0 à 255, éventuellement miroir
+ *     sphere x y z rayon nom       une sphère du matériau nom
+ *     quad x y z wx wy wz hx hy hz nom
+ *                                  un pavé (Quad) d'origine (x, y, z), de largeur w et de hauteur h
+ *     plane x y z nx ny nz nom     un plan infini passant par (x, y, z), de normale (nx, ny, nz)
+ *     mesh fichier.obj nom         un maillage lu dans un fichier OBJ (chemin relatif au fichier de scène)
+ *     geometry g fichier.obj       un maillage nommé g, qui n'est pas dans la scène mais peut y être instancié
+ *     instance g [transformations] nom
+ *                                  une copie de la géométrie g, du matériau nom, placée par des transformations
+ *                                  appliquées dans l'ordre où elles sont écrites : scale s, scale sx sy sz,
+ *                                  rotate x|y|z degrés, translate x y z (depuis l'origine du fichier OBJ)
+ *
+ * Toutes les positions et longueurs sont multipliées par le rapport entre la taille de l'image rendue et N.
+ * size doit donc précéder les autres lignes, et un matériau doit être défini avant d'être utilisé.
+ * La puissance d'une lumière, PUISSANCE_LUMIERE si elle n'est pas donnée, n'est pas mise à l'échelle.
+ * Les lumières ne sont pas visibles dans l'image : une forme placée au même endroit arrêterait leurs rayons d'ombre.
+ * La première erreur arrête la lecture et est affichée avec le numéro de sa ligne.
+ *
+ * @see Scene
+*/
+class SceneParser {
+    private :
+        /**
+         * @brief Le côté de l'image rendue, en pixels
+        */
+        int size_ ;
+        /**
+         * @brief Le nombre de threads de la lecture des maillages et de la construction des hiérarchies, 0 pour tous les coeurs
+        */
+        int nb_threads_ ;
+        /**
+         * @brief Le nom du fichier lu, pour les messages d'erreur
+        */
+        std::string file_ ;
+        /**
+         * @brief Le numéro de la ligne en cours de lecture
+        */
+        int line_ ;
+        /**
+         * @brief Le facteur appliqué aux positions et aux longueurs (taille de l'image / size)
+        */
+        float echelle_ ;
+        /**
+         * @brief true dès qu'une ligne autre que size a été lue
+        */
+        bool scene_commencee_ ;
+
+        /**
+         * @brief Les formes déjà lues
+        */
+        std::vector<Shape*> shapes_ ;
+        /**
+         * @brief Les matériaux déjà lus, et s'ils sont des miroirs
+        */
+        std::vector<Material> materiaux_ ;
+        std::vector<bool> miroirs_ ;
+        /**
+         * @brief L'indice de chaque matériau dans materiaux_, à partir de son nom
+        */
+        std::unordered_map<std::string, int> noms_ ;
+        /**
+         * @brief Le dernier matériau utilisé par une forme, et son nom (-1 s'il n'y en a pas encore)
+        */
+        int dernier_materiau_ ;
+        std::string dernier_nom_ ;
+        /**
+         * @brief Les géométries déjà lues, partagées par leurs instances, à partir de leur nom
+        */
+        std::unordered_map<std::string, std::shared_ptr<const Shape>> geometries_ ;
+        /**
+         * @brief La caméra, si elle a été lue
+        */
+        Camera camera_ ;
+        bool has_camera_ ;
+        /**
+         * @brief Les lumières déjà lues
+        */
+        std::vector<Light> lights_ ;
+
+        /**
+         * @brief Le début et la fin de ce qu'il reste à lire de la ligne en cours
+        */
+        const char * curseur_ ;
+        const char * fin_ ;
+
+        /**
+         * @brief Affiche une erreur, avec le nom du fichier et le numéro de la ligne en cours
+         *
+         * @param message : référence vers le message
+         *
+         * @return false, pour pouvoir écrire return error(...)
+        */
+        bool error(const std::string & message) const ;
+        /**
+         * @brief Lit le prochain mot de la ligne
+         *
+         * @param debut : pointeur vers le début du mot
+         * @param fin : pointeur vers la fin du mot
+         *
+         * @return true s'il reste un mot sur la ligne, false sinon
+        */
+        bool next_word(const char ** debut, const char ** fin) ;
+        /**
+         * @brief Lit les n prochains nombres de la ligne
+         *
+         * @param valeurs : les nombres lus, au moins n
+         * @param n : le nombre de valeurs attendues
+         * @param quoi : ce que décrit la ligne, pour le message d'erreur
+         *
+         * @return true si les n nombres ont été lus, false sinon (l'erreur est affichée)
+        */
+        bool read_floats(float * valeurs, int n, const char * quoi) ;
+        /**
+         * @brief Lit les nombres facultatifs qui terminent la ligne
+         *
+         * @param valeurs : les nombres lus, au moins max
+         * @param max : le nombre de valeurs permises
+         * @param quoi : ce que décrit la ligne, pour le message d'erreur
+         * @param n : pointeur vers le nombre de valeurs lues
+         *
+         * @return true si au plus max nombres terminent la ligne, false sinon (l'erreur est affichée)
+        */
+        bool read_optional_floats(float * valeurs, int max, const char * quoi, int * n) ;
+        /**
+         * @brief Lit le nom d'un matériau déjà défini, en fin de ligne
+         *
+         * @param id : pointeur vers l'indice du matériau dans materiaux_
+         *
+         * @return true si le matériau existe, false sinon (l'erreur est affichée)
+        */
+        bool read_material(int * id) ;
+        /**
+         * @brief Lit la puissance facultative d'une lumière, qui termine la ligne
+         *
+         * @param puissance : pointeur vers la puissance lue, PUISSANCE_LUMIERE si la ligne est finie
+         * @param quoi : ce que décrit la ligne, pour le message d'erreur
+         *
+         * @return true si la fin de la ligne est correcte, false sinon (l'erreur est affichée)
+        */
+        bool read_power(float * puissance, const char * quoi) ;
+        /**
+         * @brief Lit les transformations d'une instance, jusqu'au premier mot qui n'en est pas une
+         *
+         * @param transformation : pointeur vers la transformation, composée avec celles lues
+         *
+         * @return true si les transformations sont correctes, false sinon (l'erreur est affichée)
+        */
+        bool read_transform(Transform * transformation) ;
+        /**
+         * @brief Donne le chemin d'un fichier nommé dans la scène, relatif au dossier du fichier de scène
+         *
+         * @param debut : pointeur vers le début du nom
+         * @param fin : pointeur vers la fin du nom
+         *
+         * @return Le chemin du fichier
+        */
+        std::string scene_path(const char * debut, const char * fin) const ;
+        /**
+         * @brief Vérifie qu'il ne reste rien sur la ligne
+         *
+         * @return true si la ligne est finie, false sinon (l'erreur est affichée)
+        */
+        bool end_of_line() ;
+        /**
+         * @brief Analyse une ligne du fichier
+         *
+         * @param debut : pointeur vers le premier caractère de la ligne
+         * @param fin : pointeur vers la fin de la ligne (le caractère de fin de ligne n'en fait pas partie)
+         *
+         * @return true si la ligne est correcte, false sinon (l'erreur est affichée)
+        */
+        bool parse_line(const char * debut, const char * fin) ;
+        /**
+         * @brief Libère les formes et les géométries déjà lues, après une erreur
+        */
+        void clear() ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         *
+         * @param size : le côté de l'image rendue, en pixels
+         * @param nb_threads : le nombre de threads de la lecture des maillages et de la construction des hiérarchies,
+         * 0 pour tous les coeurs
+        */
+        SceneParser(int size, int nb_threads) ;
+        /**
+         * @brief Destructeur, qui libère les formes lues si elles n'ont pas été données à une scène
+        */
+        ~SceneParser() ;
+
+        SceneParser(const SceneParser &) = delete ;
+        SceneParser & operator=(const SceneParser &) = delete ;
+
+        /**
+         * @brief Lit un fichier de scène et remplit la scène donnée
+         *
+         * @param path : référence vers le chemin du fichier
+         * @param scene : pointeur vers la scène à remplir, qui n'est modifiée que si le fichier est correct
+         *
+         * @return true si le fichier a été lu sans erreur, false sinon
+        */
+        bool parse_file(const std::string & path, Scene * scene) ;
+} ;
+
+#endif
@@ -0,0 +1,218 @@
+#include "Scenes.h"
+#include "Sphere.h"
+#include "Quad.h"
+#include "Plane.h"
+#include "TriangleMesh.h"
+#include "ShapeGroup.h"
+#include "Instance.h"
+#include "Transform.h"
+#include "SceneParser.h"
+#include "SceneCache.h"
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+
+// Ajoute les murs, le sol et le plafond de la pièce, communs à toutes les scènes
+static void build_room(int SIZE_WINDOW, std::vector<Shape*> & shapes) {
+    float rapport = SIZE_WINDOW / 900.0 ;
+
+    // Le sol, le plafond et les murs sont des plans, à 60 de chaque bord de l'image, et le fond à z = 500
+    // Les normales sont tournées vers l'intérieur de la pièce (les y vont vers le bas)
+    float bord = 60 * rapport ;
+    shapes.push_back(new Plane(Material(255.0f, 255.0f, 255.0f, 0.0f), Vector3f(0, SIZE_WINDOW - bord, 0), Vector3f(0, -1, 0))); // sol
+    shapes.push_back(new Plane(Material(255.0f, 0.0f, 0.0f, 0.0f), Vector3f(0, bord, 0), Vector3f(0, 1, 0))); // plafond
+    shapes.push_back(new Plane(Material(0.0f,255.0f,0.0f, 0.0f), Vector3f(bord, 0, 0), Vector3f(1, 0, 0))); // mur gauche
+    shapes.push_back(new Plane(Material(0.0f,0.0f,255.0f, 0.0f), Vector3f(SIZE_WINDOW - bord, 0, 0), Vector3f(-1, 0, 0))); // mur droit
+    shapes.push_back(new Plane(Material(192.0f, 192.0f, 192.0f, 0.0f), Vector3f(0, 0, 500 * rapport), Vector3f(0, 0, -1))); // mur fond
+}
+
+// La caméra et la lumière sont les mêmes pour toutes les scènes
+static void place_camera_and_light(int SIZE_WINDOW, Scene * scene) {
+    float rapport = SIZE_WINDOW / 900.0 ;
+
+    // La caméra est placé à z = -1000*rapport
+    // De ce fait, elle a assez de recul : la sphère n'est pas déformée
+    // Elle vise le centre de l'écran en z = 0, sur lequel un pixel vaut une unité
+    Vector3f position(SIZE_WINDOW/2,SIZE_WINDOW/2,-1000*rapport) ;
+    Vector3f cible(SIZE_WINDOW/2,SIZE_WINDOW/2,0) ;
+    double champ = Camera::screen_fov(SIZE_WINDOW, -position.get_z()) ;
+    scene->set_camera(Camera(position,cible,Vector3f(0,-1,0),champ,SIZE_WINDOW,SIZE_WINDOW));
+    scene->set_lights({ Light(Vector3f(SIZE_WINDOW / 2.0, 100.0f*rapport, 0.0f*rapport)) });
+}
+
+void build_default_scene(int SIZE_WINDOW, Scene * scene) {
+    // Les proportions des objets dans l'espace ont été réfléchies dans un carré de dimension 900
+    // Pour connaitre les dimensions des objets dans un espace de taille différente, on applique un rapport
+    float rapport = SIZE_WINDOW / 900.0 ;
+ 
+    std::vector<Shape*> shapes;
+
+    //-- Sphères
+    // 1ère sphère
+    Vector3f v(SIZE_WINDOW/3-25, SIZE_WINDOW/2, 60*rapport);
+    Material m(255.0f, 0.0f, 0.0f,0.0f);
+    shapes.push_back(new Sphere(m, v, 150.0f * rapport));
+    // 2ème sphère
+    Vector3f v2 (2*SIZE_WINDOW/3+25, SIZE_WINDOW/2, 400*rapport);
+    shapes.push_back(new Sphere(m, v2, 150.0f * rapport,true));
+
+    build_room(SIZE_WINDOW, shapes) ;
+
+    // -- Cube
+    Material m_cube(255.0f, 255.0f, 0.0f,0.0f);
+    Vector3f A(700.0f*rapport, 700.0f*rapport, 20.0f*rapport) ;
+    Vector3f B(100.0f*rapport, 0.0f, 0.0f) ;
+    Vector3f C(0.0f, 700.0f*rapport, 0.0f) ;
+    shapes.push_back(new Quad(m_cube, A, B, C));
+
+    scene->set_shapes(shapes) ;
+    place_camera_and_light(SIZE_WINDOW, scene) ;
+}
+
+void build_spheres_scene(int SIZE_WINDOW, int nb_spheres, Scene * scene) {
+    float rapport = SIZE_WINDOW / 900.0 ;
+
+    std::vector<Shape*> shapes;
+    build_room(SIZE_WINDOW, shapes) ;
+
+    // Les sphères remplissent le volume entre les murs, sous la lumière,
+    // plus elles sont nombreuses plus elles sont petites
+    std::mt19937 generateur(nb_spheres) ;
+    std::uniform_real_distribution<float> uniforme(0.0f, 1.0f) ;
+    float rayon = 250.0f * rapport / std::cbrt(static_cast<float>(std::max(nb_spheres, 1))) ;
+    float marge = 60.0f * rapport + rayon ;
+    float haut = 200.0f * rapport + rayon ;
+    for (int i = 0 ; i < nb_spheres ; i++) {
+        Vector3f centre(marge + uniforme(generateur) * (SIZE_WINDOW - 2 * marge),
+                        haut + uniforme(generateur) * (SIZE_WINDOW - marge - haut),
+                        rayon + uniforme(generateur) * (500.0f * rapport - 2 * rayon)) ;
+        Material m(255.0f * uniforme(generateur), 255.0f * uniforme(generateur), 255.0f * uniforme(generateur), 0.0f) ;
+        shapes.push_back(new Sphere(m, centre, rayon, i % 16 == 0)) ;
+    }
+
+    scene->set_shapes(shapes) ;
+    place_camera_and_light(SIZE_WINDOW, scene) ;
+}
+
+// Le tronc d'un arbre de hauteur 1 : un prisme à six faces, du sol (y = 0) à y = -0.4 (les y vont vers le bas)
+static std::shared_ptr<const Shape> build_trunk(int nb_threads) {
+    const int nb_cotes = 6 ;
+    const float rayon = 0.08f ;
+    std::vector<float> positions ;
+    for (int i = 0 ; i < nb_cotes ; i++) {
+        float angle = 2.0f * 3.14159265f * i / nb_cotes ;
+        for (float y : { 0.0f, -0.4f }) {
+            positions.push_back(rayon * std::cos(angle)) ;
+            positions.push_back(y) ;
+            positions.push_back(rayon * std::sin(angle)) ;
+        }
+    }
+    std::vector<int> triangles ;
+    for (int i = 0 ; i < nb_cotes ; i++) {
+        int bas = 2 * i, haut = 2 * i + 1 ;
+        int bas_suivant = 2 * ((i + 1) % nb_cotes), haut_suivant = bas_suivant + 1 ;
+        triangles.insert(triangles.end(), { bas, bas_suivant, haut, haut, bas_suivant, haut_suivant }) ;
+    }
+    return std::make_shared<TriangleMesh>(Material(), positions, std::vector<float>(), triangles, std::vector<int>(), false, nb_threads) ;
+}
+
+// Le feuillage d'un arbre de hauteur 1 : trois sphères empilées au-dessus du tronc
+static std::shared_ptr<const Shape> build_foliage(int nb_threads) {
+    std::vector<Shape*> spheres ;
+    spheres.push_back(new Sphere(Material(), Vector3f(0.0f, -0.5f, 0.0f), 0.3f)) ;
+    spheres.push_back(new Sphere(Material(), Vector3f(0.0f, -0.72f, 0.0f), 0.22f)) ;
+    spheres.push_back(new Sphere(Material(), Vector3f(0.0f, -0.88f, 0.0f), 0.12f)) ;
+    return std::make_shared<ShapeGroup>(spheres, nb_threads) ;
+}
+
+void build_forest_scene(int SIZE_WINDOW, int nb_arbres, Scene * scene) {
+    float rapport = SIZE_WINDOW / 900.0 ;
+
+    std::vector<Shape*> shapes;
+    build_room(SIZE_WINDOW, shapes) ;
+
+    // Le tronc et le feuillage ne sont rangés qu'une fois : chaque arbre n'en a que deux instances
+    std::shared_ptr<const Shape> tronc = build_trunk(scene->get_nb_threads()) ;
+    std::shared_ptr<const Shape> feuillage = build_foliage(scene->get_nb_threads()) ;
+    Material m_tronc(110.0f, 70.0f, 10.0f, 0.0f) ;
+    Material m_feuillage(40.0f, 150.0f, 15.0f, 0.0f) ;
+
+    // Les arbres couvrent le sol, plus ils sont nombreux plus ils sont petits
+    float sol = SIZE_WINDOW - 60.0f * rapport ;
+    float x_min = 80.0f * rapport, x_max = SIZE_WINDOW - 80.0f * rapport ;
+    float z_min = 0.0f, z_max = 460.0f * rapport ;
+    float espacement = std::sqrt((x_max - x_min) * (z_max - z_min) / std::max(nb_arbres, 1)) ;
+    float hauteur = std::min(3.0f * espacement, 300.0f * rapport) ;
+    std::mt19937 generateur(nb_arbres) ;
+    std::uniform_real_distribution<float> uniforme(0.0f, 1.0f) ;
+    shapes.reserve(shapes.size() + 2 * static_cast<size_t>(nb_arbres)) ;
+    for (int i = 0 ; i < nb_arbres ; i++) {
+        Vector3f pied(x_min + uniforme(generateur) * (x_max - x_min), sol, z_min + uniforme(generateur) * (z_max - z_min)) ;
+        float h = hauteur * (0.7f + 0.6f * uniforme(generateur)) ;
+        float largeur = h * (0.8f + 0.4f * uniforme(generateur)) ;
+        Transform t = Transform::translation(pied) * Transform::rotation(1, 360.0f * uniforme(generateur))
+                      * Transform::scaling(Vector3f(largeur, h, largeur)) ;
+        shapes.push_back(new Instance(m_tronc, tronc, t)) ;
+        shapes.push_back(new Instance(m_feuillage, feuillage, t)) ;
+    }
+
+    scene->set_shapes(shapes) ;
+    place_camera_and_light(SIZE_WINDOW, scene) ;
+}
+
+void build_lights_scene(int SIZE_WINDOW, int nb_lumieres, Scene * scene) {
+    float rapport = SIZE_WINDOW / 900.0 ;
+    build_default_scene(SIZE_WINDOW, scene) ;
+
+    // Les lumières sont réparties sous le plafond, avec des puissances différentes dont la somme est à peu près
+    // celle de l'unique lumière de la scène par défaut
+    std::mt19937 generateur(nb_lumieres) ;
+    std::uniform_real_distribution<float> uniforme(0.0f, 1.0f) ;
+    std::vector<Light> lights ;
+    lights.reserve(nb_lumieres) ;
+    for (int i = 0 ; i < nb_lumieres ; i++) {
+        Vector3f position((80.0f + 740.0f * uniforme(generateur)) * rapport, (80.0f + 120.0f * uniforme(generateur)) * rapport,
+                          (-200.0f + 650.0f * uniforme(generateur)) * rapport) ;
+        lights.push_back(Light(position, PUISSANCE_LUMIERE * (0.5f + uniforme(generateur)) / nb_lumieres)) ;
+    }
+    scene->set_lights(lights) ;
+}
+
+bool build_scene(const std::string & name, int size, Scene * scene) {
+    if (name == "defaut") {
+        build_default_scene(size, scene) ;
+        return true ;
+    }
+    if (name.compare(0, 8, "spheres:") == 0) {
+        int nb_spheres = std::atoi(name.c_str() + 8) ;
+        if (nb_spheres > 0) {
+            build_spheres_scene(size, nb_spheres, scene) ;
+            return true ;
+        }
+    }
+    if (name.compare(0, 6, "foret:") == 0) {
+        int nb_arbres = std::atoi(name.c_str() + 6) ;
+        if (nb_arbres > 0) {
+            build_forest_scene(size, nb_arbres, scene) ;
+            return true ;
+        }
+    }
+    if (name.compare(0, 9, "lumieres:") == 0) {
+        int nb_lumieres = std::atoi(name.c_str() + 9) ;
+        if (nb_lumieres > 0) {
+            build_lights_scene(size, nb_lumieres, scene) ;
+            return true ;
+        }
+    }
+    if (name.size() > 6 && name.compare(name.size() - 6, 6, ".scene") == 0) {
+        SceneParser parser(size, scene->get_nb_threads()) ;
+        return parser.parse_file(name, scene) ;
+    }
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".rtc") == 0) {
+        return SceneCache::load(name, size, scene) ;
+    }
+    std::cerr << "Scène inconnue : " << name << std::endl ;
+    return false ;
+}
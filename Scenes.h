@@ -0,0 +1,77 @@
+#ifndef SCENES_H
+#define SCENES_H
+
+#include "Scene.h"
+#include <string>
+
+/**
+ * @brief Remplit la scène par défaut : une pièce avec deux sphères (dont une miroir), un cube et une lumière au plafond
+ * 
+ * Les proportions des objets ont été réfléchies dans un carré de dimension 900, puis sont mises à l'échelle
+ * de la taille de l'image.
+ * 
+ * @param size : le côté de l'image, en pixels
+ * @param scene : pointeur vers la scène à remplir
+ * @see Scene
+*/
+void build_default_scene(int size, Scene * scene) ;
+
+/**
+ * @brief Remplit une scène générée : la pièce de la scène par défaut, remplie de nb_spheres petites sphères
+ * 
+ * Les sphères sont placées aléatoirement, mais toujours de la même façon pour un même nombre de sphères.
+ * Cette scène sert à mesurer le comportement du rendu avec beaucoup d'objets.
+ * 
+ * @param size : le côté de l'image, en pixels
+ * @param nb_spheres : le nombre de petites sphères
+ * @param scene : pointeur vers la scène à remplir
+ * @see Scene
+*/
+void build_spheres_scene(int size, int nb_spheres, Scene * scene) ;
+
+/**
+ * @brief Remplit une scène générée : la pièce de la scène par défaut, dont le sol est couvert de nb_arbres arbres
+ * 
+ * Le tronc (un TriangleMesh) et le feuillage (un ShapeGroup de sphères) ne sont construits qu'une fois : chaque
+ * arbre en est une paire d'Instance, avec sa position, son orientation et sa taille. La mémoire de la scène ne
+ * croît donc que de deux transformations par arbre, et elle peut en contenir des centaines de milliers.
+ * 
+ * @param size : le côté de l'image, en pixels
+ * @param nb_arbres : le nombre d'arbres
+ * @param scene : pointeur vers la scène à remplir
+ * @see Scene, Instance
+*/
+void build_forest_scene(int size, int nb_arbres, Scene * scene) ;
+
+/**
+ * @brief Remplit une scène générée : la scène par défaut, éclairée par nb_lumieres lumières au lieu d'une
+ *
+ * Les lumières sont placées aléatoirement sous le plafond, toujours de la même façon pour un même nombre, et leurs
+ * puissances sont différentes. Chaque point éclairé n'en tire qu'une (voir LightSampler) : cette scène sert à
+ * vérifier que le coût du rendu ne dépend pas du nombre de lumières.
+ *
+ * @param size : le côté de l'image, en pixels
+ * @param nb_lumieres : le nombre de lumières
+ * @param scene : pointeur vers la scène à remplir
+ * @see Scene, Light
+*/
+void build_lights_scene(int size, int nb_lumieres, Scene * scene) ;
+
+/**
+ * @brief Remplit une scène à partir de son nom
+ * 
+ * Les noms reconnus sont "defaut" pour la scène par défaut, "spheres:N" pour la scène générée avec N sphères,
+ * "foret:N" pour la scène générée avec N arbres instanciés, "lumieres:N" pour la scène par défaut éclairée par
+ * N lumières, un nom de fichier terminé par .scene pour une scène décrite dans un fichier, et un nom de fichier
+ * terminé par .rtc pour une scène déjà compilée (voir SceneCache).
+ * 
+ * @param name : référence vers le nom de la scène
+ * @param size : le côté de l'image, en pixels
+ * @param scene : pointeur vers la scène à remplir, dont get_nb_threads donne le nombre de threads du chargement
+ * @see build_default_scene, build_spheres_scene, build_forest_scene, build_lights_scene, SceneParser, SceneCache
+ * 
+ * @return true si le nom est reconnu (et le fichier correct), false sinon
+*/
+bool build_scene(const std::string & name, int size, Scene * scene) ;
+
+#endif
@@ -1,7 +1,16 @@
 #include "Sdl.h"
+#include "Trace.h"
+
+#ifndef NO_SDL
 
 
 Sdl::Sdl(int width, int height, const std::string &filename) {
+    window_ = nullptr ;
+    renderer_ = nullptr ;
+    texture_ = nullptr ;
+    width_ = width ;
+    height_ = height ;
+
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         std::cerr << "Erreur d'initialisation de la SDL : " << SDL_GetError() << std::endl ;
         return ;
@@ -18,9 +27,19 @@ Sdl::Sdl(int width, int height, const std::string &filename) {
         std::cerr << "Erreur lors de la création du rendu SDL : " << SDL_GetError() << std::endl ;
         return ;
     }
+
+    texture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, width, height) ;
+    if (!texture_) {
+        std::cerr << "Erreur lors de la création de la texture SDL : " << SDL_GetError() << std::endl ;
+        return ;
+    }
 }
 
 Sdl::~Sdl() {
+    // On détruit la texture
+    if (texture_) {
+        SDL_DestroyTexture(texture_) ;
+    }
     // On détruit le rendu
     if (renderer_) {
         SDL_DestroyRenderer(renderer_) ;
@@ -33,5 +52,16 @@ Sdl::~Sdl() {
 }
 
 bool Sdl::isValid() const {
-    return window_ != nullptr && renderer_ != nullptr ;
-}
\ No newline at end of file
+    return window_ != nullptr && renderer_ != nullptr && texture_ != nullptr ;
+}
+
+void Sdl::display(const std::vector<unsigned char> & rgb) {
+    RT_TRACE("affichage SDL") ;
+    // Un seul envoi pour toute l'image, au lieu d'un appel de dessin par pixel
+    SDL_UpdateTexture(texture_, nullptr, rgb.data(), 3 * width_) ;
+    SDL_RenderClear(renderer_) ;
+    SDL_RenderCopy(renderer_, texture_, nullptr, nullptr) ;
+    SDL_RenderPresent(renderer_) ;
+}
+
+#endif
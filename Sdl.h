@@ -1,9 +1,14 @@
 #ifndef SDL_H
 #define SDL_H
 
+// Sans SDL (compilation avec -DNO_SDL), seul le rendu hors-ligne est disponible
+#ifndef NO_SDL
+
 #include <SDL2/SDL.h>
 #include "Vector3f.h"
 #include <iostream>
+#include <string>
+#include <vector>
 
 /**
  * @brief La classe Sdl permet d'avoir des raccourcis dans le code quand on utilise 
@@ -23,6 +28,18 @@ class Sdl {
          * @brief Le renderer dans lequel on va dessiner la scène
         */
         SDL_Renderer* renderer_;
+        /**
+         * @brief La texture de la taille de la fenêtre, dans laquelle on envoie l'image en une fois
+        */
+        SDL_Texture* texture_;
+        /**
+         * @brief La largeur de la fenêtre et de la texture
+        */
+        int width_;
+        /**
+         * @brief La hauteur de la fenêtre et de la texture
+        */
+        int height_;
 
     public:
 
@@ -65,8 +82,18 @@ class Sdl {
          * @return true si les attributs sont bien instanciés, false sinon
         */
         bool isValid() const ;
+
+        /**
+         * @brief Affiche une image dans la fenêtre
+         * 
+         * L'image est envoyée en un seul appel dans une texture de streaming, qui est ensuite copiée dans la fenêtre.
+         * 
+         * @param rgb : référence vers les pixels 8 bits (r, g, b) de l'image, ligne par ligne, de la taille de la fenêtre
+         * @see Framebuffer::to_rgb8
+        */
+        void display(const std::vector<unsigned char> & rgb) ;
 };
 
 #endif
 
-
+#endif
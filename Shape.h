@@ -3,9 +3,51 @@
 
 #include "Material.h"
 #include "Ray3f.h"
+#include "BoundingBox.h"
 #include <cmath>
 #include <ostream>
 
+/**
+ * @brief Le résultat compact d'un test d'intersection
+ * 
+ * Pendant le parcours de la scène, on ne garde que la distance et l'identifiant de l'objet touché.
+ * Le point d'intersection et la normale sont calculés ensuite, une seule fois, par Shape::finalize_hit.
+*/
+struct HitRecord {
+    /**
+     * @brief La valeur de t au point d'intersection
+    */
+    float t_ ;
+    /**
+     * @brief L'indice dans Scene::shapes_ de la forme touchée, -1 si inconnu
+    */
+    int shape_id_ ;
+    /**
+     * @brief L'indice de la partie touchée à l'intérieur de la forme (0 pour une forme simple), -1 s'il n'y a pas d'intersection
+    */
+    int primitive_ ;
+
+    /**
+     * @brief Permet de savoir s'il y a eu une intersection
+     * 
+     * @return true s'il y a intersection, false sinon
+    */
+    bool hit() const { return primitive_ >= 0 ; }
+} ;
+
+/**
+ * @brief Le HitRecord qui représente l'absence d'intersection
+ * 
+ * @return Un HitRecord sans intersection, à une distance infinie
+*/
+inline HitRecord no_hit() {
+    HitRecord h ;
+    h.t_ = 1E10f ;
+    h.shape_id_ = -1 ;
+    h.primitive_ = -1 ;
+    return h ;
+}
+
 /**
  * @brief La classe Shape est la classe mère des classes Quad et Sphere
  * 
@@ -46,6 +88,10 @@ class Shape {
          * @see Material
         */
         Shape (Material matter, bool miroir); 
+        /**
+         * @brief Destructeur virtuel, pour qu'une forme détruite par un pointeur Shape* le soit entièrement
+        */
+        virtual ~Shape() {}
 
         /**
          * @brief Getter de l'attribut matter_
@@ -70,20 +116,45 @@ class Shape {
         /**
          * @brief Vérifie si le rayon intersecte la forme
          * 
-         * La fonction permet aussi de récupérer le point P d'intersection du rayon, la normale N
-         * à ce point et la valeur de t à ce point.
+         * La fonction ne calcule que la valeur de t à l'intersection : c'est ce qui suffit pendant le parcours
+         * de la scène pour trouver l'objet le plus proche. Le point d'intersection et la normale ne sont calculés
+         * qu'une fois, pour l'objet le plus proche, par finalize_hit.
          * Méthode virtuelle à implémenter dans les classes filles
          * @see Sphere, Quad
          * 
-         * @param ray : le rayon avec lequel on veut voir s'il y a intersection
+         * @param ray : référence vers le rayon avec lequel on veut voir s'il y a intersection
+         * @see Ray3f
+         * 
+         * @return Le HitRecord de l'intersection, dont primitive_ vaut -1 s'il n'y a pas d'intersection
+         * @see HitRecord
+        */
+        virtual HitRecord is_hit (const Ray3f & ray) const = 0 ;
+
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par is_hit
+         * 
+         * Méthode virtuelle à implémenter dans les classes filles
+         * @see Sphere, Quad
+         * 
+         * @param ray : référence vers le rayon qui a donné l'intersection
+         * @param hit : référence vers le HitRecord renvoyé par is_hit pour ce rayon
          * @param P : pointeur vers le point d'intersection entre le rayon et la forme
-         * @param N : pointeur vers la normale associé au point P
-         * @param t : pointeur vers la valeur de t au point P
-         * @see Vector3f, Ray3f
+         * @param N : pointeur vers la normale (unitaire) associée au point P
+         * @see Vector3f, Ray3f, HitRecord
+        */
+        virtual void finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const = 0 ;
+
+        /**
+         * @brief Donne la boîte englobante de la forme, alignée sur les axes
+         * 
+         * Elle sert à construire la hiérarchie de volumes englobants de la scène.
+         * Méthode virtuelle à implémenter dans les classes filles
+         * @see Sphere, Quad, Bvh
          * 
-         * @return 1 s'il y a intersection, 0 sinon
+         * @return La plus petite boîte alignée sur les axes qui contient la forme
+         * @see BoundingBox
         */
-        virtual int is_hit (Ray3f ray,Vector3f * P, Vector3f *N,float * t) = 0 ;
+        virtual BoundingBox bounding_box() const = 0 ;
 
 } ;
 
@@ -0,0 +1,48 @@
+#include "ShapeGroup.h"
+#include <utility>
+
+ShapeGroup::ShapeGroup(std::vector<Shape*> shapes, int nb_threads) {
+    shapes_ = std::move(shapes) ;
+    // Comme pour la scène, les plans du groupe sont rangés après les autres formes et restent hors du Bvh
+    CompiledScene::move_planes_to_end(shapes_) ;
+    bvh_.build(CompiledScene::bounded_boxes(shapes_), nb_threads) ;
+    compiled_.build(shapes_, bvh_) ;
+}
+
+ShapeGroup::~ShapeGroup() {
+    for (Shape* shape : shapes_) {
+        delete shape ;
+    }
+}
+
+HitRecord ShapeGroup::is_hit(const Ray3f & ray) const {
+    HitRecord closest = no_hit() ;
+    compiled_.intersect_planes(ray, &closest) ;
+    bvh_.traverse(ray, closest.t_, [&](int first, int count, float & t_max) {
+        compiled_.intersect(ray, first, count, &closest) ;
+        t_max = closest.t_ ;
+        return false ;
+    }) ;
+    if (closest.hit()) {
+        // shape_id_ sera remplacé par l'indice du groupe dans la scène : la forme touchée passe dans primitive_
+        closest.primitive_ = closest.primitive_ * static_cast<int>(shapes_.size()) + closest.shape_id_ ;
+    }
+    return closest ;
+}
+
+void ShapeGroup::finalize_hit(const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const {
+    int nb_formes = static_cast<int>(shapes_.size()) ;
+    HitRecord interne = hit ;
+    interne.shape_id_ = hit.primitive_ % nb_formes ;
+    interne.primitive_ = hit.primitive_ / nb_formes ;
+    compiled_.finalize_hit(ray, interne, P, N) ;
+}
+
+BoundingBox ShapeGroup::bounding_box() const {
+    return bvh_.get_bounds() ;
+}
+
+std::ostream & operator << (std::ostream & st, const ShapeGroup & g) {
+    st << "ShapeGroup : [ shapes : " << g.get_shapes().size() << " ]" ;
+    return st ;
+}
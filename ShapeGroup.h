@@ -0,0 +1,110 @@
+#ifndef SHAPEGROUP_H
+#define SHAPEGROUP_H
+
+#include "Shape.h"
+#include "Bvh.h"
+#include "CompiledScene.h"
+#include "BoundingBox.h"
+#include "Vector3f.h"
+#include "Material.h"
+#include "Ray3f.h"
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief La classe ShapeGroup est une petite scène, vue de l'extérieur comme une seule forme
+ *
+ * Le groupe a son propre Bvh et sa propre CompiledScene sur ses formes, comme Scene : il sert de géométrie
+ * partagée à des Instance, pour placer plusieurs fois un assemblage de sphères, de pavés et de maillages.
+ * Le matériel utilisé est celui de la forme qui contient le groupe (l'instance), pas celui des formes du groupe.
+ *
+ * @see Instance, Scene
+*/
+class ShapeGroup : public Shape {
+    private :
+        /**
+         * @brief Les formes du groupe, libérées avec lui
+        */
+        std::vector<Shape*> shapes_ ;
+        /**
+         * @brief La hiérarchie de volumes englobants des formes
+        */
+        Bvh bvh_ ;
+        /**
+         * @brief Les formes rangées par type dans l'ordre des feuilles de bvh_
+        */
+        CompiledScene compiled_ ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré, construit la hiérarchie des formes
+         *
+         * Comme dans Scene, les plans sont déplacés après les autres formes de shapes_ et restent hors de bvh_.
+         *
+         * @param shapes : les formes du groupe, dont le groupe devient propriétaire
+         * @param nb_threads : le nombre de threads de la construction de la hiérarchie, 0 pour tous les coeurs
+        */
+        ShapeGroup(std::vector<Shape*> shapes, int nb_threads) ;
+        /**
+         * @brief Destructeur, libère les formes du groupe
+        */
+        ~ShapeGroup() ;
+
+        ShapeGroup(const ShapeGroup &) = delete ;
+        ShapeGroup & operator= (const ShapeGroup &) = delete ;
+
+        /**
+         * @brief Getter de l'attribut shapes_
+         *
+         * @return Référence vers l'attribut shapes_ de la classe
+        */
+        const std::vector<Shape*> & get_shapes() const { return shapes_ ; }
+
+        /**
+         * @brief Cherche l'intersection la plus proche avec les formes du groupe
+         *
+         * La forme touchée est gardée dans primitive_, avec la partie touchée de cette forme :
+         * primitive_ = partie * nombre de formes + indice de la forme dans shapes_. Le produit doit tenir dans un int.
+         *
+         * @param ray : référence vers le rayon
+         *
+         * @return Le HitRecord de l'intersection, primitive_ à -1 s'il n'y en a pas
+         * @see HitRecord
+        */
+        HitRecord is_hit (const Ray3f & ray) const ;
+
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par is_hit
+         *
+         * La forme touchée et sa partie sont relues dans primitive_, sans relancer le rayon dans le groupe.
+         *
+         * @param ray : référence vers le rayon qui a donné l'intersection
+         * @param hit : référence vers le HitRecord renvoyé par is_hit pour ce rayon
+         * @param P : pointeur vers le point d'intersection
+         * @param N : pointeur vers la normale (unitaire) associée au point P
+         * @see HitRecord
+        */
+        void finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const ;
+
+        /**
+         * @brief Donne la boîte englobante du groupe
+         *
+         * @return La boîte de la racine de bvh_
+         * @see BoundingBox
+        */
+        BoundingBox bounding_box() const ;
+} ;
+
+/**
+ * @brief L'opérateur << pour afficher les informations du groupe
+ *
+ * Affiche : ShapeGroup : [ shapes : nombre de formes ]
+ *
+ * @param st : le flux sur lequel on veut afficher le groupe
+ * @param g : référence du groupe dont on veut afficher les informations
+ *
+ * @return la référence vers le flux modifié
+*/
+std::ostream & operator << (std::ostream & st, const ShapeGroup & g) ;
+
+#endif
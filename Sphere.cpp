@@ -2,7 +2,6 @@
 #include "Vector3f.h"
 #include "Material.h"
 #include "Sphere.h"
-#include "Sdl.h"
 #include <cmath>
 #include <ostream>
 
@@ -26,7 +25,8 @@ Sphere::Sphere(const Sphere &s) : Shape(s) {
     radius_ = s.get_radius();
 }
 
-int Sphere::is_hit (Ray3f ray, Vector3f * P, Vector3f * N, float * t) {
+HitRecord Sphere::is_hit (const Ray3f & ray) const {
+    HitRecord hit = no_hit() ;
 
     // On résout le polynôme de second degré qui représente l'intersection
     // entre un rayon et une sphère
@@ -43,32 +43,36 @@ int Sphere::is_hit (Ray3f ray, Vector3f * P, Vector3f * N, float * t) {
 
     // Si discriminant négatif, pas de solution réelle, donc pas de solution
     if (discriminant < 0.0f){
-        return 0 ;
+        return hit ;
     }
     // Si discriminant positif, solution réelle
     float t1 = (-b - std::sqrt(discriminant)) / (2.0 * a);
     float t2 = (-b + std::sqrt(discriminant)) / (2.0 * a);
     // Si t2 négatif (donc t1 aussi), intersection derrière
     if (t2 < 0.0f){
-        return 0 ;
+        return hit ;
+    }
+    // Intersection ok, on garde la plus proche devant le rayon
+    if (t1 > 0.0f){
+        hit.t_ = t1 ;
     }
-    // Intersection ok,
-    // On récupère aussi la normale à la sphère et le point d'intersection
-    // Le plus proche -> utile au modèle d'éclairage lamberien
     else {
-        if (t1 > 0.0f){
-            *t = t1 ;
-        }
-        else {
-            *t = t2 ;
-        }
+        hit.t_ = t2 ;
+    }
+    hit.primitive_ = 0 ;
+    return hit ;
+}
 
-        *P = ray.get_centre() + *t*ray.get_direction() ;
-        *N = (*P - origin_) ;
-        N->normalize() ;
+void Sphere::finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const {
+    // On récupère la normale à la sphère et le point d'intersection
+    // Le plus proche -> utile au modèle d'éclairage lamberien
+    *P = ray.get_centre() + hit.t_*ray.get_direction() ;
+    *N = (*P - origin_) ;
+    N->normalize() ;
+}
 
-        return 1 ;
-    }
+BoundingBox Sphere::bounding_box() const {
+    return BoundingBox(origin_ - Vector3f(radius_), origin_ + Vector3f(radius_)) ;
 }
 
 std::ostream & operator << (std::ostream & st, const Sphere & s) {
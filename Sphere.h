@@ -4,7 +4,6 @@
 #include "Shape.h"
 #include "Vector3f.h"
 #include "Material.h"
-#include "Sdl.h"
 #include "Ray3f.h"
 #include <cmath>
 #include <ostream>
@@ -101,20 +100,39 @@ class Sphere : public Shape{
         /**
          * @brief Vérifie si le rayon intersecte la sphère
          * 
-         * La fonction permet aussi de récupérer le point P d'intersection du rayon, la normale N
-         * à ce point et la valeur de t à ce point.
+         * La fonction ne calcule que la valeur de t à l'intersection la plus proche devant le rayon.
          * Une fonction du même nom existe aussi pour les Quad
          * @see Quad
          * 
-         * @param ray : le rayon avec lequel on veut voir s'il y a intersection
+         * @param ray : référence vers le rayon avec lequel on veut voir s'il y a intersection
+         * @see Ray3f
+         * 
+         * @return Le HitRecord de l'intersection, dont primitive_ vaut -1 s'il n'y a pas d'intersection
+         * @see HitRecord
+        */
+        HitRecord is_hit (const Ray3f & ray) const ;
+
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par is_hit
+         * 
+         * @param ray : référence vers le rayon qui a donné l'intersection
+         * @param hit : référence vers le HitRecord renvoyé par is_hit pour ce rayon
          * @param P : pointeur vers le point d'intersection entre le rayon et la sphère
-         * @param N : pointeur vers la normale associé au point P
-         * @param t : pointeur vers la valeur de t au point P
-         * @see Vector3f, Ray3f
+         * @param N : pointeur vers la normale (unitaire) associée au point P
+         * @see Vector3f, Ray3f, HitRecord
+        */
+        void finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const ;
+
+        /**
+         * @brief Donne la boîte englobante de la sphère
          * 
-         * @return 1 s'il y a intersection, 0 sinon
+         * C'est le cube de centre origin_ et de demi-côté radius_
+         * 
+         * @return La boîte englobante de la sphère
+         * @see BoundingBox
         */
-        int is_hit (Ray3f ray,Vector3f * P, Vector3f * N, float * t) ;
+        BoundingBox bounding_box() const ;
+
 } ;
 
 /**
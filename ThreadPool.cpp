@@ -0,0 +1,123 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int nb_threads) {
+    if (nb_threads <= 0) {
+        nb_threads = static_cast<int>(std::thread::hardware_concurrency()) ;
+        if (nb_threads <= 0) {
+            nb_threads = 1 ;
+        }
+    }
+    job_ = nullptr ;
+    generation_ = 0 ;
+    busy_ = 0 ;
+    stop_ = false ;
+
+    for (int i = 0 ; i < nb_threads ; i++) {
+        queues_.push_back(std::unique_ptr<Queue>(new Queue())) ;
+    }
+    // Le thread 0 est le thread appelant, on ne crée donc que les autres
+    for (int i = 1 ; i < nb_threads ; i++) {
+        threads_.push_back(std::thread(&ThreadPool::worker_loop, this, i)) ;
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_) ;
+        stop_ = true ;
+    }
+    start_.notify_all() ;
+    for (std::thread & thread : threads_) {
+        thread.join() ;
+    }
+}
+
+void ThreadPool::worker_loop(int id) {
+    unsigned long seen = 0 ;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_) ;
+            start_.wait(lock, [&] { return stop_ || generation_ != seen ; }) ;
+            if (stop_) {
+                return ;
+            }
+            seen = generation_ ;
+        }
+
+        execute(id) ;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_) ;
+            busy_-- ;
+            if (busy_ == 0) {
+                done_.notify_one() ;
+            }
+        }
+    }
+}
+
+bool ThreadPool::next_task(int id, int * task) {
+    // On dépile d'abord par la fin de sa propre file (tâches les plus "chaudes" en cache)
+    {
+        Queue & own = *queues_[id] ;
+        std::lock_guard<std::mutex> lock(own.mutex_) ;
+        if (!own.tasks_.empty()) {
+            *task = own.tasks_.back() ;
+            own.tasks_.pop_back() ;
+            return true ;
+        }
+    }
+    // Sinon on vole par le début de la file des autres threads
+    int nb_queues = static_cast<int>(queues_.size()) ;
+    for (int k = 1 ; k < nb_queues ; k++) {
+        Queue & victim = *queues_[(id + k) % nb_queues] ;
+        std::lock_guard<std::mutex> lock(victim.mutex_) ;
+        if (!victim.tasks_.empty()) {
+            *task = victim.tasks_.front() ;
+            victim.tasks_.pop_front() ;
+            return true ;
+        }
+    }
+    return false ;
+}
+
+void ThreadPool::execute(int id) {
+    // Aucune tâche n'est ajoutée pendant un lot : si toutes les files sont vides, le lot est fini pour ce thread
+    int task ;
+    while (next_task(id, &task)) {
+        (*job_)(task) ;
+    }
+}
+
+void ThreadPool::parallel_for(int nb_tasks, const std::function<void(int)> & job) {
+    if (nb_tasks <= 0) {
+        return ;
+    }
+
+    // Répartition par blocs contigus : les tâches voisines (ex : tuiles voisines) restent sur le même thread
+    int nb_queues = get_nb_threads() ;
+    for (int q = 0 ; q < nb_queues ; q++) {
+        int begin = static_cast<int>(static_cast<long>(nb_tasks) * q / nb_queues) ;
+        int end = static_cast<int>(static_cast<long>(nb_tasks) * (q + 1) / nb_queues) ;
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex_) ;
+        // On empile à l'envers pour que le thread dépile (par la fin) son bloc dans l'ordre
+        for (int i = end - 1 ; i >= begin ; i--) {
+            queues_[q]->tasks_.push_back(i) ;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_) ;
+        job_ = &job ;
+        busy_ = static_cast<int>(threads_.size()) ;
+        generation_++ ;
+    }
+    start_.notify_all() ;
+
+    // Le thread appelant travaille aussi
+    execute(0) ;
+
+    std::unique_lock<std::mutex> lock(mutex_) ;
+    done_.wait(lock, [&] { return busy_ == 0 ; }) ;
+    job_ = nullptr ;
+}
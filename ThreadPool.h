@@ -0,0 +1,132 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief La classe ThreadPool est un ensemble de threads de calcul avec vol de tâches (work stealing)
+ *
+ * Chaque thread possède sa propre file de tâches. Il dépile ses tâches par la fin de sa file,
+ * et quand elle est vide, il vole des tâches au début de la file des autres threads.
+ * Ainsi, les threads qui ont des tâches rapides (ex : des tuiles dans le vide) aident
+ * ceux qui ont des tâches coûteuses, sans coordination centrale.
+ *
+ * Les threads sont créés une seule fois, à la construction, et réutilisés à chaque appel
+ * de parallel_for. Le thread appelant participe aussi au calcul.
+*/
+class ThreadPool {
+    private :
+        /**
+         * @brief La file de tâches d'un thread, protégée par son propre mutex
+        */
+        struct Queue {
+            std::mutex mutex_ ;
+            std::deque<int> tasks_ ;
+        } ;
+
+        /**
+         * @brief Les threads de calcul (le thread appelant étant le thread 0, il n'y en a que nb_threads - 1)
+        */
+        std::vector<std::thread> threads_ ;
+        /**
+         * @brief Les files de tâches, une par thread (thread appelant compris)
+        */
+        std::vector<std::unique_ptr<Queue>> queues_ ;
+
+        /**
+         * @brief Mutex qui protège job_, generation_, busy_ et stop_
+        */
+        std::mutex mutex_ ;
+        /**
+         * @brief Réveille les threads quand un nouveau lot de tâches est disponible
+        */
+        std::condition_variable start_ ;
+        /**
+         * @brief Réveille le thread appelant quand tous les threads ont fini le lot
+        */
+        std::condition_variable done_ ;
+        /**
+         * @brief La fonction à exécuter pour chaque tâche du lot en cours
+        */
+        const std::function<void(int)> * job_ ;
+        /**
+         * @brief Numéro du lot en cours, permet aux threads de savoir qu'un nouveau lot est arrivé
+        */
+        unsigned long generation_ ;
+        /**
+         * @brief Nombre de threads qui travaillent encore sur le lot en cours
+        */
+        int busy_ ;
+        /**
+         * @brief Passe à true à la destruction pour arrêter les threads
+        */
+        bool stop_ ;
+
+        /**
+         * @brief Boucle principale d'un thread de calcul
+         *
+         * @param id : l'indice du thread, et donc de sa file de tâches
+        */
+        void worker_loop(int id) ;
+        /**
+         * @brief Exécute des tâches jusqu'à ce que toutes les files soient vides
+         *
+         * Le thread commence par sa propre file, puis vole les tâches des autres threads.
+         *
+         * @param id : l'indice du thread
+        */
+        void execute(int id) ;
+        /**
+         * @brief Récupère une tâche, d'abord dans la file du thread, sinon dans celle des autres
+         *
+         * @param id : l'indice du thread
+         * @param task : pointeur vers la tâche récupérée
+         *
+         * @return true si une tâche a été trouvée, false si toutes les files sont vides
+        */
+        bool next_task(int id, int * task) ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         *
+         * Crée le pool avec le nombre de threads donné. Si nb_threads vaut 0 (ou moins),
+         * on prend le nombre de coeurs de la machine.
+         *
+         * @param nb_threads : le nombre de threads voulu, thread appelant compris
+        */
+        explicit ThreadPool(int nb_threads = 0) ;
+        /**
+         * @brief Le destructeur de la classe ThreadPool, il arrête et attend tous les threads
+        */
+        ~ThreadPool() ;
+
+        ThreadPool(const ThreadPool &) = delete ;
+        ThreadPool & operator=(const ThreadPool &) = delete ;
+
+        /**
+         * @brief Donne le nombre de threads du pool, thread appelant compris
+         *
+         * @return Le nombre de threads
+        */
+        int get_nb_threads() const { return static_cast<int>(queues_.size()) ; }
+
+        /**
+         * @brief Exécute job(i) pour tout i dans [0, nb_tasks[ et attend la fin de toutes les tâches
+         *
+         * Les tâches sont réparties par blocs contigus entre les files des threads, puis
+         * équilibrées par vol de tâches. L'ordre d'exécution n'est pas garanti.
+         *
+         * @param nb_tasks : le nombre de tâches
+         * @param job : la fonction à appeler pour chaque tâche
+        */
+        void parallel_for(int nb_tasks, const std::function<void(int)> & job) ;
+} ;
+
+#endif
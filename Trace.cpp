@@ -0,0 +1,147 @@
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+// Nombre de zones gardées par tampon : au-delà, les plus anciennes sont écrasées
+const int TAILLE_TAMPON_TRACE = 1 << 16 ;
+// Nombre de zones d'un bloc : un thread qui note peu de zones n'alloue qu'un bloc de 24 Ko
+const int TAILLE_BLOC_TRACE = 1 << 10 ;
+
+// Les tampons de tous les threads qui ont enregistré une zone. Ils ne sont jamais détruits : les zones
+// d'un thread de calcul restent disponibles après la destruction de son ThreadPool
+static std::mutex & buffers_mutex() {
+    static std::mutex mutex ;
+    return mutex ;
+}
+
+static std::vector<std::unique_ptr<TraceBuffer>> & buffers() {
+    static std::vector<std::unique_ptr<TraceBuffer>> tampons ;
+    return tampons ;
+}
+
+// Les tampons des threads terminés, que les nouveaux threads reprennent au lieu d'en créer un
+static std::vector<TraceBuffer *> & free_buffers() {
+    static std::vector<TraceBuffer *> libres ;
+    return libres ;
+}
+
+// Le tampon d'un thread, rendu à free_buffers à la fin du thread
+struct TamponThread {
+    TraceBuffer * tampon_ = nullptr ;
+    ~TamponThread() {
+        if (tampon_ != nullptr) {
+            std::lock_guard<std::mutex> verrou(buffers_mutex()) ;
+            free_buffers().push_back(tampon_) ;
+        }
+    }
+} ;
+
+// La date de trace_start, en nanosecondes de steady_clock
+static std::atomic<int64_t> origine(0) ;
+
+static int64_t clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() ;
+}
+
+TraceBuffer::TraceBuffer(int tid) : tid_(tid), blocs_(TAILLE_TAMPON_TRACE / TAILLE_BLOC_TRACE), count_(0) {}
+
+void TraceBuffer::push(const TraceEvent & event) {
+    // Seul le thread propriétaire écrit : la zone est rangée, son bloc alloué au besoin, puis elle est publiée en
+    // avançant le compteur. Les blocs ne bougent plus une fois alloués
+    uint64_t n = count_.load(std::memory_order_relaxed) ;
+    size_t i = n % TAILLE_TAMPON_TRACE ;
+    std::unique_ptr<TraceEvent[]> & bloc = blocs_[i / TAILLE_BLOC_TRACE] ;
+    if (!bloc) {
+        bloc.reset(new TraceEvent[TAILLE_BLOC_TRACE]) ;
+    }
+    bloc[i % TAILLE_BLOC_TRACE] = event ;
+    count_.store(n + 1, std::memory_order_release) ;
+}
+
+void TraceBuffer::copy(std::vector<TraceEvent> & events) const {
+    uint64_t n = count_.load(std::memory_order_acquire) ;
+    uint64_t premier = (n > static_cast<uint64_t>(TAILLE_TAMPON_TRACE)) ? n - TAILLE_TAMPON_TRACE : 0 ;
+    for (uint64_t k = premier ; k < n ; k++) {
+        size_t i = k % TAILLE_TAMPON_TRACE ;
+        events.push_back(blocs_[i / TAILLE_BLOC_TRACE][i % TAILLE_BLOC_TRACE]) ;
+    }
+}
+
+size_t TraceBuffer::get_memory() const {
+    uint64_t n = count_.load(std::memory_order_acquire) ;
+    uint64_t nb_blocs = (std::min(n, static_cast<uint64_t>(TAILLE_TAMPON_TRACE)) + TAILLE_BLOC_TRACE - 1) / TAILLE_BLOC_TRACE ;
+    return static_cast<size_t>(nb_blocs) * TAILLE_BLOC_TRACE * sizeof(TraceEvent) ;
+}
+
+void trace_start() {
+    origine.store(clock_ns(), std::memory_order_relaxed) ;
+    trace_flag().store(true, std::memory_order_relaxed) ;
+    // Le thread qui lance l'enregistrement est le thread 0 de la frise
+    thread_trace_buffer() ;
+}
+
+int64_t trace_now() {
+    return clock_ns() - origine.load(std::memory_order_relaxed) ;
+}
+
+TraceBuffer & thread_trace_buffer() {
+    thread_local TamponThread thread ;
+    if (thread.tampon_ == nullptr) {
+        std::lock_guard<std::mutex> verrou(buffers_mutex()) ;
+        // Le tampon d'un thread terminé garde ses zones et son numéro : le nouveau thread continue sa ligne de la frise
+        if (!free_buffers().empty()) {
+            thread.tampon_ = free_buffers().back() ;
+            free_buffers().pop_back() ;
+        }
+        else {
+            buffers().push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(static_cast<int>(buffers().size())))) ;
+            thread.tampon_ = buffers().back().get() ;
+        }
+    }
+    return *thread.tampon_ ;
+}
+
+bool trace_save(const std::string & filename) {
+    std::ofstream out(filename) ;
+    if (!out) {
+        std::cerr << "Impossible de créer le fichier " << filename << std::endl ;
+        return false ;
+    }
+
+    std::lock_guard<std::mutex> verrou(buffers_mutex()) ;
+    // Les dates sont en microsecondes, à la nanoseconde près
+    out << std::fixed << std::setprecision(3) ;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl ;
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Raytracing\"}}" ;
+    std::vector<TraceEvent> events ;
+    size_t nb_zones = 0 ;
+    size_t memoire = 0 ;
+    for (const std::unique_ptr<TraceBuffer> & tampon : buffers()) {
+        int tid = tampon->get_tid() ;
+        std::string nom = (tid == 0) ? std::string("principal") : "calcul " + std::to_string(tid) ;
+        out << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":\"" << nom << "\"}}" ;
+
+        events.clear() ;
+        tampon->copy(events) ;
+        for (const TraceEvent & event : events) {
+            out << "," << std::endl << "{\"name\":\"" << event.name_ << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << event.start_ / 1000.0 << ",\"dur\":" << event.duration_ / 1000.0 << "}" ;
+        }
+        nb_zones += events.size() ;
+        memoire += tampon->get_memory() ;
+    }
+    out << std::endl << "]}" << std::endl ;
+    if (!out) {
+        std::cerr << "Erreur d'écriture du fichier " << filename << std::endl ;
+        return false ;
+    }
+    std::cout << "Frise " << filename << " : " << nb_zones << " zones sur " << buffers().size() << " threads ("
+              << memoire / 1024 << " Ko de tampons)" << std::endl ;
+    return true ;
+}
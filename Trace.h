@@ -0,0 +1,173 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/**
+ * Zones de temps, pour voir sur une frise ce que fait chaque thread : chargement de la scène, construction du Bvh,
+ * tuiles, étapes du wavefront, correction gamma, encodage de l'image, affichage SDL.
+ *
+ * Une zone est une variable locale (RT_TRACE("nom")) qui note son début et sa fin. Les zones sont toujours
+ * compilées, mais ne notent rien tant que trace_start n'a pas été appelé : une zone coûte alors une lecture
+ * atomique et un test. Elles sont placées sur des étapes (une tuile, un lot de rayons), jamais sur un rayon.
+ *
+ * Chaque thread écrit ses zones dans son propre tampon circulaire, sans verrou : seuls le premier enregistrement
+ * d'un thread et sa fin prennent un mutex. Un tampon est alloué par blocs, au fur et à mesure des zones ; quand il
+ * est plein, les zones les plus anciennes sont écrasées. À la fin d'un thread, son tampon est rendu, avec ses
+ * zones, et repris par le prochain thread qui enregistre une zone : il y a autant de tampons que de threads vivants
+ * à la fois, pas un par thread créé depuis le lancement. trace_save écrit toutes les zones au format Trace Event
+ * de Chrome (chrome://tracing ou Perfetto).
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Une zone terminée : son nom et ses dates, en nanosecondes depuis trace_start
+*/
+struct TraceEvent {
+    const char * name_ ;
+    int64_t start_ ;
+    int64_t duration_ ;
+} ;
+
+/**
+ * @brief Le tampon circulaire des zones d'un thread, écrit par ce seul thread
+*/
+class TraceBuffer {
+    private :
+        /**
+         * @brief Le numéro du thread dans la frise
+        */
+        int tid_ ;
+        /**
+         * @brief Les zones, rangées modulo la capacité du tampon, par blocs alloués à leur première zone
+        */
+        std::vector<std::unique_ptr<TraceEvent[]>> blocs_ ;
+        /**
+         * @brief Le nombre de zones écrites depuis la création du tampon, publié après l'écriture de chaque zone
+         * (et l'allocation de son bloc)
+        */
+        std::atomic<uint64_t> count_ ;
+
+    public :
+        /**
+         * @brief Constructeur d'un tampon vide
+         *
+         * @param tid : le numéro du thread dans la frise
+        */
+        explicit TraceBuffer(int tid) ;
+
+        /**
+         * @brief Ajoute une zone terminée, en écrasant la plus ancienne si le tampon est plein
+         *
+         * @param event : référence vers la zone
+        */
+        void push(const TraceEvent & event) ;
+        /**
+         * @brief Copie les zones encore présentes dans le tampon, de la plus ancienne à la plus récente
+         *
+         * @param events : référence vers le vecteur qui reçoit les zones
+        */
+        void copy(std::vector<TraceEvent> & events) const ;
+
+        /**
+         * @brief Donne la mémoire allouée pour les zones
+         *
+         * @return Le nombre d'octets des blocs alloués
+        */
+        size_t get_memory() const ;
+
+        /**
+         * @brief Getter de l'attribut tid_
+         *
+         * @return L'attribut tid_ de la classe
+        */
+        int get_tid() const { return tid_ ; }
+} ;
+
+/**
+ * @brief Donne l'indicateur d'enregistrement des zones
+ *
+ * @return Référence vers l'indicateur, partagé par tous les threads
+*/
+inline std::atomic<bool> & trace_flag() {
+    static std::atomic<bool> enabled(false) ;
+    return enabled ;
+}
+
+/**
+ * @brief Indique si les zones sont enregistrées
+ *
+ * @return true après trace_start, false sinon
+*/
+inline bool trace_enabled() {
+    return trace_flag().load(std::memory_order_relaxed) ;
+}
+
+/**
+ * @brief Commence l'enregistrement des zones : les dates de la frise partent de cet appel
+*/
+void trace_start() ;
+
+/**
+ * @brief Donne la date actuelle de la frise
+ *
+ * @return Le temps écoulé depuis trace_start, en nanosecondes
+*/
+int64_t trace_now() ;
+
+/**
+ * @brief Donne le tampon du thread appelant, pris à son premier appel parmi ceux des threads terminés, ou créé
+ * et inscrit s'il n'y en a pas
+ *
+ * @return Référence vers le tampon du thread
+*/
+TraceBuffer & thread_trace_buffer() ;
+
+/**
+ * @brief Enregistre les zones de tous les threads au format Trace Event de Chrome (JSON)
+ *
+ * À appeler quand les threads de calcul n'écrivent plus de zone, par exemple à la fin du rendu.
+ *
+ * @param filename : référence vers le nom du fichier à créer
+ *
+ * @return true si le fichier a été écrit, false sinon
+*/
+bool trace_save(const std::string & filename) ;
+
+/**
+ * @brief La classe TraceZone enregistre, à la fin de sa portée, la zone qui a commencé à sa construction
+*/
+class TraceZone {
+    private :
+        /**
+         * @brief Le nom de la zone, une chaîne littérale ; nullptr si les zones ne sont pas enregistrées
+        */
+        const char * name_ ;
+        /**
+         * @brief La date de début de la zone
+        */
+        int64_t start_ ;
+
+    public :
+        explicit TraceZone(const char * name) : name_(trace_enabled() ? name : nullptr), start_(0) {
+            if (name_ != nullptr) {
+                start_ = trace_now() ;
+            }
+        }
+        ~TraceZone() {
+            if (name_ != nullptr) {
+                thread_trace_buffer().push(TraceEvent { name_, start_, trace_now() - start_ }) ;
+            }
+        }
+        TraceZone(const TraceZone &) = delete ;
+        TraceZone & operator=(const TraceZone &) = delete ;
+} ;
+
+# define RT_TRACE_CONCAT_(a, b) a##b
+# define RT_TRACE_VARIABLE_(ligne) RT_TRACE_CONCAT_(rt_trace_zone_, ligne)
+# define RT_TRACE(nom) TraceZone RT_TRACE_VARIABLE_(__LINE__)(nom)
+
+#endif
@@ -0,0 +1,129 @@
+#include "Transform.h"
+#include <cmath>
+
+const float PI_TRANSFORM = 3.14159265358979f ;
+
+Transform::Transform() {
+    for (int i = 0 ; i < 3 ; i++) {
+        for (int j = 0 ; j < 4 ; j++) {
+            m_[i][j] = (i == j) ? 1.0f : 0.0f ;
+            inv_[i][j] = m_[i][j] ;
+        }
+    }
+}
+
+Transform Transform::translation(const Vector3f & t) {
+    Transform r ;
+    const float v[3] = { t.get_x(), t.get_y(), t.get_z() } ;
+    for (int i = 0 ; i < 3 ; i++) {
+        r.m_[i][3] = v[i] ;
+        r.inv_[i][3] = -v[i] ;
+    }
+    return r ;
+}
+
+Transform Transform::scaling(const Vector3f & s) {
+    Transform r ;
+    const float v[3] = { s.get_x(), s.get_y(), s.get_z() } ;
+    for (int i = 0 ; i < 3 ; i++) {
+        r.m_[i][i] = v[i] ;
+        r.inv_[i][i] = 1.0f / v[i] ;
+    }
+    return r ;
+}
+
+Transform Transform::rotation(int axe, float degres) {
+    Transform r ;
+    float angle = degres * PI_TRANSFORM / 180.0f ;
+    float c = std::cos(angle) ;
+    float s = std::sin(angle) ;
+    // Les deux autres axes, dans l'ordre direct
+    int a = (axe + 1) % 3 ;
+    int b = (axe + 2) % 3 ;
+    r.m_[a][a] = c ; r.m_[a][b] = -s ;
+    r.m_[b][a] = s ; r.m_[b][b] = c ;
+    // L'inverse d'une rotation est sa transposée
+    r.inv_[a][a] = c ; r.inv_[a][b] = s ;
+    r.inv_[b][a] = -s ; r.inv_[b][b] = c ;
+    return r ;
+}
+
+Transform Transform::inverse() const {
+    Transform r ;
+    for (int i = 0 ; i < 3 ; i++) {
+        for (int j = 0 ; j < 4 ; j++) {
+            r.m_[i][j] = inv_[i][j] ;
+            r.inv_[i][j] = m_[i][j] ;
+        }
+    }
+    return r ;
+}
+
+Vector3f Transform::point(const Vector3f & p) const {
+    const float x = p.get_x(), y = p.get_y(), z = p.get_z() ;
+    return Vector3f(m_[0][0] * x + m_[0][1] * y + m_[0][2] * z + m_[0][3],
+                    m_[1][0] * x + m_[1][1] * y + m_[1][2] * z + m_[1][3],
+                    m_[2][0] * x + m_[2][1] * y + m_[2][2] * z + m_[2][3]) ;
+}
+
+Vector3f Transform::vector(const Vector3f & v) const {
+    const float x = v.get_x(), y = v.get_y(), z = v.get_z() ;
+    return Vector3f(m_[0][0] * x + m_[0][1] * y + m_[0][2] * z,
+                    m_[1][0] * x + m_[1][1] * y + m_[1][2] * z,
+                    m_[2][0] * x + m_[2][1] * y + m_[2][2] * z) ;
+}
+
+Vector3f Transform::inverse_point(const Vector3f & p) const {
+    const float x = p.get_x(), y = p.get_y(), z = p.get_z() ;
+    return Vector3f(inv_[0][0] * x + inv_[0][1] * y + inv_[0][2] * z + inv_[0][3],
+                    inv_[1][0] * x + inv_[1][1] * y + inv_[1][2] * z + inv_[1][3],
+                    inv_[2][0] * x + inv_[2][1] * y + inv_[2][2] * z + inv_[2][3]) ;
+}
+
+Vector3f Transform::inverse_vector(const Vector3f & v) const {
+    const float x = v.get_x(), y = v.get_y(), z = v.get_z() ;
+    return Vector3f(inv_[0][0] * x + inv_[0][1] * y + inv_[0][2] * z,
+                    inv_[1][0] * x + inv_[1][1] * y + inv_[1][2] * z,
+                    inv_[2][0] * x + inv_[2][1] * y + inv_[2][2] * z) ;
+}
+
+Vector3f Transform::normal(const Vector3f & n) const {
+    const float x = n.get_x(), y = n.get_y(), z = n.get_z() ;
+    return Vector3f(inv_[0][0] * x + inv_[1][0] * y + inv_[2][0] * z,
+                    inv_[0][1] * x + inv_[1][1] * y + inv_[2][1] * z,
+                    inv_[0][2] * x + inv_[1][2] * y + inv_[2][2] * z) ;
+}
+
+BoundingBox Transform::box(const BoundingBox & b) const {
+    BoundingBox r ;
+    if (b.is_empty()) {
+        return r ;
+    }
+    Vector3f lo = b.get_min() ;
+    Vector3f hi = b.get_max() ;
+    for (int coin = 0 ; coin < 8 ; coin++) {
+        Vector3f p((coin & 1) ? hi.get_x() : lo.get_x(),
+                   (coin & 2) ? hi.get_y() : lo.get_y(),
+                   (coin & 4) ? hi.get_z() : lo.get_z()) ;
+        r.expand(point(p)) ;
+    }
+    return r ;
+}
+
+Transform Transform::operator* (const Transform & t) const {
+    Transform r ;
+    for (int i = 0 ; i < 3 ; i++) {
+        for (int j = 0 ; j < 4 ; j++) {
+            // (this * t) = this(t(p)), et son inverse est t^-1(this^-1(p))
+            float direct = (j == 3) ? m_[i][3] : 0.0f ;
+            float inverse = (j == 3) ? t.inv_[i][3] : 0.0f ;
+            for (int k = 0 ; k < 3 ; k++) {
+                direct += m_[i][k] * t.m_[k][j] ;
+                inverse += t.inv_[i][k] * inv_[k][j] ;
+            }
+            r.m_[i][j] = direct ;
+            r.inv_[i][j] = inverse ;
+        }
+    }
+    return r ;
+}
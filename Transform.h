@@ -0,0 +1,129 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "Vector3f.h"
+#include "BoundingBox.h"
+#include <ostream>
+
+/**
+ * @brief La classe Transform est une transformation affine de l'espace (rotation, changement d'échelle, translation)
+ *
+ * Elle garde sa matrice (3 lignes de 4 colonnes, la dernière colonne étant la translation) et celle de son inverse.
+ * Les transformations sont construites par composition de transformations élémentaires, dont l'inverse est connu :
+ * l'inverse n'est donc jamais calculé par une inversion de matrice.
+ *
+ * @see Instance
+*/
+class Transform {
+    private :
+        /**
+         * @brief La matrice de la transformation
+        */
+        float m_[3][4] ;
+        /**
+         * @brief La matrice de la transformation inverse
+        */
+        float inv_[3][4] ;
+
+    public :
+        /**
+         * @brief Constructeur par défaut, crée l'identité
+        */
+        Transform() ;
+
+        /**
+         * @brief Crée une translation
+         *
+         * @param t : le vecteur de la translation
+         *
+         * @return La translation
+        */
+        static Transform translation(const Vector3f & t) ;
+        /**
+         * @brief Crée un changement d'échelle, éventuellement différent selon les axes
+         *
+         * @param s : le facteur sur chaque axe, non nul
+         *
+         * @return Le changement d'échelle
+        */
+        static Transform scaling(const Vector3f & s) ;
+        /**
+         * @brief Crée une rotation autour d'un axe du repère
+         *
+         * @param axe : l'axe de rotation, 0 pour x, 1 pour y, 2 pour z
+         * @param degres : l'angle de la rotation, en degrés
+         *
+         * @return La rotation
+        */
+        static Transform rotation(int axe, float degres) ;
+
+        /**
+         * @brief Donne la transformation inverse
+         *
+         * @return L'inverse de la transformation
+        */
+        Transform inverse() const ;
+
+        /**
+         * @brief Transforme un point
+         *
+         * @param p : référence vers le point
+         *
+         * @return Le point transformé
+        */
+        Vector3f point(const Vector3f & p) const ;
+        /**
+         * @brief Transforme un vecteur (la translation ne s'applique pas)
+         *
+         * @param v : référence vers le vecteur
+         *
+         * @return Le vecteur transformé
+        */
+        Vector3f vector(const Vector3f & v) const ;
+        /**
+         * @brief Applique la transformation inverse à un point
+         *
+         * @param p : référence vers le point
+         *
+         * @return Le point transformé par l'inverse
+        */
+        Vector3f inverse_point(const Vector3f & p) const ;
+        /**
+         * @brief Applique la transformation inverse à un vecteur
+         *
+         * @param v : référence vers le vecteur
+         *
+         * @return Le vecteur transformé par l'inverse
+        */
+        Vector3f inverse_vector(const Vector3f & v) const ;
+        /**
+         * @brief Transforme une normale, par la transposée de l'inverse pour qu'elle reste orthogonale à la surface
+         *
+         * @param n : référence vers la normale
+         *
+         * @return La normale transformée, non normalisée
+        */
+        Vector3f normal(const Vector3f & n) const ;
+        /**
+         * @brief Transforme une boîte englobante
+         *
+         * @param b : référence vers la boîte
+         *
+         * @return La plus petite boîte alignée sur les axes qui contient les huit coins transformés
+         * @see BoundingBox
+        */
+        BoundingBox box(const BoundingBox & b) const ;
+
+        /**
+         * @brief La composition de deux transformations
+         *
+         * (a * b) applique d'abord b, puis a
+         *
+         * @param t : référence vers la transformation appliquée en premier
+         *
+         * @return La transformation composée
+        */
+        Transform operator* (const Transform & t) const ;
+} ;
+
+#endif
@@ -0,0 +1,172 @@
+#include "TriangleMesh.h"
+#include "RenderStats.h"
+#include <cmath>
+#include <utility>
+
+/**
+ * @brief Le changement de repère d'un rayon pour le test étanche : l'axe kz est celui où la direction est la plus
+ * grande, et le cisaillement (sx, sy, sz) ramène la direction sur cet axe, de longueur 1
+*/
+struct Cisaillement {
+    int kx, ky, kz ;
+    float sx, sy, sz ;
+    float origin[3] ;
+} ;
+
+static Cisaillement shear(const Ray3f & ray) {
+    Cisaillement c ;
+    Vector3f o = ray.get_centre() ;
+    Vector3f d = ray.get_direction() ;
+    const float dir[3] = { d.get_x(), d.get_y(), d.get_z() } ;
+    c.origin[0] = o.get_x() ; c.origin[1] = o.get_y() ; c.origin[2] = o.get_z() ;
+    c.kz = 0 ;
+    if (std::fabs(dir[1]) > std::fabs(dir[c.kz])) c.kz = 1 ;
+    if (std::fabs(dir[2]) > std::fabs(dir[c.kz])) c.kz = 2 ;
+    c.kx = (c.kz + 1) % 3 ;
+    c.ky = (c.kx + 1) % 3 ;
+    // On garde le sens de parcours des sommets, donc le signe du déterminant
+    if (dir[c.kz] < 0.0f) {
+        std::swap(c.kx, c.ky) ;
+    }
+    c.sx = dir[c.kx] / dir[c.kz] ;
+    c.sy = dir[c.ky] / dir[c.kz] ;
+    c.sz = 1.0f / dir[c.kz] ;
+    return c ;
+}
+
+// Test étanche d'un triangle (a, b, c) : les sommets sont ramenés dans le repère du rayon, où le rayon est l'axe z,
+// puis les fonctions d'arête U, V, W donnent le côté de chaque arête où passe le rayon. Une arête partagée donne
+// exactement la même valeur (au signe près) pour les deux triangles : si elle vaut 0, elle est recalculée en double.
+static bool triangle_hit(const Cisaillement & s, const float * a, const float * b, const float * c, float t_max, float * t) {
+    const float ax = a[s.kx] - s.origin[s.kx], ay = a[s.ky] - s.origin[s.ky], az = a[s.kz] - s.origin[s.kz] ;
+    const float bx = b[s.kx] - s.origin[s.kx], by = b[s.ky] - s.origin[s.ky], bz = b[s.kz] - s.origin[s.kz] ;
+    const float cx = c[s.kx] - s.origin[s.kx], cy = c[s.ky] - s.origin[s.ky], cz = c[s.kz] - s.origin[s.kz] ;
+    const float Ax = ax - s.sx * az, Ay = ay - s.sy * az ;
+    const float Bx = bx - s.sx * bz, By = by - s.sy * bz ;
+    const float Cx = cx - s.sx * cz, Cy = cy - s.sy * cz ;
+
+    float U = Cx * By - Cy * Bx ;
+    float V = Ax * Cy - Ay * Cx ;
+    float W = Bx * Ay - By * Ax ;
+    if (U == 0.0f || V == 0.0f || W == 0.0f) {
+        U = static_cast<float>(static_cast<double>(Cx) * By - static_cast<double>(Cy) * Bx) ;
+        V = static_cast<float>(static_cast<double>(Ax) * Cy - static_cast<double>(Ay) * Cx) ;
+        W = static_cast<float>(static_cast<double>(Bx) * Ay - static_cast<double>(By) * Ax) ;
+    }
+    if ((U < 0.0f || V < 0.0f || W < 0.0f) && (U > 0.0f || V > 0.0f || W > 0.0f)) {
+        return false ;
+    }
+    float det = U + V + W ;
+    if (det == 0.0f) {
+        return false ;
+    }
+    // t = T / det, comparé à 0 et à t_max sans division
+    float T = U * (s.sz * az) + V * (s.sz * bz) + W * (s.sz * cz) ;
+    if (det < 0.0f ? (T >= 0.0f || T < t_max * det) : (T <= 0.0f || T > t_max * det)) {
+        return false ;
+    }
+    *t = T / det ;
+    return true ;
+}
+
+TriangleMesh::TriangleMesh(Material matter, std::vector<float> positions, std::vector<float> normals,
+                           std::vector<int> triangles, std::vector<int> normal_ids, bool miroir, int nb_threads) : Shape(matter, miroir) {
+
+    int nb_triangles = static_cast<int>(triangles.size() / 3) ;
+    std::vector<BoundingBox> boxes ;
+    boxes.reserve(nb_triangles) ;
+    for (int i = 0 ; i < nb_triangles ; i++) {
+        BoundingBox box ;
+        for (int k = 0 ; k < 3 ; k++) {
+            const float * p = &positions[3 * triangles[3 * i + k]] ;
+            box.expand(Vector3f(p[0], p[1], p[2])) ;
+        }
+        boxes.push_back(box) ;
+    }
+    bvh_.build(boxes, nb_threads) ;
+
+    // Les triangles sont rangés dans l'ordre des feuilles : une feuille est un intervalle contigu de triangles_
+    std::vector<int> triangles_feuilles(triangles.size()) ;
+    std::vector<int> normal_ids_feuilles(triangles.size()) ;
+    for (int k = 0 ; k < nb_triangles ; k++) {
+        int i = bvh_.get_index(k) ;
+        for (int j = 0 ; j < 3 ; j++) {
+            triangles_feuilles[3 * k + j] = triangles[3 * i + j] ;
+            normal_ids_feuilles[3 * k + j] = normal_ids.empty() ? -1 : normal_ids[3 * i + j] ;
+        }
+    }
+    positions_ = MappedArray<float>(std::move(positions)) ;
+    normals_ = MappedArray<float>(std::move(normals)) ;
+    triangles_ = MappedArray<int>(std::move(triangles_feuilles)) ;
+    normal_ids_ = MappedArray<int>(std::move(normal_ids_feuilles)) ;
+}
+
+TriangleMesh::TriangleMesh(Material matter, MappedArray<float> positions, MappedArray<float> normals,
+                           MappedArray<int> triangles, MappedArray<int> normal_ids, Bvh bvh, bool miroir) : Shape(matter, miroir) {
+    positions_ = std::move(positions) ;
+    normals_ = std::move(normals) ;
+    triangles_ = std::move(triangles) ;
+    normal_ids_ = std::move(normal_ids) ;
+    bvh_ = std::move(bvh) ;
+}
+
+HitRecord TriangleMesh::is_hit(const Ray3f & ray) const {
+    HitRecord closest = no_hit() ;
+    Cisaillement s = shear(ray) ;
+    bvh_.traverse(ray, closest.t_, [&](int first, int count, float & t_max) {
+        for (int i = first ; i < first + count ; i++) {
+            RT_STAT(shape_tests_) ;
+            float t ;
+            const int * v = &triangles_[3 * i] ;
+            if (triangle_hit(s, &positions_[3 * v[0]], &positions_[3 * v[1]], &positions_[3 * v[2]], t_max, &t) && t < closest.t_) {
+                closest.t_ = t ;
+                closest.primitive_ = i ;
+            }
+        }
+        t_max = closest.t_ ;
+        return false ;
+    }) ;
+    return closest ;
+}
+
+void TriangleMesh::finalize_hit(const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const {
+    *P = ray.get_centre() + hit.t_*ray.get_direction() ;
+
+    const int * v = &triangles_[3 * hit.primitive_] ;
+    const float * pa = &positions_[3 * v[0]] ;
+    const float * pb = &positions_[3 * v[1]] ;
+    const float * pc = &positions_[3 * v[2]] ;
+    Vector3f a(pa[0], pa[1], pa[2]), b(pb[0], pb[1], pb[2]), c(pc[0], pc[1], pc[2]) ;
+    Vector3f ng = cross(b - a, c - a) ;
+    // Le maillage n'est pas forcément orienté : la normale est tournée vers le rayon
+    float sens = (dot(ng, ray.get_direction()) > 0.0f) ? -1.0f : 1.0f ;
+
+    const int * n = &normal_ids_[3 * hit.primitive_] ;
+    if (n[0] < 0 || n[1] < 0 || n[2] < 0) {
+        *N = sens * ng ;
+        N->normalize() ;
+        return ;
+    }
+    // Coordonnées barycentriques de P : l'aire de chaque sous-triangle opposé à un sommet, sur l'aire du triangle
+    float aire = dot(ng, ng) ;
+    float wa = dot(ng, cross(c - b, *P - b)) / aire ;
+    float wb = dot(ng, cross(a - c, *P - c)) / aire ;
+    float wc = 1.0f - wa - wb ;
+    const float * na = &normals_[3 * n[0]] ;
+    const float * nb = &normals_[3 * n[1]] ;
+    const float * nc = &normals_[3 * n[2]] ;
+    *N = Vector3f(wa * na[0] + wb * nb[0] + wc * nc[0], wa * na[1] + wb * nb[1] + wc * nc[1], wa * na[2] + wb * nb[2] + wc * nc[2]) ;
+    if (sens * dot(*N, ng) < 0.0f) {
+        *N = -1.0f * *N ;
+    }
+    N->normalize() ;
+}
+
+BoundingBox TriangleMesh::bounding_box() const {
+    return bvh_.get_bounds() ;
+}
+
+std::ostream & operator << (std::ostream & st, const TriangleMesh & m) {
+    st << "TriangleMesh : [ vertices : " << m.get_nb_vertices() << ", triangles : " << m.get_nb_triangles() << " ]" ;
+    return st ;
+}
@@ -0,0 +1,174 @@
+#ifndef TRIANGLEMESH_H
+#define TRIANGLEMESH_H
+
+#include "Shape.h"
+#include "Bvh.h"
+#include "BoundingBox.h"
+#include "Vector3f.h"
+#include "Material.h"
+#include "Ray3f.h"
+#include "MappedArray.h"
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief La classe TriangleMesh est un maillage de triangles, vu par la scène comme une seule forme
+ *
+ * Les sommets et les normales sont rangés une seule fois, dans des tableaux de flottants (trois par élément),
+ * et chaque triangle donne les indices de ses trois sommets et de leurs normales. Le maillage a sa propre
+ * hiérarchie de volumes englobants sur ses triangles : la scène ne voit qu'une boîte et une forme, quel que soit
+ * le nombre de triangles. Les triangles sont rangés dans l'ordre des feuilles de cette hiérarchie.
+ *
+ * Les tableaux sont des MappedArray : un maillage relu d'un cache de scène désigne directement les octets du fichier.
+ *
+ * Le test d'intersection est étanche (Woop, Benthin et Wald, 2013) : un rayon qui passe sur l'arête commune
+ * à deux triangles en touche toujours au moins un, sans trou entre eux.
+ *
+ * @see ObjLoader, Bvh
+*/
+class TriangleMesh : public Shape {
+    private :
+        /**
+         * @brief Les positions des sommets, trois flottants (x, y, z) par sommet
+        */
+        MappedArray<float> positions_ ;
+        /**
+         * @brief Les normales, trois flottants par normale (vide si le maillage n'en a pas)
+        */
+        MappedArray<float> normals_ ;
+        /**
+         * @brief Les indices des trois sommets de chaque triangle, dans l'ordre des feuilles de bvh_
+        */
+        MappedArray<int> triangles_ ;
+        /**
+         * @brief Les indices des normales des trois sommets de chaque triangle, -1 pour prendre la normale du triangle
+        */
+        MappedArray<int> normal_ids_ ;
+        /**
+         * @brief La hiérarchie de volumes englobants des triangles
+        */
+        Bvh bvh_ ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         *
+         * Construit la hiérarchie des triangles et les range dans l'ordre de ses feuilles.
+         *
+         * @param matter : le matériel du maillage
+         * @param positions : les positions des sommets, trois flottants par sommet
+         * @param normals : les normales, trois flottants par normale (éventuellement vide)
+         * @param triangles : les indices des trois sommets de chaque triangle
+         * @param normal_ids : les indices des normales des trois sommets de chaque triangle, -1 s'il n'y en a pas
+         * @param miroir : si le maillage est un miroir
+         * @param nb_threads : le nombre de threads de la construction de la hiérarchie, 0 pour tous les coeurs
+         * @see Shape
+        */
+        TriangleMesh(Material matter, std::vector<float> positions, std::vector<float> normals,
+                     std::vector<int> triangles, std::vector<int> normal_ids, bool miroir, int nb_threads) ;
+        /**
+         * @brief Constructeur paramétré, à partir d'un maillage déjà construit, sans reconstruire sa hiérarchie
+         *
+         * Sert à relire un maillage d'un cache de scène : les triangles sont déjà dans l'ordre des feuilles de bvh.
+         *
+         * @param matter : le matériel du maillage
+         * @param positions : les positions des sommets, trois flottants par sommet
+         * @param normals : les normales, trois flottants par normale (éventuellement vide)
+         * @param triangles : les indices des trois sommets de chaque triangle, dans l'ordre des feuilles de bvh
+         * @param normal_ids : les indices des normales des trois sommets de chaque triangle, -1 s'il n'y en a pas
+         * @param bvh : la hiérarchie de volumes englobants des triangles
+         * @param miroir : si le maillage est un miroir
+         * @see SceneCache
+        */
+        TriangleMesh(Material matter, MappedArray<float> positions, MappedArray<float> normals,
+                     MappedArray<int> triangles, MappedArray<int> normal_ids, Bvh bvh, bool miroir) ;
+
+        /**
+         * @brief Donne le nombre de sommets
+         *
+         * @return Le nombre de sommets
+        */
+        int get_nb_vertices() const { return static_cast<int>(positions_.size() / 3) ; }
+        /**
+         * @brief Donne le nombre de triangles
+         *
+         * @return Le nombre de triangles
+        */
+        int get_nb_triangles() const { return static_cast<int>(triangles_.size() / 3) ; }
+        /**
+         * @brief Getter de l'attribut positions_
+         *
+         * @return Référence vers l'attribut positions_ de la classe
+        */
+        const MappedArray<float> & get_positions() const { return positions_ ; }
+        /**
+         * @brief Getter de l'attribut normals_
+         *
+         * @return Référence vers l'attribut normals_ de la classe
+        */
+        const MappedArray<float> & get_normals() const { return normals_ ; }
+        /**
+         * @brief Getter de l'attribut triangles_
+         *
+         * @return Référence vers l'attribut triangles_ de la classe
+        */
+        const MappedArray<int> & get_triangles() const { return triangles_ ; }
+        /**
+         * @brief Getter de l'attribut normal_ids_
+         *
+         * @return Référence vers l'attribut normal_ids_ de la classe
+        */
+        const MappedArray<int> & get_normal_ids() const { return normal_ids_ ; }
+        /**
+         * @brief Getter de l'attribut bvh_
+         *
+         * @return Référence vers l'attribut bvh_ de la classe
+        */
+        const Bvh & get_bvh() const { return bvh_ ; }
+
+        /**
+         * @brief Cherche le triangle le plus proche touché par le rayon
+         *
+         * @param ray : référence vers le rayon
+         *
+         * @return Le HitRecord de l'intersection, dont primitive_ est l'indice du triangle, -1 s'il n'y a pas d'intersection
+         * @see HitRecord
+        */
+        HitRecord is_hit (const Ray3f & ray) const ;
+
+        /**
+         * @brief Calcule le point d'intersection et la normale d'une intersection trouvée par is_hit
+         *
+         * La normale est interpolée entre celles des sommets s'il y en a, et sinon c'est celle du triangle.
+         * Elle est tournée vers l'origine du rayon : le maillage n'a pas besoin d'être orienté.
+         *
+         * @param ray : référence vers le rayon qui a donné l'intersection
+         * @param hit : référence vers le HitRecord renvoyé par is_hit pour ce rayon
+         * @param P : pointeur vers le point d'intersection
+         * @param N : pointeur vers la normale (unitaire) associée au point P
+         * @see HitRecord
+        */
+        void finalize_hit (const Ray3f & ray, const HitRecord & hit, Vector3f * P, Vector3f * N) const ;
+
+        /**
+         * @brief Donne la boîte englobante du maillage
+         *
+         * @return La boîte de la racine de bvh_
+         * @see BoundingBox
+        */
+        BoundingBox bounding_box() const ;
+} ;
+
+/**
+ * @brief L'opérateur << pour afficher les informations du maillage
+ *
+ * Affiche : TriangleMesh : [ vertices : nombre de sommets, triangles : nombre de triangles ]
+ *
+ * @param st : le flux sur lequel on veut afficher le maillage
+ * @param m : référence du maillage dont on veut afficher les informations
+ *
+ * @return la référence vers le flux modifié
+*/
+std::ostream & operator << (std::ostream & st, const TriangleMesh & m) ;
+
+#endif
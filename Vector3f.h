@@ -3,6 +3,18 @@
 
 #include <cmath>
 #include <ostream>
+#include <type_traits>
+
+// Vector3f est entièrement défini dans ce fichier, pour que ses opérations soient inlinées dans les boucles d'intersection.
+// Par défaut les calculs sont scalaires et constexpr. Avec -DVECTOR3F_SSE, le vecteur est stocké sur 4 flottants alignés
+// et les opérations composante par composante passent par les registres SSE : les résultats sont identiques bit à bit,
+// chaque composante subissant exactement les mêmes opérations, dans le même ordre.
+#ifdef VECTOR3F_SSE
+# include <emmintrin.h>
+# define VECTOR3F_CONSTEXPR inline
+#else
+# define VECTOR3F_CONSTEXPR constexpr
+#endif
 
 /**
  * @brief La classe définit les vecteurs à 3 dimensions que l'on utilisera dans le reste du projet
@@ -10,6 +22,25 @@
 
 class Vector3f {
     private:
+#ifdef VECTOR3F_SSE
+        /**
+         * @brief Les valeurs sur les axes des abscisses, des ordonnées et des cotes, et une 4ème composante toujours nulle
+        */
+        alignas(16) float v_[4];
+
+        /**
+         * @brief Charge le vecteur dans un registre SSE
+        */
+        __m128 load() const { return _mm_load_ps(v_); }
+        /**
+         * @brief Constructeur à partir d'un registre SSE
+        */
+        explicit Vector3f(__m128 v) { _mm_store_ps(v_, v); }
+        /**
+         * @brief Masque qui garde les 3 premières composantes et annule la 4ème
+        */
+        static __m128 masque_xyz() { return _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)); }
+#else
         /**
          * @brief La valeur de l'axe des abscisses
         */
@@ -22,6 +53,7 @@ class Vector3f {
          * @brief La valeur de l'axe des cotes
         */
         float z_;
+#endif
     
     public:
 
@@ -30,7 +62,7 @@ class Vector3f {
          * 
          * Crée une instance de la classe Vector3f avec les 3 attributs de la classe à 0
         */
-        Vector3f() ;
+        constexpr Vector3f() : Vector3f(0.0f, 0.0f, 0.0f) {}
         /**
          * @brief Constructeur paramétré
          * 
@@ -40,7 +72,11 @@ class Vector3f {
          * @param y : la valeur du vecteur sur l'axe des ordonnées
          * @param z : la valeur du vecteur sur l'axe des cotes
         */
-        Vector3f(float x, float y, float z) ;
+#ifdef VECTOR3F_SSE
+        constexpr Vector3f(float x, float y, float z) : v_{x, y, z, 0.0f} {}
+#else
+        constexpr Vector3f(float x, float y, float z) : x_(x), y_(y), z_(z) {}
+#endif
         /**
          * @brief Constructeur paramétré
          * 
@@ -48,53 +84,94 @@ class Vector3f {
          * 
          * @param x : la valeur de tous les éléments du vecteur
         */
-        Vector3f(float x) ;
+        constexpr Vector3f(float x) : Vector3f(x, x, x) {}
         /**
          * @brief Constructeur de copie
          * 
-         * Crée une instance de Vector3f en copiant les attributs du Vector3f donné un entrée
+         * Crée une instance de Vector3f en copiant les attributs du Vector3f donné un entrée.
+         * Il est celui du compilateur, pour que le vecteur reste trivialement copiable
          * 
          * @param q : une référence vers le Vector3f dont on veut faire la copie
          */
-        Vector3f (const Vector3f & v);
+        Vector3f (const Vector3f & v) = default;
 
+#ifdef VECTOR3F_SSE
+        /**
+         * @brief Getter de la valeur de l'axe des abscisses
+         *
+         * @return La valeur de l'axe des abscisses
+        */
+        constexpr float get_x() const { return v_[0]; }
+        /**
+         * @brief Getter de la valeur de l'axe des ordonnées
+         *
+         * @return La valeur de l'axe des ordonnées
+        */
+        constexpr float get_y() const { return v_[1]; }
+        /**
+         * @brief Getter de la valeur de l'axe des cotes
+         *
+         * @return La valeur de l'axe des cotes
+        */
+        constexpr float get_z() const { return v_[2]; }
+
+        /**
+         * @brief Setter de la valeur de l'axe des abscisses
+         *
+         * @param x : la valeur de x que l'on veut donner au vecteur
+        */
+        constexpr void set_x(float x) { v_[0] = x ; }
+        /**
+         * @brief Setter de la valeur de l'axe des ordonnées
+         *
+         * @param x : la valeur de y que l'on veut donner au vecteur
+        */
+        constexpr void set_y(float y) { v_[1] = y ; }
+        /**
+         * @brief Setter de la valeur de l'axe des cotes
+         *
+         * @param x : la valeur de z que l'on veut donner au vecteur
+        */
+        constexpr void set_z(float z) { v_[2] = z ; }
+#else
         /**
          * @brief Getter de l'attribut x_
          * 
          * @return L'attribut x_ de la classe
         */
-        float get_x() const { return x_; }
+        constexpr float get_x() const { return x_; }
         /**
          * @brief Getter de l'attribut y_
          * 
          * @return L'attribut y_ de la classe
         */
-        float get_y() const { return y_; }
+        constexpr float get_y() const { return y_; }
         /**
          * @brief Getter de l'attribut z_
          * 
          * @return L'attribut z_ de la classe
         */
-        float get_z() const { return z_; }
+        constexpr float get_z() const { return z_; }
 
         /**
          * @brief Setter de l'attribut x_
          * 
          * @param x : la valeur de x que l'on veut donner au vecteur
         */
-        void set_x(float x) { x_ = x ; }
+        constexpr void set_x(float x) { x_ = x ; }
         /**
          * @brief Setter de l'attribut y_
          * 
          * @param x : la valeur de y que l'on veut donner au vecteur
         */
-        void set_y(float y) { y_ = y ; }
+        constexpr void set_y(float y) { y_ = y ; }
         /**
          * @brief Setter de l'attribut z_
          * 
          * @param x : la valeur de z que l'on veut donner au vecteur
         */
-        void set_z(float z) { z_ = z ; }
+        constexpr void set_z(float z) { z_ = z ; }
+#endif
 
         /**
          * @brief L'opérateur = de la classe
@@ -103,7 +180,7 @@ class Vector3f {
          * 
          * @return Référence vers le vecteur attribué
         */
-        Vector3f & operator= (const Vector3f & v) ;
+        Vector3f & operator= (const Vector3f & v) = default;
         /**
          * @brief L'opérateur += de la classe
          * 
@@ -111,7 +188,14 @@ class Vector3f {
          * 
          * @return Référence vers le vecteur nouvellement ajouté
         */
-        Vector3f & operator+=(const Vector3f & v);
+        VECTOR3F_CONSTEXPR Vector3f & operator+=(const Vector3f & v) {
+#ifdef VECTOR3F_SSE
+            _mm_store_ps(v_, _mm_add_ps(load(), v.load()));
+#else
+            x_ += v.x_ ; y_ += v.y_ ; z_ += v.z_ ;
+#endif
+            return *this ;
+        }
         /**
          * @brief L'opérateur -= de la classe
          * 
@@ -119,7 +203,14 @@ class Vector3f {
          * 
          * @return Référence vers le vecteur nouvellement enlevé
         */
-        Vector3f & operator-=(const Vector3f & v);
+        VECTOR3F_CONSTEXPR Vector3f & operator-=(const Vector3f & v) {
+#ifdef VECTOR3F_SSE
+            _mm_store_ps(v_, _mm_sub_ps(load(), v.load()));
+#else
+            x_ -= v.x_ ; y_ -= v.y_ ; z_ -= v.z_ ;
+#endif
+            return *this ;
+        }
         /**
          * @brief L'opérateur *= de la classe
          * 
@@ -127,7 +218,14 @@ class Vector3f {
          * 
          * @return Référence vers le vecteur nouvellement multiplié
         */
-        Vector3f & operator*=(const Vector3f & v);
+        VECTOR3F_CONSTEXPR Vector3f & operator*=(const Vector3f & v) {
+#ifdef VECTOR3F_SSE
+            _mm_store_ps(v_, _mm_mul_ps(load(), v.load()));
+#else
+            x_ *= v.x_ ; y_ *= v.y_ ; z_ *= v.z_ ;
+#endif
+            return *this ;
+        }
         /**
          * @brief Fait le produit scalaire
          * 
@@ -135,7 +233,9 @@ class Vector3f {
          * 
          * @return Valeur du produit scalaire
         */
-        float  dot(const Vector3f & v);
+        constexpr float dot(const Vector3f & v) const {
+            return get_x() * v.get_x() + get_y() * v.get_y() + get_z() * v.get_z() ;
+        }
         /**
          * @brief L'opérateur /= de la classe avec un autre vecteur
          * 
@@ -143,7 +243,15 @@ class Vector3f {
          * 
          * @return Référence vers le vecteur nouvellement divisé
         */
-        Vector3f & operator/=(const Vector3f & v);
+        VECTOR3F_CONSTEXPR Vector3f & operator/=(const Vector3f & v) {
+#ifdef VECTOR3F_SSE
+            // 0 / 0 donnerait NaN dans la 4ème composante, qu'on garde nulle
+            _mm_store_ps(v_, _mm_and_ps(_mm_div_ps(load(), v.load()), masque_xyz()));
+#else
+            x_ /= v.x_ ; y_ /= v.y_ ; z_ /= v.z_ ;
+#endif
+            return *this ;
+        }
 
         /**
          * @brief Donne la longueur du vecteur
@@ -151,7 +259,7 @@ class Vector3f {
          * @return La longueur du vecteur
         */
         float longueur() const {
-            return sqrt(x_ * x_ + y_ * y_ + z_ * z_);
+            return sqrt(norme2());
         }
 
         /**
@@ -159,25 +267,36 @@ class Vector3f {
          * 
          * @return La norme 2 du vecteur
         */
-        float norme2() const {
-            return (x_ * x_ + y_ * y_ + z_ * z_);
+        constexpr float norme2() const {
+            return (get_x() * get_x() + get_y() * get_y() + get_z() * get_z());
         }
 
         /**
          * @brief Normalise le vecteur
         */
-        void normalize() ;
+        void normalize() {
+            float longu = longueur();
+            if (longu != 0.0f) {
+                *this /= Vector3f(longu);
+            }
+        }
 
         /**
          * @brief Donne une copie du vecteur normalisé
          * 
          * @return Un vecteur normalisé
         */
-        Vector3f get_normalised() ;
-
+        Vector3f get_normalised() const {
+            Vector3f v(*this) ;
+            v.normalize() ;
+            return v ;
+        }
 
+        friend VECTOR3F_CONSTEXPR Vector3f cross (const Vector3f & v1, const Vector3f & v2);
 };
 
+static_assert(std::is_trivially_copyable<Vector3f>::value, "Vector3f doit rester trivialement copiable") ;
+
 /**
  * @brief L'opérateur == de la classe
  * 
@@ -186,7 +305,9 @@ class Vector3f {
  * 
  * @return true si les deux vecteurs sont égaux, false s'ils ne le sont pas
 */
-bool operator== (const Vector3f & v1, const Vector3f & v2) ;
+constexpr bool operator== (const Vector3f & v1, const Vector3f & v2) {
+    return (v1.get_x() == v2.get_x() && v1.get_y() == v2.get_y() && v1.get_z() == v2.get_z());
+}
 
 /**
  * @brief L'opérateur + de la classe
@@ -196,7 +317,10 @@ bool operator== (const Vector3f & v1, const Vector3f & v2) ;
  * 
  * @return Un nouveau vecteur qui est le résultat de l'addition
 */
-Vector3f operator+ (const Vector3f & v1, const Vector3f & v2) ;
+VECTOR3F_CONSTEXPR Vector3f operator+ (const Vector3f & v1, const Vector3f & v2) {
+    Vector3f v(v1) ;
+    return v += v2 ;
+}
 /**
  * @brief L'opérateur - de la classe
  * 
@@ -205,7 +329,10 @@ Vector3f operator+ (const Vector3f & v1, const Vector3f & v2) ;
  * 
  * @return Un nouveau vecteur qui est le résultat de la soustraction
 */
-Vector3f operator- (const Vector3f & v1, const Vector3f & v2) ;
+VECTOR3F_CONSTEXPR Vector3f operator- (const Vector3f & v1, const Vector3f & v2) {
+    Vector3f v(v1) ;
+    return v -= v2 ;
+}
 
 /**
  * @brief L'opérateur * de la classe avec un autre vecteur
@@ -215,7 +342,10 @@ Vector3f operator- (const Vector3f & v1, const Vector3f & v2) ;
  * 
  * @return Un nouveau vecteur qui est le résultat de la multiplication
 */
-Vector3f operator* (const Vector3f & v1, const Vector3f & v2) ;
+VECTOR3F_CONSTEXPR Vector3f operator* (const Vector3f & v1, const Vector3f & v2) {
+    Vector3f v(v1) ;
+    return v *= v2 ;
+}
 /**
  * @brief L'opérateur * de la classe avec un float
  * 
@@ -224,7 +354,9 @@ Vector3f operator* (const Vector3f & v1, const Vector3f & v2) ;
  * 
  * @return Un nouveau vecteur qui est le résultat de la multiplication
 */
-Vector3f operator* (const float v1, const Vector3f & v2) ;
+VECTOR3F_CONSTEXPR Vector3f operator* (const float v1, const Vector3f & v2) {
+    return (Vector3f (v1) * v2) ;
+}
 /**
  * @brief L'opérateur / de la classe avec un autre vecteur
  * 
@@ -233,7 +365,10 @@ Vector3f operator* (const float v1, const Vector3f & v2) ;
  * 
  * @return Un nouveau vecteur qui est le résultat de la division
 */
-Vector3f operator/ (const Vector3f & v1, const Vector3f & v2) ;
+VECTOR3F_CONSTEXPR Vector3f operator/ (const Vector3f & v1, const Vector3f & v2) {
+    Vector3f v(v1) ;
+    return v /= v2 ;
+}
 
 /**
  * @brief Le produit scalaire entre 2 vecteurs
@@ -243,7 +378,9 @@ Vector3f operator/ (const Vector3f & v1, const Vector3f & v2) ;
  * 
  * @return Le résultat du produit scalaire entre les deux vecteurs
 */
-float dot (const Vector3f & v1, const Vector3f & v2) ;
+constexpr float dot (const Vector3f & v1, const Vector3f & v2){
+    return v1.dot(v2) ;
+}
 
 /**
  * @brief Le produit vectoriel entre 2 vecteurs
@@ -253,7 +390,22 @@ float dot (const Vector3f & v1, const Vector3f & v2) ;
  * 
  * @return Le résultat du produit vectoriel entre les deux vecteurs
 */
-Vector3f cross (const Vector3f & v1, const Vector3f & v2);
+VECTOR3F_CONSTEXPR Vector3f cross (const Vector3f & v1, const Vector3f & v2){
+#ifdef VECTOR3F_SSE
+    // (y1 z2 - z1 y2, z1 x2 - x1 z2, x1 y2 - y1 x2), la 4ème composante reste 0 * 0 - 0 * 0
+    __m128 a = v1.load() ;
+    __m128 b = v2.load() ;
+    __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)) ;
+    __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1)) ;
+    __m128 a_zxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)) ;
+    __m128 b_zxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2)) ;
+    return Vector3f(_mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx))) ;
+#else
+    return (Vector3f(v1.get_y() * v2.get_z() - v1.get_z() * v2.get_y(),
+    v1.get_z() * v2.get_x() - v1.get_x() * v2.get_z(),
+    v1.get_x() * v2.get_y() - v1.get_y() * v2.get_x())) ;
+#endif
+}
 
 /**
  * @brief L'opérateur << pour afficher les informations du vecteur
@@ -266,7 +418,10 @@ Vector3f cross (const Vector3f & v1, const Vector3f & v2);
  * 
  * @return la référence vers le flux modifié
 */
-std::ostream & operator << (std::ostream & st, const Vector3f & v) ;
+inline std::ostream & operator << (std::ostream & st, const Vector3f & v) {
+    st << "(" << v.get_x() << "," << v.get_y() << "," << v.get_z() << ")" ;
+    return st ;
+}
 
 
-#endif
\ No newline at end of file
+#endif
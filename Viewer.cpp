@@ -0,0 +1,244 @@
+#include "Viewer.h"
+
+#ifndef NO_SDL
+
+#include "Framebuffer.h"
+#include "Accumulator.h"
+#include "ThreadPool.h"
+#include "Wavefront.h"
+#include "Image.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+// Les aperçus calculés avant l'image complète, du plus grossier au plus fin
+const int PAS_APERCUS[] = { 8, 4, 2 } ;
+
+// Déplacement de la caméra pour un appui sur une touche, en fraction de la taille de l'image
+const float PAS_CLAVIER = 0.025f ;
+
+// Agrandit un aperçu à la taille de la fenêtre, chaque pixel de l'aperçu devenant un carré de pas x pas pixels
+static void enlarge(const std::vector<unsigned char> & petit, int largeur_petit, int pas, int largeur, int hauteur,
+                    std::vector<unsigned char> & grand) {
+    grand.resize(3 * static_cast<size_t>(largeur) * hauteur) ;
+    for (int y = 0 ; y < hauteur ; y++) {
+        const unsigned char * ligne = &petit[3 * static_cast<size_t>(y / pas) * largeur_petit] ;
+        unsigned char * dst = &grand[3 * static_cast<size_t>(y) * largeur] ;
+        for (int x = 0 ; x < largeur ; x++) {
+            const unsigned char * src = ligne + 3 * (x / pas) ;
+            dst[3 * x] = src[0] ;
+            dst[3 * x + 1] = src[1] ;
+            dst[3 * x + 2] = src[2] ;
+        }
+    }
+}
+
+Viewer::Viewer(Scene & scene, const RenderSettings & settings) : scene_(scene), settings_(settings) {
+    camera_ = scene.get_camera() ;
+    // La vue 1 est à calculer dès le lancement du thread de rendu, qui n'a encore calculé aucune vue (0)
+    generation_ = 1 ;
+    stop_ = false ;
+    frame_complete_ = false ;
+    frame_pending_ = false ;
+    frame_event_ = 0 ;
+}
+
+bool Viewer::interrupted(unsigned long vue) const {
+    return stop_ || generation_ != vue ;
+}
+
+void Viewer::publish(const std::vector<unsigned char> & rgb, const std::string & title, bool complete) {
+    bool annoncer = false ;
+    {
+        std::lock_guard<std::mutex> verrou(mutex_) ;
+        frame_ = rgb ;
+        title_ = title ;
+        frame_complete_ = complete ;
+        // Un seul évènement en attente suffit : la fenêtre affichera la dernière image publiée
+        annoncer = !frame_pending_ ;
+        frame_pending_ = true ;
+    }
+    if (annoncer) {
+        SDL_Event event = {} ;
+        event.type = frame_event_ ;
+        SDL_PushEvent(&event) ;
+    }
+}
+
+void Viewer::move_camera(float droite, float bas, float avant) {
+    {
+        std::lock_guard<std::mutex> verrou(mutex_) ;
+        camera_.move(droite * camera_.get_right() + bas * camera_.get_down() + avant * camera_.get_direction()) ;
+        generation_++ ;
+    }
+    changed_.notify_one() ;
+}
+
+void Viewer::turn_camera(float lacet, float tangage) {
+    {
+        std::lock_guard<std::mutex> verrou(mutex_) ;
+        camera_.turn(lacet, tangage) ;
+        generation_++ ;
+    }
+    changed_.notify_one() ;
+}
+
+void Viewer::render_loop() {
+    int largeur = settings_.width_ ;
+    int hauteur = settings_.height_ ;
+    ThreadPool pool(settings_.nb_threads_) ;
+    Framebuffer apercu ;
+    Framebuffer image(largeur, hauteur) ;
+    Accumulator accumulator(largeur, hauteur) ;
+    Wavefront wavefront(scene_) ;
+    std::vector<unsigned char> rgb, agrandie ;
+    unsigned long vue = 0 ;
+    // Appelé par chaque tuile, chaque ligne d'aperçu et chaque rebond d'une vague : un calcul dépassé par un
+    // déplacement de la caméra s'arrête sans attendre la fin de l'image
+    std::function<bool()> abandon = [&] { return interrupted(vue) ; } ;
+
+    while (true) {
+        // On dort jusqu'à ce que la caméra bouge ; seul ce thread touche à la scène
+        {
+            std::unique_lock<std::mutex> verrou(mutex_) ;
+            changed_.wait(verrou, [&] { return stop_ || generation_ != vue ; }) ;
+            if (stop_) {
+                return ;
+            }
+            vue = generation_ ;
+            scene_.set_camera(camera_) ;
+        }
+
+        // Les aperçus s'affichent vite pendant que la caméra bouge ; un aperçu abandonné en route n'est pas publié
+        for (int pas : PAS_APERCUS) {
+            scene_.render_preview(apercu, pool, largeur, hauteur, pas, abandon) ;
+            if (interrupted(vue)) {
+                break ;
+            }
+            apercu.to_rgb8(rgb) ;
+            enlarge(rgb, apercu.get_width(), pas, largeur, hauteur, agrandie) ;
+            publish(agrandie, "aperçu 1/" + std::to_string(pas), false) ;
+        }
+        if (interrupted(vue)) {
+            continue ;
+        }
+
+        // Puis l'image complète, affinée passe après passe en rendu progressif ; une image déjà dépassée
+        // par un nouveau déplacement n'est pas publiée
+        if (settings_.path_tracing_) {
+            accumulator.reset(largeur, hauteur) ;
+            for (int k = 0 ; k < settings_.nb_samples_ ; k++) {
+                int nb_actifs = scene_.accumulate_pass(accumulator, pool, settings_.threshold_,
+                                                       settings_.wavefront_ ? &wavefront : nullptr, abandon) ;
+                if (interrupted(vue)) {
+                    break ;
+                }
+                accumulator.resolve(image) ;
+                image.to_rgb8(rgb) ;
+                publish(rgb, std::to_string(k + 1) + " échantillon(s) par pixel", true) ;
+                if (nb_actifs == 0) {
+                    break ;
+                }
+            }
+        }
+        else {
+            if (settings_.wavefront_) {
+                wavefront.render(image, pool, abandon) ;
+            }
+            else {
+                scene_.render_pixels(image, pool, abandon) ;
+            }
+            if (!interrupted(vue)) {
+                image.to_rgb8(rgb) ;
+                publish(rgb, "image complète", true) ;
+            }
+        }
+    }
+}
+
+bool Viewer::run() {
+    int largeur = settings_.width_ ;
+    int hauteur = settings_.height_ ;
+    Sdl sdl(largeur, hauteur, settings_.output_) ;
+    if (!sdl.isValid()) {
+        std::cerr << "Erreur lors de l'initialisation de SDL." << std::endl ;
+        return false ;
+    }
+    frame_event_ = SDL_RegisterEvents(1) ;
+    if (frame_event_ == static_cast<Uint32>(-1)) {
+        std::cerr << "Erreur lors de la création d'un évènement SDL : " << SDL_GetError() << std::endl ;
+        return false ;
+    }
+
+    std::thread rendu(&Viewer::render_loop, this) ;
+
+    float pas = PAS_CLAVIER * std::max(largeur, hauteur) ;
+    // Seul ce thread change camera_ : il peut la lire sans verrou. Le champ et la taille d'un pixel ne changent pas
+    float taille_pixel = camera_.get_du().longueur() ;
+    float degres_pixel = camera_.get_fov() / hauteur ;
+    std::vector<unsigned char> affichee ;
+    // La dernière image complète reçue, gardée à part : un aperçu affiché ensuite ne la remplace pas
+    std::vector<unsigned char> derniere_complete ;
+    bool quit = false ;
+    SDL_Event event ;
+    // On attend les évènements sans boucler à vide : le thread dort tant que rien ne bouge et qu'aucune image n'arrive
+    while (!quit && SDL_WaitEvent(&event)) {
+        if (event.type == frame_event_) {
+            std::string titre ;
+            {
+                std::lock_guard<std::mutex> verrou(mutex_) ;
+                affichee = frame_ ;
+                titre = title_ ;
+                if (frame_complete_) {
+                    derniere_complete = frame_ ;
+                }
+                frame_pending_ = false ;
+            }
+            sdl.display(affichee) ;
+            SDL_SetWindowTitle(sdl.getWindow(), (settings_.output_ + " - " + titre).c_str()) ;
+        }
+        else if (event.type == SDL_QUIT) {
+            quit = true ;
+        }
+        else if (event.type == SDL_KEYDOWN) {
+            // Les déplacements suivent les axes de la caméra : avancer, c'est aller où elle regarde
+            switch (event.key.keysym.sym) {
+                case SDLK_ESCAPE : quit = true ; break ;
+                case SDLK_UP : move_camera(0.0f, 0.0f, pas) ; break ;
+                case SDLK_DOWN : move_camera(0.0f, 0.0f, -pas) ; break ;
+                case SDLK_LEFT : move_camera(-pas, 0.0f, 0.0f) ; break ;
+                case SDLK_RIGHT : move_camera(pas, 0.0f, 0.0f) ; break ;
+                case SDLK_PAGEUP : move_camera(0.0f, -pas, 0.0f) ; break ;
+                case SDLK_PAGEDOWN : move_camera(0.0f, pas, 0.0f) ; break ;
+                default : break ;
+            }
+        }
+        else if (event.type == SDL_MOUSEMOTION && (event.motion.state & SDL_BUTTON_LMASK)) {
+            // La scène suit la souris : tirer vers la droite tourne la caméra vers la gauche
+            turn_camera(-event.motion.xrel * degres_pixel, event.motion.yrel * degres_pixel) ;
+        }
+        else if (event.type == SDL_MOUSEMOTION && (event.motion.state & SDL_BUTTON_RMASK)) {
+            // La vue glisse : ce qui est sur le plan net reste sous le pointeur
+            move_camera(-event.motion.xrel * taille_pixel, -event.motion.yrel * taille_pixel, 0.0f) ;
+        }
+        else if (event.type == SDL_MOUSEWHEEL) {
+            move_camera(0.0f, 0.0f, pas * event.wheel.y) ;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> verrou(mutex_) ;
+        stop_ = true ;
+    }
+    changed_.notify_one() ;
+    rendu.join() ;
+
+    // Enregistrement de la dernière image complète affichée, même si un aperçu l'a remplacée à l'écran depuis
+    if (!derniere_complete.empty()) {
+        save_image(settings_.output_, largeur, hauteur, derniere_complete) ;
+    }
+    return true ;
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef VIEWER_H
+#define VIEWER_H
+
+// La visionneuse interactive n'existe qu'avec la SDL
+#ifndef NO_SDL
+
+#include "Scene.h"
+#include "Sdl.h"
+#include "Camera.h"
+#include "RenderSettings.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief La classe Viewer affiche la scène dans une fenêtre où l'on déplace la caméra au clavier et à la souris
+ *
+ * Deux threads se partagent le travail :
+ * - le thread de rendu, qui a son propre pool de threads, recommence l'image à chaque déplacement de la caméra :
+ *   d'abord des aperçus en basse résolution (1/8, 1/4 puis 1/2), puis l'image complète, affinée passe après passe
+ *   en rendu progressif ;
+ * - le thread appelant attend les évènements SDL sans boucler à vide, note les déplacements de la caméra et affiche
+ *   chaque image publiée par le thread de rendu, qui le réveille avec un évènement SDL à lui.
+ *
+ * Commandes, dans le repère de la caméra : flèches pour avancer, reculer et aller de côté, Page haut et Page bas pour
+ * monter et descendre, glisser avec le bouton gauche pour tourner la caméra, avec le bouton droit pour faire glisser
+ * la vue, molette pour avancer, Echap pour quitter.
+ * À la fermeture, la dernière image complète est enregistrée dans le fichier de sortie.
+*/
+class Viewer {
+    private :
+        /**
+         * @brief La scène affichée, dont seul le thread de rendu change la caméra
+        */
+        Scene & scene_ ;
+        /**
+         * @brief Les paramètres du rendu (taille, threads, échantillons, mode, fichier)
+        */
+        RenderSettings settings_ ;
+
+        /**
+         * @brief Mutex qui protège camera_, frame_, title_, frame_complete_ et frame_pending_
+        */
+        std::mutex mutex_ ;
+        /**
+         * @brief Réveille le thread de rendu quand la caméra bouge ou que la fenêtre se ferme
+        */
+        std::condition_variable changed_ ;
+        /**
+         * @brief La caméra voulue par l'utilisateur, que le thread de rendu reprend à chaque nouvelle image
+        */
+        Camera camera_ ;
+        /**
+         * @brief Numéro de la vue, augmenté à chaque déplacement de la caméra : le rendu en cours est alors abandonné
+        */
+        std::atomic<unsigned long> generation_ ;
+        /**
+         * @brief Passe à true à la fermeture de la fenêtre pour arrêter le thread de rendu
+        */
+        std::atomic<bool> stop_ ;
+
+        /**
+         * @brief La dernière image publiée, à la taille de la fenêtre (les aperçus sont agrandis)
+        */
+        std::vector<unsigned char> frame_ ;
+        /**
+         * @brief Le titre de la fenêtre qui décrit la dernière image publiée
+        */
+        std::string title_ ;
+        /**
+         * @brief true si la dernière image publiée est en pleine résolution
+        */
+        bool frame_complete_ ;
+        /**
+         * @brief true si un évènement annonce déjà une image que la fenêtre n'a pas encore affichée
+        */
+        bool frame_pending_ ;
+        /**
+         * @brief Le type de l'évènement SDL qui annonce une nouvelle image
+        */
+        Uint32 frame_event_ ;
+
+        /**
+         * @brief Boucle du thread de rendu : recommence l'image à chaque vue, puis dort jusqu'à la suivante
+        */
+        void render_loop() ;
+        /**
+         * @brief Indique si le rendu de la vue doit être abandonné
+         *
+         * @param vue : le numéro de la vue en cours de rendu
+         *
+         * @return true si la caméra a bougé depuis ou si la fenêtre se ferme, false sinon
+        */
+        bool interrupted(unsigned long vue) const ;
+        /**
+         * @brief Publie une image et réveille le thread de la fenêtre pour qu'il l'affiche
+         *
+         * @param rgb : référence vers les pixels 8 bits de l'image, de la taille de la fenêtre
+         * @param title : référence vers le titre de la fenêtre
+         * @param complete : true si l'image est en pleine résolution
+        */
+        void publish(const std::vector<unsigned char> & rgb, const std::string & title, bool complete) ;
+        /**
+         * @brief Déplace la caméra voulue le long de ses axes et relance le rendu
+         *
+         * @param droite : le déplacement vers la droite de l'image
+         * @param bas : le déplacement vers le bas de l'image
+         * @param avant : le déplacement dans la direction visée
+        */
+        void move_camera(float droite, float bas, float avant) ;
+        /**
+         * @brief Tourne la caméra voulue et relance le rendu
+         *
+         * @param lacet : l'angle autour de la verticale, en degrés, positif vers la droite
+         * @param tangage : l'angle autour de l'axe horizontal, en degrés, positif vers le haut
+        */
+        void turn_camera(float lacet, float tangage) ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         *
+         * @param scene : référence vers la scène à afficher, qui doit vivre plus longtemps que la visionneuse
+         * @param settings : référence vers les paramètres du rendu
+        */
+        Viewer(Scene & scene, const RenderSettings & settings) ;
+
+        /**
+         * @brief Ouvre la fenêtre et la fait vivre jusqu'à sa fermeture
+         *
+         * @return true si la fenêtre a pu s'ouvrir, false sinon
+        */
+        bool run() ;
+} ;
+
+#endif
+
+#endif
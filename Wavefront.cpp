@@ -0,0 +1,315 @@
+#include "Wavefront.h"
+#include "Packet.h"
+#include "RenderStats.h"
+#include "Trace.h"
+#include <algorithm>
+
+// Nombre maximum de chemins tracés ensemble : borne la taille des files (une centaine d'octets par chemin)
+const int TAILLE_VAGUE = 1 << 16 ;
+
+// Nombre de rayons d'une tâche du pool de threads : chaque étape découpe sa file en lots de cette taille
+const int TAILLE_LOT = 1024 ;
+
+void RayQueue::resize(int capacity) {
+    ox_.resize(capacity) ; oy_.resize(capacity) ; oz_.resize(capacity) ;
+    dx_.resize(capacity) ; dy_.resize(capacity) ; dz_.resize(capacity) ;
+    path_.resize(capacity) ;
+}
+
+void RayQueue::set(int i, const Ray3f & ray, int path) {
+    Vector3f c = ray.get_centre() ;
+    Vector3f d = ray.get_direction() ;
+    ox_[i] = c.get_x() ; oy_[i] = c.get_y() ; oz_[i] = c.get_z() ;
+    dx_[i] = d.get_x() ; dy_[i] = d.get_y() ; dz_[i] = d.get_z() ;
+    path_[i] = path ;
+}
+
+Ray3f RayQueue::get(int i) const {
+    return Ray3f(Vector3f(ox_[i], oy_[i], oz_[i]), Vector3f(dx_[i], dy_[i], dz_[i])) ;
+}
+
+void RayQueue::copy(int i, const RayQueue & queue, int j) {
+    ox_[i] = queue.ox_[j] ; oy_[i] = queue.oy_[j] ; oz_[i] = queue.oz_[j] ;
+    dx_[i] = queue.dx_[j] ; dy_[i] = queue.dy_[j] ; dz_[i] = queue.dz_[j] ;
+    path_[i] = queue.path_[j] ;
+}
+
+Wavefront::Wavefront(const Scene & scene) : scene_(scene) {
+}
+
+void Wavefront::reserve(int nb_paths) {
+    // Chaque intersection donne au plus get_shadow_rays() rayons d'ombre, rangés à partir du début de son lot
+    int nb_ombres = nb_paths * scene_.get_shadow_rays() ;
+    if (static_cast<int>(ombre_t_max_.size()) < nb_ombres) {
+        ombres_.resize(nb_ombres) ;
+        ombre_t_max_.resize(nb_ombres) ;
+        ombre_r_.resize(nb_ombres) ; ombre_g_.resize(nb_ombres) ; ombre_b_.resize(nb_ombres) ;
+    }
+    if (static_cast<int>(pixel_.size()) >= nb_paths) {
+        return ;
+    }
+    pixel_.resize(nb_paths) ;
+    rng_.resize(nb_paths) ;
+    profondeur_.resize(nb_paths) ;
+    poids_r_.resize(nb_paths) ; poids_g_.resize(nb_paths) ; poids_b_.resize(nb_paths) ;
+    couleur_r_.resize(nb_paths) ; couleur_g_.resize(nb_paths) ; couleur_b_.resize(nb_paths) ;
+
+    // Chaque rayon de la file donne au plus un rebond, rangé à partir du début de son lot :
+    // aucune file de rayons ne dépasse donc le nombre de chemins
+    rays_.resize(nb_paths) ;
+    rebonds_lots_.resize(nb_paths) ;
+    hit_t_.resize(nb_paths) ; hit_shape_.resize(nb_paths) ; hit_primitive_.resize(nb_paths) ;
+    int nb_lots = (nb_paths + TAILLE_LOT - 1) / TAILLE_LOT ;
+    nb_rebonds_lot_.resize(nb_lots) ;
+    nb_ombres_lot_.resize(nb_lots) ;
+}
+
+bool Wavefront::continue_path(int rebond, int p) {
+    Vector3f poids(poids_r_[p], poids_g_[p], poids_b_[p]) ;
+    if (!Scene::russian_roulette(rebond, &poids, rng_[p])) {
+        return false ;
+    }
+    poids_r_[p] = poids.get_x() ;
+    poids_g_[p] = poids.get_y() ;
+    poids_b_[p] = poids.get_z() ;
+    return true ;
+}
+
+bool Wavefront::trace(int nb_paths, ThreadPool & pool, bool indirect, const std::function<bool()> & cancelled) {
+    const CompiledScene & compiled = scene_.get_compiled() ;
+    for (int p = 0 ; p < nb_paths ; p++) {
+        profondeur_[p] = 0 ;
+        poids_r_[p] = 1.0f ; poids_g_[p] = 1.0f ; poids_b_[p] = 1.0f ;
+        couleur_r_[p] = 0.0f ; couleur_g_[p] = 0.0f ; couleur_b_[p] = 0.0f ;
+    }
+
+    int nb_ombres_max = scene_.get_shadow_rays() ;
+    int nb_rays = nb_paths ;
+    for (bool primaires = true ; nb_rays > 0 ; primaires = false) {
+        // Une vague abandonnée s'arrête entre deux rebonds
+        if (cancelled && cancelled()) {
+            return false ;
+        }
+        int nb_lots = (nb_rays + TAILLE_LOT - 1) / TAILLE_LOT ;
+
+        // -- Intersection : les rayons primaires, voisins dans la file, sont tracés par paquets.
+        // Les rebonds partent dans toutes les directions : en paquet, chaque noeud serait visité pour
+        // le moindre rayon qui le traverse, ils sont donc tracés un par un
+        pool.parallel_for(nb_lots, [&](int lot) {
+            RT_TRACE("intersection") ;
+            int debut = lot * TAILLE_LOT ;
+            int fin = std::min(debut + TAILLE_LOT, nb_rays) ;
+            RT_STATS_BATCH(pixel_.data(), primaires ? nullptr : rays_.path_.data(), debut, fin) ;
+            if (!primaires) {
+                for (int i = debut ; i < fin ; i++) {
+                    RT_STATS_PIXELS(&pixel_[rays_.path_[i]], 1) ;
+                    HitRecord hit = scene_.closest_hit(rays_.get(i)) ;
+                    hit_t_[i] = hit.t_ ;
+                    hit_shape_[i] = hit.shape_id_ ;
+                    hit_primitive_[i] = hit.primitive_ ;
+                }
+                return ;
+            }
+            Ray3f rays[PACKET_SIZE] ;
+            HitRecord hits[PACKET_SIZE] ;
+            for (int i = debut ; i < fin ; i += PACKET_SIZE) {
+                int nb = std::min(PACKET_SIZE, fin - i) ;
+                for (int k = 0 ; k < nb ; k++) {
+                    rays[k] = rays_.get(i + k) ;
+                }
+                // Les rayons primaires sont encore dans l'ordre des chemins
+                RT_STATS_PIXELS(&pixel_[i], nb) ;
+                scene_.closest_hit_packet(rays, nb, hits) ;
+                for (int k = 0 ; k < nb ; k++) {
+                    hit_t_[i + k] = hits[k].t_ ;
+                    hit_shape_[i + k] = hits[k].shape_id_ ;
+                    hit_primitive_[i + k] = hits[k].primitive_ ;
+                }
+            }
+        }) ;
+
+        // -- Eclairage : chaque intersection donne au plus nb_ombres_max rayons d'ombre et un rebond,
+        // rangés au début du lot pour que le résultat ne dépende pas de l'ordre des threads
+        pool.parallel_for(nb_lots, [&](int lot) {
+            RT_TRACE("éclairage") ;
+            int debut = lot * TAILLE_LOT ;
+            int debut_ombres = debut * nb_ombres_max ;
+            int fin = std::min(debut + TAILLE_LOT, nb_rays) ;
+            RT_STATS_BATCH(pixel_.data(), rays_.path_.data(), debut, fin) ;
+            int nb_rebonds = 0 ;
+            int nb_ombres = 0 ;
+            for (int i = debut ; i < fin ; i++) {
+                HitRecord hit ;
+                hit.t_ = hit_t_[i] ;
+                hit.shape_id_ = hit_shape_[i] ;
+                hit.primitive_ = hit_primitive_[i] ;
+                if (!hit.hit()) {
+                    continue ;
+                }
+                int p = rays_.path_[i] ;
+                Ray3f ray = rays_.get(i) ;
+                Vector3f P,N ;
+                scene_.hit_point(ray, hit, &P, &N) ;
+                // Même boucle que Scene::shade : le dernier rebond permis est éclairé, mais ne relance pas de rayon
+                int rebond = profondeur_[p]++ ;
+                bool dernier = (rebond + 1 == NB_REBONDS_MAX) ;
+
+                if (compiled.get_miroir(hit.shape_id_)) {
+                    if (!dernier && (!indirect || continue_path(rebond, p))) {
+                        rebonds_lots_.set(debut + nb_rebonds++, scene_.reflected_ray(ray, P, N), p) ;
+                    }
+                    continue ;
+                }
+
+                Vector3f decalage = scene_.light_offset(P, indirect ? &rng_[p] : nullptr) ;
+                for (int k = 0 ; k < nb_ombres_max ; k++) {
+                    Ray3f ray_light ;
+                    float d_light ;
+                    Material lumiere = scene_.direct_light(P, N, hit.shape_id_, decalage, k, &ray_light, &d_light) ;
+                    int j = debut_ombres + nb_ombres++ ;
+                    ombres_.set(j, ray_light, p) ;
+                    ombre_t_max_[j] = d_light ;
+                    ombre_r_[j] = poids_r_[p] * lumiere.get_r() ;
+                    ombre_g_[j] = poids_g_[p] * lumiere.get_g() ;
+                    ombre_b_[j] = poids_b_[p] * lumiere.get_b() ;
+                }
+
+                // Même condition que dans Scene::shade : pas de rebond sur une normale nulle
+                if (indirect && !dernier && dot(N,N) > 0.0f) {
+                    Ray3f rebond_diffus = scene_.diffuse_ray(P, N, rng_[p]) ;
+                    Vector3f albedo = compiled.get_albedo(hit.shape_id_) ;
+                    poids_r_[p] *= albedo.get_x() ;
+                    poids_g_[p] *= albedo.get_y() ;
+                    poids_b_[p] *= albedo.get_z() ;
+                    if (continue_path(rebond, p)) {
+                        rebonds_lots_.set(debut + nb_rebonds++, rebond_diffus, p) ;
+                    }
+                }
+            }
+            nb_rebonds_lot_[lot] = nb_rebonds ;
+            nb_ombres_lot_[lot] = nb_ombres ;
+        }) ;
+
+        // -- Ombres : les rayons d'ombre d'un chemin sont tous dans le même lot, il n'y a donc pas d'écriture concurrente
+        pool.parallel_for(nb_lots, [&](int lot) {
+            RT_TRACE("ombres") ;
+            int debut = lot * TAILLE_LOT * nb_ombres_max ;
+            RT_STATS_BATCH(pixel_.data(), ombres_.path_.data(), debut, debut + nb_ombres_lot_[lot]) ;
+            for (int j = debut ; j < debut + nb_ombres_lot_[lot] ; j++) {
+                RT_STATS_PIXELS(&pixel_[ombres_.path_[j]], 1) ;
+                if (!scene_.occluded(ombres_.get(j), ombre_t_max_[j])) {
+                    int p = ombres_.path_[j] ;
+                    couleur_r_[p] += ombre_r_[j] ;
+                    couleur_g_[p] += ombre_g_[j] ;
+                    couleur_b_[p] += ombre_b_[j] ;
+                }
+            }
+        }) ;
+
+        // -- Compaction : les rebonds de chaque lot sont mis bout à bout pour former la file de l'étape suivante
+        std::vector<int> debuts(nb_lots) ;
+        int total = 0 ;
+        for (int lot = 0 ; lot < nb_lots ; lot++) {
+            debuts[lot] = total ;
+            total += nb_rebonds_lot_[lot] ;
+        }
+        pool.parallel_for(nb_lots, [&](int lot) {
+            RT_TRACE("compaction") ;
+            for (int k = 0 ; k < nb_rebonds_lot_[lot] ; k++) {
+                rays_.copy(debuts[lot] + k, rebonds_lots_, lot * TAILLE_LOT + k) ;
+            }
+        }) ;
+        nb_rays = total ;
+    }
+    return true ;
+}
+
+void Wavefront::render(Framebuffer & image, ThreadPool & pool, const std::function<bool()> & cancelled) {
+    RT_TRACE("calcul des pixels") ;
+    int largeur = image.get_width() ;
+    int nb_pixels = largeur * image.get_height() ;
+    reserve(std::min(nb_pixels, TAILLE_VAGUE)) ;
+
+    for (int premier = 0 ; premier < nb_pixels ; premier += TAILLE_VAGUE) {
+        int nb_paths = std::min(TAILLE_VAGUE, nb_pixels - premier) ;
+
+        // -- Génération : un rayon primaire par pixel, dans l'ordre des lignes pour que les paquets soient cohérents
+        pool.parallel_for((nb_paths + TAILLE_LOT - 1) / TAILLE_LOT, [&](int lot) {
+            RT_TRACE("génération") ;
+            int fin = std::min((lot + 1) * TAILLE_LOT, nb_paths) ;
+            RT_STATS_BATCH(pixel_.data(), nullptr, lot * TAILLE_LOT, fin) ;
+            for (int p = lot * TAILLE_LOT ; p < fin ; p++) {
+                pixel_[p] = premier + p ;
+                RT_STATS_PIXELS(&pixel_[p], 1) ;
+                rays_.set(p, scene_.get_camera_ray(pixel_[p] % largeur, pixel_[p] / largeur), p) ;
+            }
+        }) ;
+
+        if (!trace(nb_paths, pool, false, cancelled)) {
+            return ;
+        }
+
+        pool.parallel_for((nb_paths + TAILLE_LOT - 1) / TAILLE_LOT, [&](int lot) {
+            int fin = std::min((lot + 1) * TAILLE_LOT, nb_paths) ;
+            RT_STATS_BATCH(pixel_.data(), nullptr, lot * TAILLE_LOT, fin) ;
+            for (int p = lot * TAILLE_LOT ; p < fin ; p++) {
+                RT_STATS_PIXELS(&pixel_[p], 1) ;
+                RT_STAT_DEPTH(profondeur_[p]) ;
+                image.set_pixel(pixel_[p] % largeur, pixel_[p] / largeur,
+                                Material(couleur_r_[p], couleur_g_[p], couleur_b_[p], 0.0f)) ;
+            }
+        }) ;
+    }
+}
+
+void Wavefront::add_samples(Accumulator & accumulator, ThreadPool & pool, const std::function<bool()> & cancelled) {
+    int largeur = accumulator.get_width() ;
+    int nb_pixels = largeur * accumulator.get_height() ;
+    reserve(std::min(nb_pixels, TAILLE_VAGUE)) ;
+
+    // Seuls les pixels qui n'ont pas convergé reçoivent un échantillon
+    std::vector<int> actifs ;
+    actifs.reserve(nb_pixels) ;
+    for (int pixel = 0 ; pixel < nb_pixels ; pixel++) {
+        if (!accumulator.is_converged(pixel % largeur, pixel / largeur)) {
+            actifs.push_back(pixel) ;
+        }
+    }
+    int nb_actifs = static_cast<int>(actifs.size()) ;
+
+    for (int premier = 0 ; premier < nb_actifs ; premier += TAILLE_VAGUE) {
+        int nb_paths = std::min(TAILLE_VAGUE, nb_actifs - premier) ;
+
+        pool.parallel_for((nb_paths + TAILLE_LOT - 1) / TAILLE_LOT, [&](int lot) {
+            RT_TRACE("génération") ;
+            int fin = std::min((lot + 1) * TAILLE_LOT, nb_paths) ;
+            RT_STATS_BATCH(pixel_.data(), nullptr, lot * TAILLE_LOT, fin) ;
+            for (int p = lot * TAILLE_LOT ; p < fin ; p++) {
+                int pixel = actifs[premier + p] ;
+                int x = pixel % largeur ;
+                int y = pixel / largeur ;
+                pixel_[p] = pixel ;
+                RT_STATS_PIXELS(&pixel_[p], 1) ;
+                // Le même générateur que dans Scene::accumulate_pass
+                uint32_t sample = static_cast<uint32_t>(accumulator.get_count(x, y)) ;
+                rng_[p] = Rng::for_pixel(static_cast<uint32_t>(pixel), sample) ;
+                rays_.set(p, scene_.get_camera_ray(x, y, &rng_[p]), p) ;
+            }
+        }) ;
+
+        if (!trace(nb_paths, pool, true, cancelled)) {
+            return ;
+        }
+
+        pool.parallel_for((nb_paths + TAILLE_LOT - 1) / TAILLE_LOT, [&](int lot) {
+            int fin = std::min((lot + 1) * TAILLE_LOT, nb_paths) ;
+            RT_STATS_BATCH(pixel_.data(), nullptr, lot * TAILLE_LOT, fin) ;
+            for (int p = lot * TAILLE_LOT ; p < fin ; p++) {
+                RT_STATS_PIXELS(&pixel_[p], 1) ;
+                RT_STAT_DEPTH(profondeur_[p]) ;
+                accumulator.add_sample(pixel_[p] % largeur, pixel_[p] / largeur,
+                                       Material(couleur_r_[p], couleur_g_[p], couleur_b_[p], 0.0f)) ;
+            }
+        }) ;
+    }
+}
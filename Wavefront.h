@@ -0,0 +1,206 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include "Scene.h"
+#include "Ray3f.h"
+#include "Material.h"
+#include "Framebuffer.h"
+#include "Accumulator.h"
+#include "ThreadPool.h"
+#include "Rng.h"
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Une file de rayons rangée en structure de tableaux, une coordonnée par tableau
+ *
+ * Chaque rayon appartient à un chemin (un pixel) de la vague, dont l'indice est dans path_.
+ *
+ * @see Wavefront
+*/
+struct RayQueue {
+    /**
+     * @brief Les origines des rayons
+    */
+    std::vector<float> ox_, oy_, oz_ ;
+    /**
+     * @brief Les directions des rayons
+    */
+    std::vector<float> dx_, dy_, dz_ ;
+    /**
+     * @brief L'indice du chemin auquel appartient chaque rayon
+    */
+    std::vector<int> path_ ;
+
+    /**
+     * @brief Change la capacité de la file
+     *
+     * @param capacity : le nombre de rayons que la file peut contenir
+    */
+    void resize(int capacity) ;
+    /**
+     * @brief Range un rayon à la place i de la file
+     *
+     * @param i : la place du rayon
+     * @param ray : référence vers le rayon
+     * @param path : l'indice du chemin du rayon
+    */
+    void set(int i, const Ray3f & ray, int path) ;
+    /**
+     * @brief Donne le rayon rangé à la place i de la file
+     *
+     * @param i : la place du rayon
+     *
+     * @return Le rayon
+    */
+    Ray3f get(int i) const ;
+    /**
+     * @brief Copie le rayon de la place j d'une autre file à la place i de celle-ci
+     *
+     * @param i : la place d'arrivée
+     * @param queue : référence vers la file de départ
+     * @param j : la place de départ
+    */
+    void copy(int i, const RayQueue & queue, int j) ;
+} ;
+
+/**
+ * @brief La classe Wavefront est un second intégrateur, qui trace les chemins par vagues au lieu de pixel par pixel
+ *
+ * Scene::get_color suit un chemin de bout en bout : intersection, miroir, rayon d'ombre et éclairage sont
+ * mêlés pour chaque pixel. Ici, une vague de chemins (jusqu'à TAILLE_VAGUE pixels) avance étape par étape :
+ * - génération des rayons primaires de tous les pixels de la vague ;
+ * - intersection de tous les rayons de la file, par paquets de rayons voisins ;
+ * - éclairage de toutes les intersections : chacune donne Scene::get_shadow_rays() rayons d'ombre et au plus
+ *   un rayon de rebond ;
+ * - test de tous les rayons d'ombre, qui ajoutent leur lumière au chemin s'ils ne sont pas cachés.
+ * Les deux dernières étapes recommencent sur les rebonds jusqu'à ce que la file soit vide. Chaque étape est un
+ * parcours de tableaux (structure de tableaux) réparti par lots sur le pool de threads.
+ *
+ * Les files sont gardées d'une vague et d'une passe à l'autre, pour ne pas être réallouées.
+ * Chaque chemin fait exactement les mêmes calculs que dans Scene::shade, avec les mêmes nombres aléatoires :
+ * l'image est identique bit à bit à celle de l'intégrateur récursif.
+ *
+ * @see Scene, RayQueue
+*/
+class Wavefront {
+    private :
+        /**
+         * @brief La scène tracée
+        */
+        const Scene & scene_ ;
+
+        /**
+         * @brief Le pixel de chaque chemin de la vague (x + y * largeur)
+        */
+        std::vector<int> pixel_ ;
+        /**
+         * @brief Le générateur aléatoire de chaque chemin, en rendu progressif
+        */
+        std::vector<Rng> rng_ ;
+        /**
+         * @brief Le nombre d'intersections déjà éclairées de chaque chemin
+        */
+        std::vector<int> profondeur_ ;
+        /**
+         * @brief La fraction de la lumière qui revient au pixel depuis le dernier rebond de chaque chemin
+        */
+        std::vector<float> poids_r_, poids_g_, poids_b_ ;
+        /**
+         * @brief La lumière accumulée par chaque chemin
+        */
+        std::vector<float> couleur_r_, couleur_g_, couleur_b_ ;
+
+        /**
+         * @brief Les rayons à intersecter
+        */
+        RayQueue rays_ ;
+        /**
+         * @brief Les rebonds produits par l'éclairage, rangés par lot avant d'être compactés dans rays_
+        */
+        RayQueue rebonds_lots_ ;
+        /**
+         * @brief Les rayons d'ombre produits par l'éclairage, rangés par lot
+        */
+        RayQueue ombres_ ;
+        /**
+         * @brief La distance à la lumière de chaque rayon d'ombre
+        */
+        std::vector<float> ombre_t_max_ ;
+        /**
+         * @brief La lumière qu'apporte chaque rayon d'ombre s'il n'est pas caché
+        */
+        std::vector<float> ombre_r_, ombre_g_, ombre_b_ ;
+        /**
+         * @brief L'intersection la plus proche de chaque rayon de rays_
+        */
+        std::vector<float> hit_t_ ;
+        std::vector<int> hit_shape_, hit_primitive_ ;
+        /**
+         * @brief Le nombre de rebonds et de rayons d'ombre produits par chaque lot
+        */
+        std::vector<int> nb_rebonds_lot_, nb_ombres_lot_ ;
+
+        /**
+         * @brief Trace tous les chemins de la vague, dont les rayons primaires sont dans rays_
+         *
+         * @param nb_paths : le nombre de chemins de la vague
+         * @param pool : référence vers le pool de threads
+         * @param indirect : true pour ajouter l'éclairage indirect (les générateurs rng_ sont alors utilisés)
+         * @param cancelled : référence vers le test d'abandon, appelé avant chaque rebond, vide pour aller jusqu'au bout
+         *
+         * @return false si la vague a été abandonnée, ses couleurs sont alors incomplètes
+        */
+        bool trace(int nb_paths, ThreadPool & pool, bool indirect, const std::function<bool()> & cancelled) ;
+        /**
+         * @brief Alloue les files pour une vague de nb_paths chemins
+         *
+         * @param nb_paths : le nombre de chemins de la vague
+        */
+        void reserve(int nb_paths) ;
+        /**
+         * @brief Tire la roulette russe pour le chemin p après un rebond, et met à jour son poids
+         *
+         * @param rebond : le numéro du rebond qui vient d'être calculé
+         * @param p : l'indice du chemin
+         * @see Scene::russian_roulette
+         *
+         * @return true si le chemin continue, false sinon
+        */
+        bool continue_path(int rebond, int p) ;
+
+    public :
+        /**
+         * @brief Constructeur paramétré
+         *
+         * @param scene : référence vers la scène à tracer, qui doit rester valide
+        */
+        explicit Wavefront(const Scene & scene) ;
+
+        /**
+         * @brief Calcule la couleur de tous les pixels de l'image en éclairage direct
+         *
+         * Même résultat que Scene::render_pixels. Dès que cancelled répond true, les vagues restantes ne sont plus
+         * tracées et l'image reste incomplète.
+         *
+         * @param image : référence vers l'image qui reçoit la couleur linéaire de chaque pixel, sa taille donne celle du rendu
+         * @param pool : référence vers le pool de threads
+         * @param cancelled : référence vers le test d'abandon, vide pour aller jusqu'au bout
+         * @see Scene::render_pixels
+        */
+        void render(Framebuffer & image, ThreadPool & pool, const std::function<bool()> & cancelled = std::function<bool()>()) ;
+
+        /**
+         * @brief Ajoute un échantillon, éclairage indirect compris, à chaque pixel de l'accumulateur qui n'a pas convergé
+         *
+         * Le générateur de chaque pixel est celui de Scene::accumulate_pass.
+         *
+         * @param accumulator : référence vers l'accumulateur, sa taille donne celle du rendu
+         * @param pool : référence vers le pool de threads
+         * @param cancelled : référence vers le test d'abandon, vide pour aller jusqu'au bout
+         * @see Scene::accumulate_pass
+        */
+        void add_samples(Accumulator & accumulator, ThreadPool & pool, const std::function<bool()> & cancelled = std::function<bool()>()) ;
+} ;
+
+#endif
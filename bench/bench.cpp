@@ -0,0 +1,344 @@
+// Banc d'essai du lancer de rayons : micro-mesures des noyaux d'intersection et d'éclairage,
+// puis débit de bout en bout (Mrayons/s) sur la scène de main.cpp et sur des scènes générées.
+// Les résultats sont écrits en JSON pour comparer les versions entre elles.
+//
+// Compilation, depuis la racine du dépôt :
+// g++ -O2 -Wall -Wextra -pthread -DNO_SDL -DRT_COUNT_RAYS -o benchmark bench/bench.cpp $(ls *.cpp | grep -v main.cpp)
+// Utilisation :
+// ./benchmark [--size N] [--threads N] [--repeat N] [--rays N] [--scene S]... [--output F]
+
+#include "../Scene.h"
+#include "../Scenes.h"
+#include "../Sphere.h"
+#include "../Quad.h"
+#include "../Framebuffer.h"
+#include "../Accumulator.h"
+#include "../ThreadPool.h"
+#include "../Wavefront.h"
+#include "../RenderStats.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef RT_COUNT_RAYS
+# error "Le banc d'essai doit être compilé avec -DRT_COUNT_RAYS pour compter les rayons"
+#endif
+
+using namespace std;
+
+// Empêche le compilateur de supprimer les calculs mesurés
+static volatile double puits = 0.0 ;
+
+// Le meilleur temps (en secondes) de plusieurs exécutions : le moins perturbé par le reste de la machine
+static double best_time(int repeat, const function<void()> & job) {
+    double meilleur = 1E30 ;
+    for (int k = 0 ; k < repeat ; k++) {
+        auto debut = chrono::steady_clock::now() ;
+        job() ;
+        chrono::duration<double> duree = chrono::steady_clock::now() - debut ;
+        meilleur = min(meilleur, duree.count()) ;
+    }
+    return meilleur ;
+}
+
+// Une chaîne JSON, entre guillemets : les noms de scène viennent de la ligne de commande et peuvent tout contenir
+static string json_string(const string & texte) {
+    ostringstream sortie ;
+    sortie << '"' ;
+    for (char c : texte) {
+        unsigned char u = static_cast<unsigned char>(c) ;
+        if (c == '"' || c == '\\') {
+            sortie << '\\' << c ;
+        }
+        else if (u < 0x20) {
+            // Les caractères de contrôle s'écrivent \u00XX
+            const char * hexa = "0123456789abcdef" ;
+            sortie << "\\u00" << hexa[u >> 4] << hexa[u & 15] ;
+        }
+        else {
+            sortie << c ;
+        }
+    }
+    sortie << '"' ;
+    return sortie.str() ;
+}
+
+// Rayons primaires : de la caméra vers des pixels tirés au hasard, toujours les mêmes d'une version à l'autre
+static vector<Ray3f> primary_rays(const Scene & scene, int size, int nb_rays) {
+    mt19937 generateur(42) ;
+    uniform_int_distribution<int> pixel(0, size - 1) ;
+    vector<Ray3f> rays ;
+    rays.reserve(nb_rays) ;
+    for (int i = 0 ; i < nb_rays ; i++) {
+        rays.push_back(scene.get_camera_ray(pixel(generateur), pixel(generateur))) ;
+    }
+    return rays ;
+}
+
+// Rayons primaires cohérents : ceux des pixels de l'image, ligne par ligne, comme pendant le rendu
+static vector<Ray3f> scanline_rays(const Scene & scene, int size, int nb_rays) {
+    vector<Ray3f> rays ;
+    rays.reserve(nb_rays) ;
+    for (int i = 0 ; i < nb_rays ; i++) {
+        int pixel = i % (size * size) ;
+        rays.push_back(scene.get_camera_ray(pixel % size, pixel / size)) ;
+    }
+    return rays ;
+}
+
+// Rayons secondaires : depuis des points de la pièce, dans des directions quelconques
+static vector<Ray3f> random_rays(int size, int nb_rays) {
+    mt19937 generateur(4242) ;
+    uniform_real_distribution<float> uniforme(0.0f, 1.0f) ;
+    vector<Ray3f> rays ;
+    rays.reserve(nb_rays) ;
+    for (int i = 0 ; i < nb_rays ; i++) {
+        Vector3f origine(size * (0.1f + 0.8f * uniforme(generateur)), size * (0.1f + 0.8f * uniforme(generateur)), size * 0.5f * uniforme(generateur)) ;
+        Vector3f direction ;
+        do {
+            direction = Vector3f(2 * uniforme(generateur) - 1, 2 * uniforme(generateur) - 1, 2 * uniforme(generateur) - 1) ;
+        } while (direction.norme2() > 1.0f || direction.norme2() < 1E-4f) ;
+        direction.normalize() ;
+        rays.push_back(Ray3f(origine, direction)) ;
+    }
+    return rays ;
+}
+
+// Une micro-mesure : name sur rays.size() rayons, l'objet JSON est ajouté à sortie
+static void run_micro(ostringstream & sortie, bool & premier, const string & name, const vector<Ray3f> & rays, int repeat,
+                  const function<double(const Ray3f &, size_t)> & kernel) {
+    long long hits = 0 ;
+    double secondes = best_time(repeat, [&]() {
+        double somme = 0.0 ;
+        hits = 0 ;
+        for (size_t i = 0 ; i < rays.size() ; i++) {
+            double v = kernel(rays[i], i) ;
+            if (v != 0.0) {
+                hits++ ;
+            }
+            somme += v ;
+        }
+        puits = puits + somme ;
+    }) ;
+    double nb = static_cast<double>(rays.size()) ;
+    sortie << (premier ? "" : ",") << "\n    {\"name\": " << json_string(name) << ", \"rays\": " << rays.size()
+           << ", \"hits\": " << hits << ", \"seconds\": " << secondes
+           << ", \"ns_per_ray\": " << secondes * 1E9 / nb << ", \"mrays_per_s\": " << nb / secondes / 1E6 << "}" ;
+    premier = false ;
+    cerr << name << " : " << secondes * 1E9 / nb << " ns/rayon" << endl ;
+}
+
+// Une micro-mesure par paquets : les rayons consécutifs de rays sont tracés PACKET_SIZE par PACKET_SIZE
+static void run_micro_packet(ostringstream & sortie, bool & premier, const string & name, const Scene & scene,
+                             const vector<Ray3f> & rays, int repeat) {
+    long long hits = 0 ;
+    double secondes = best_time(repeat, [&]() {
+        HitRecord resultats[PACKET_SIZE] ;
+        double somme = 0.0 ;
+        hits = 0 ;
+        for (size_t i = 0 ; i < rays.size() ; i += PACKET_SIZE) {
+            int nb = static_cast<int>(min(rays.size() - i, static_cast<size_t>(PACKET_SIZE))) ;
+            scene.closest_hit_packet(&rays[i], nb, resultats) ;
+            for (int k = 0 ; k < nb ; k++) {
+                if (resultats[k].hit()) {
+                    hits++ ;
+                    somme += resultats[k].t_ ;
+                }
+            }
+        }
+        puits = puits + somme ;
+    }) ;
+    double nb = static_cast<double>(rays.size()) ;
+    sortie << (premier ? "" : ",") << "\n    {\"name\": " << json_string(name) << ", \"rays\": " << rays.size()
+           << ", \"packet_size\": " << PACKET_SIZE << ", \"hits\": " << hits << ", \"seconds\": " << secondes
+           << ", \"ns_per_ray\": " << secondes * 1E9 / nb << ", \"mrays_per_s\": " << nb / secondes / 1E6 << "}" ;
+    premier = false ;
+    cerr << name << " : " << secondes * 1E9 / nb << " ns/rayon" << endl ;
+}
+
+// Une mesure de bout en bout : rendu complet de la scène, avec le nombre de rayons de chaque sorte
+static void end_to_end(ostringstream & sortie, bool & premier, const string & scene_name, const Scene & scene,
+                       int size, int nb_threads, int nb_passes, int repeat, bool use_wavefront) {
+    bool path = nb_passes > 0 ;
+    ThreadPool pool(nb_threads) ;
+    Wavefront wavefront(scene) ;
+    Framebuffer image(size, size) ;
+    Accumulator accumulator ;
+    unsigned long long primary = 0, closest = 0, shadow = 0 ;
+
+    double secondes = best_time(repeat, [&]() {
+        StatCounters debut = total_stats() ;
+        if (path) {
+            accumulator.reset(size, size) ;
+            for (int k = 0 ; k < nb_passes ; k++) {
+                scene.accumulate_pass(accumulator, pool, 0.0f, use_wavefront ? &wavefront : nullptr) ;
+            }
+            accumulator.resolve(image) ;
+        }
+        else if (use_wavefront) {
+            wavefront.render(image, pool) ;
+        }
+        else {
+            scene.render_pixels(image, nb_threads) ;
+        }
+        StatCounters fin = total_stats() ;
+        primary = fin.primary_ - debut.primary_ ;
+        closest = fin.closest_ - debut.closest_ ;
+        shadow = fin.shadow_ - debut.shadow_ ;
+    }) ;
+    puits = puits + image.get_pixel(size / 2, size / 2)[0] ;
+
+    double total = static_cast<double>(closest + shadow) ;
+    sortie << (premier ? "" : ",") << "\n    {\"scene\": " << json_string(scene_name) << ", \"mode\": \"" << (path ? "path" : "direct")
+           << "\", \"integrator\": \"" << (use_wavefront ? "wavefront" : "recursive")
+           << "\", \"shapes\": " << scene.get_shapes().size() << ", \"width\": " << size << ", \"height\": " << size
+           << ", \"samples\": " << (path ? nb_passes : 1) << ", \"seconds\": " << secondes
+           << ", \"primary_rays\": " << primary << ", \"secondary_rays\": " << closest - primary
+           << ", \"shadow_rays\": " << shadow << ", \"total_rays\": " << closest + shadow
+           << ", \"mrays_per_s\": " << total / secondes / 1E6 << "}" ;
+    premier = false ;
+    cerr << scene_name << " (" << (path ? "path" : "direct") << ", " << (use_wavefront ? "wavefront" : "recursive") << ") : " << total / secondes / 1E6 << " Mrayons/s" << endl ;
+}
+
+static void usage(const char * programme) {
+    cerr << "Utilisation : " << programme << " [options]" << endl
+         << "  --size N       côté des images de bout en bout (500 par défaut)" << endl
+         << "  --threads N    nombre de threads du rendu de bout en bout (0 = tous les coeurs, par défaut)" << endl
+         << "  --repeat N     nombre d'exécutions de chaque mesure, on garde la meilleure (3 par défaut)" << endl
+         << "  --rays N       nombre de rayons des micro-mesures (262144 par défaut)" << endl
+         << "  --passes N     nombre de passes du rendu de bout en bout en mode path (4 par défaut)" << endl
+         << "  --scene S      scène de bout en bout, peut être répété (defaut, spheres:1000 et spheres:10000 par défaut)" << endl
+         << "  --output F     fichier JSON produit (sortie standard par défaut)" << endl ;
+}
+
+int main(int argc, char * argv[]) {
+    int size = 500 ;
+    int nb_threads = 0 ;
+    int repeat = 3 ;
+    int nb_rays = 1 << 18 ;
+    int nb_passes = 4 ;
+    string output ;
+    vector<string> scenes ;
+
+    for (int i = 1 ; i < argc ; i++) {
+        bool has_value = i + 1 < argc ;
+        if (strcmp(argv[i], "--size") == 0 && has_value) {
+            size = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            nb_threads = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && has_value) {
+            repeat = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--rays") == 0 && has_value) {
+            nb_rays = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--passes") == 0 && has_value) {
+            nb_passes = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--scene") == 0 && has_value) {
+            scenes.push_back(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            output = argv[++i] ;
+        }
+        else {
+            usage(argv[0]) ;
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1 ;
+        }
+    }
+    if (size <= 0 || nb_threads < 0 || repeat <= 0 || nb_rays <= 0 || nb_passes <= 0) {
+        cerr << "Les paramètres doivent être positifs." << endl ;
+        return 1 ;
+    }
+    if (scenes.empty()) {
+        scenes = {"defaut", "spheres:1000", "spheres:10000"} ;
+    }
+
+    ostringstream sortie ;
+    sortie << "{\n  \"size\": " << size << ", \"threads\": " << ThreadPool(nb_threads).get_nb_threads()
+           << ", \"repeat\": " << repeat << ",\n  \"micro\": [" ;
+
+    // -- Micro-mesures, sur la scène de main.cpp et des rayons fixés
+    Scene scene ;
+    scene.set_nb_threads(nb_threads) ;
+    build_default_scene(size, &scene) ;
+    vector<Ray3f> primaires = primary_rays(scene, size, nb_rays) ;
+    vector<Ray3f> secondaires = random_rays(size, nb_rays) ;
+    vector<Ray3f> lignes = scanline_rays(scene, size, nb_rays) ;
+    // La première sphère et le cube de la scène
+    const Shape * sphere = scene.get_shapes().front() ;
+    const Shape * quad = scene.get_shapes().back() ;
+    bool premier = true ;
+
+    run_micro(sortie, premier, "Sphere::is_hit", primaires, repeat, [&](const Ray3f & ray, size_t) {
+        return sphere->is_hit(ray).t_ < 1E9f ? 1.0 : 0.0 ;
+    }) ;
+    run_micro(sortie, premier, "Quad::is_hit", primaires, repeat, [&](const Ray3f & ray, size_t) {
+        return quad->is_hit(ray).t_ < 1E9f ? 1.0 : 0.0 ;
+    }) ;
+    run_micro(sortie, premier, "Scene::intersection primary", primaires, repeat, [&](const Ray3f & ray, size_t) {
+        Vector3f P, N ;
+        int shape_id ;
+        float t ;
+        return scene.intersection(ray, &P, &N, &shape_id, &t) ? 1.0 : 0.0 ;
+    }) ;
+    run_micro(sortie, premier, "Scene::intersection random", secondaires, repeat, [&](const Ray3f & ray, size_t) {
+        Vector3f P, N ;
+        int shape_id ;
+        float t ;
+        return scene.intersection(ray, &P, &N, &shape_id, &t) ? 1.0 : 0.0 ;
+    }) ;
+    // Visibilité primaire, rayon par rayon puis par paquets, sur les mêmes rayons cohérents
+    run_micro(sortie, premier, "Scene::closest_hit scanline", lignes, repeat, [&](const Ray3f & ray, size_t) {
+        HitRecord hit = scene.closest_hit(ray) ;
+        return hit.hit() ? static_cast<double>(hit.t_) : 0.0 ;
+    }) ;
+    run_micro_packet(sortie, premier, "Scene::closest_hit_packet scanline", scene, lignes, repeat) ;
+    run_micro(sortie, premier, "Scene::get_color direct", primaires, repeat, [&](const Ray3f & ray, size_t) {
+        Material c = scene.get_color(ray, 5) ;
+        return static_cast<double>(c.get_r() + c.get_g() + c.get_b()) ;
+    }) ;
+    run_micro(sortie, premier, "Scene::get_color path", primaires, repeat, [&](const Ray3f & ray, size_t i) {
+        // Un générateur par rayon, initialisé de la même façon à chaque exécution
+        Rng rng(i) ;
+        Material c = scene.get_color(ray, 5, &rng) ;
+        return static_cast<double>(c.get_r() + c.get_g() + c.get_b()) ;
+    }) ;
+
+    // -- Bout en bout, une image complète par scène
+    sortie << "\n  ],\n  \"render\": [" ;
+    premier = true ;
+    for (size_t s = 0 ; s < scenes.size() ; s++) {
+        Scene rendu ;
+        rendu.set_nb_threads(nb_threads) ;
+        if (!build_scene(scenes[s], size, &rendu)) {
+            return 1 ;
+        }
+        for (int w = 0 ; w < 2 ; w++) {
+            end_to_end(sortie, premier, scenes[s], rendu, size, nb_threads, 0, repeat, w == 1) ;
+            end_to_end(sortie, premier, scenes[s], rendu, size, nb_threads, nb_passes, repeat, w == 1) ;
+        }
+    }
+    sortie << "\n  ]\n}\n" ;
+
+    if (output.empty()) {
+        cout << sortie.str() ;
+        return 0 ;
+    }
+    ofstream fichier(output) ;
+    if (!fichier) {
+        cerr << "Impossible d'ouvrir le fichier " << output << endl ;
+        return 1 ;
+    }
+    fichier << sortie.str() ;
+    return 0 ;
+}
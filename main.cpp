@@ -4,67 +4,194 @@
 #include "Material.h"
 #include "Shape.h"
 #include "Scene.h"
+#include "Scenes.h"
+#include "SceneCache.h"
+#include "RenderSettings.h"
+#include "RenderStats.h"
+#include "Viewer.h"
+#include "Trace.h"
 #include "Sphere.h"
 #include "Quad.h"
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <stdio.h>
+#include <string>
 
 using namespace std;
 
-// g++ -g -Wall -Wextra -o projet *.cpp `pkg-config --cflags --libs sdl2`
-// g++ -g -Wall -Wextra -fopenmp -o projet *.cpp `pkg-config --cflags --libs sdl2`
+// Avec la fenêtre SDL :
+// g++ -g -Wall -Wextra -pthread -o projet *.cpp `pkg-config --cflags --libs sdl2`
+// Sans la SDL, rendu hors-ligne uniquement :
+// g++ -O2 -Wall -Wextra -pthread -DNO_SDL -o projet *.cpp
 
-int main(int argc, char* argv[]) {
+// Affiche l'aide de la ligne de commande
+static void usage(const char* programme) {
+    cerr << "Utilisation : " << programme << " [options]" << endl
+         << "  --size N       côté de l'image en pixels (500 par défaut)" << endl
+         << "  --samples N    nombre de passes en mode path (1 par défaut), sans effet en mode direct" << endl
+         << "  --mode M       direct (éclairage direct seul) ou path (rendu progressif, éclairage indirect)" << endl
+         << "  --integrator I recursive (pixel par pixel) ou wavefront (par vagues de rayons), recursive par défaut" << endl
+         << "  --threshold E  en mode path, arrête une tuile quand son erreur passe sous E niveaux sur 255 (0 = jamais)" << endl
+         << "  --shadows N    nombre de rayons d'ombre par point éclairé, répartis sur les lumières (1 par défaut)" << endl
+         << "  --threads N    nombre de threads de calcul (0 = tous les coeurs, par défaut)" << endl
+         << "  --output F     fichier image produit, .bmp ou .ppm (rendu.bmp par défaut)" << endl
+         << "  --scene S      scène à afficher : defaut, spheres:N, foret:N, lumieres:N, un fichier .scene ou un cache .rtc (defaut par défaut)" << endl
+         << "  --cache F      enregistre la scène compilée dans le cache F (.rtc), à relire avec --scene F" << endl
+         << "  --trace F      enregistre une frise des étapes du calcul, par thread, dans le fichier JSON F (chrome://tracing)" << endl
+         << "  --stats        enregistre une carte de chaleur par statistique et affiche le bilan (compilé avec -DRT_STATS)" << endl
+         << "  --headless     calcule l'image et l'enregistre sans ouvrir de fenêtre" << endl
+         << "  --interactive  fenêtre où l'on déplace la caméra (flèches, Page haut/bas, souris), l'image se recalcule à chaque mouvement" << endl ;
+}
 
-    (void)argc ; 
-    (void)argv ;
+int main(int argc, char* argv[]) {
 
     int SIZE_WINDOW = 500 ;
+    RenderSettings settings ;
+    string scene_name = "defaut" ;
+    string cache ;
+    string trace ;
+    int nb_shadow_rays = 1 ;
+    bool stats = false ;
+#ifdef NO_SDL
+    bool headless = true ;
+#else
+    bool headless = false ;
+#endif
+
+    // Lecture des options de la ligne de commande
+    for (int i = 1 ; i < argc ; i++) {
+        bool has_value = i + 1 < argc ;
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true ;
+        }
+        else if (strcmp(argv[i], "--interactive") == 0) {
+            settings.interactive_ = true ;
+        }
+        else if (strcmp(argv[i], "--stats") == 0) {
+            stats = true ;
+        }
+        else if (strcmp(argv[i], "--size") == 0 && has_value) {
+            SIZE_WINDOW = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--samples") == 0 && has_value) {
+            settings.nb_samples_ = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--shadows") == 0 && has_value) {
+            nb_shadow_rays = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            settings.nb_threads_ = atoi(argv[++i]) ;
+        }
+        else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            settings.output_ = argv[++i] ;
+        }
+        else if (strcmp(argv[i], "--mode") == 0 && has_value) {
+            string mode = argv[++i] ;
+            if (mode != "direct" && mode != "path") {
+                cerr << "Mode inconnu : " << mode << endl ;
+                return 1 ;
+            }
+            settings.path_tracing_ = (mode == "path") ;
+        }
+        else if (strcmp(argv[i], "--integrator") == 0 && has_value) {
+            string integrator = argv[++i] ;
+            if (integrator != "recursive" && integrator != "wavefront") {
+                cerr << "Intégrateur inconnu : " << integrator << endl ;
+                return 1 ;
+            }
+            settings.wavefront_ = (integrator == "wavefront") ;
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && has_value) {
+            settings.threshold_ = static_cast<float>(atof(argv[++i])) ;
+        }
+        else if (strcmp(argv[i], "--scene") == 0 && has_value) {
+            scene_name = argv[++i] ;
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && has_value) {
+            cache = argv[++i] ;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && has_value) {
+            trace = argv[++i] ;
+        }
+        else {
+            usage(argv[0]) ;
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 1 ;
+        }
+    }
+
+    if (SIZE_WINDOW <= 0 || settings.nb_samples_ <= 0 || nb_shadow_rays <= 0 || settings.nb_threads_ < 0 || settings.threshold_ < 0.0f) {
+        cerr << "La taille et le nombre de rayons doivent être positifs." << endl ;
+        return 1 ;
+    }
+
+    settings.width_ = SIZE_WINDOW ;
+    settings.height_ = SIZE_WINDOW ;
+
+    if (settings.interactive_ && headless) {
+        cerr << "La visionneuse interactive a besoin d'une fenêtre (SDL) : elle ne va pas avec --headless." << endl ;
+        return 1 ;
+    }
+
+#ifdef RT_STATS
+    if (stats) {
+        get_render_stats().resize(settings.width_, settings.height_) ;
+    }
+#else
+    if (stats) {
+        cerr << "Les statistiques ne sont disponibles que si le programme est compilé avec -DRT_STATS." << endl ;
+        return 1 ;
+    }
+#endif
+
+    if (!trace.empty()) {
+        trace_start() ;
+    }
+
+    Scene scene ;
+    // Le chargement (lecture des maillages, construction des hiérarchies) prend autant de threads que le rendu
+    scene.set_nb_threads(settings.nb_threads_) ;
+    {
+        RT_TRACE("chargement de la scène") ;
+        if (!build_scene(scene_name, SIZE_WINDOW, &scene)) {
+            return 1 ;
+        }
+    }
+    scene.set_shadow_rays(nb_shadow_rays) ;
+    if (!cache.empty() && !SceneCache::save(scene, SIZE_WINDOW, cache)) {
+        return 1 ;
+    }
+
+    bool ok = true ;
+    if (headless) {
+        // Image produite et enregistrée, sans fenêtre
+        ok = scene.render_to_file(settings) ;
+    }
+#ifndef NO_SDL
+    else if (settings.interactive_) {
+        // Visionneuse : l'image se recalcule à chaque déplacement de la caméra
+        ok = Viewer(scene, settings).run() ;
+    }
+    else {
+        // Image produite et enregistrée
+        scene.render(settings);
+    }
+#endif
+
+#ifdef RT_STATS
+    if (stats) {
+        // Les cartes sont rangées à côté de l'image : rendu.bmp donne rendu_rayons.bmp, rendu_ombres.bmp...
+        size_t point = settings.output_.rfind('.') ;
+        string nom = (point == string::npos) ? settings.output_ : settings.output_.substr(0, point) ;
+        string extension = (point == string::npos) ? string(".ppm") : settings.output_.substr(point) ;
+        get_render_stats().save_heatmaps(nom, extension) ;
+        get_render_stats().report(cout) ;
+    }
+#endif
+
+    if (!trace.empty() && !trace_save(trace)) {
+        ok = false ;
+    }
 
-    cout << "Entrez la valeur d'un côté de la fenêtre voulue (entre 500 - 900 par exemple) : " << endl ;
-    cout << "Size : " ; 
-    cin >> SIZE_WINDOW ;
-
-    // Les proportions des objets dans l'espace ont été réfléchies dans un carré de dimension 900
-    // Pour connaitre les dimensions des objets dans un espace de taille différente, on applique un rapport
-    float rapport = SIZE_WINDOW / 900.0 ;
- 
-    vector<Shape*> shapes;
-
-    //-- Sphères
-    // 1ère sphère
-    Vector3f v(SIZE_WINDOW/3-25, SIZE_WINDOW/2, 60*rapport);
-    Material m(255.0f, 0.0f, 0.0f,0.0f);
-    shapes.push_back(new Sphere(m, v, 150.0f * rapport));
-    // 2ème sphère
-    Vector3f v2 (2*SIZE_WINDOW/3+25, SIZE_WINDOW/2, 400*rapport);
-    shapes.push_back(new Sphere(m, v2, 150.0f * rapport,true));
-
-    // Création des sphères qui vont représenter le sol, le plafond, le mur gauche, le mur droit, et le mur du fond
-    // On prend des sphères avec des rayons très grands, et donc ça fera comme des plans visuellement
-    int rayon_sph_murs = 6000 * rapport ;
-    shapes.push_back(new Sphere(Material(255.0f, 255.0f, 255.0f, 0.0f), Vector3f(SIZE_WINDOW / 2, rayon_sph_murs + SIZE_WINDOW - 60 * rapport, 0), rayon_sph_murs)); // sol
-    shapes.push_back(new Sphere(Material(255.0f, 0.0f, 0.0f, 0.0f), Vector3f(SIZE_WINDOW / 2, -rayon_sph_murs + 60 * rapport, 0), rayon_sph_murs)); // plafond
-    shapes.push_back(new Sphere(Material(0.0f,255.0f,0.0f, 0.0f), Vector3f(-rayon_sph_murs + 60 * rapport, SIZE_WINDOW / 2, 0), rayon_sph_murs)); // mur gauche
-    shapes.push_back(new Sphere(Material(0.0f,0.0f,255.0f, 0.0f), Vector3f(rayon_sph_murs + SIZE_WINDOW - 60 * rapport, SIZE_WINDOW / 2, 0), rayon_sph_murs)); // mur droit
-    shapes.push_back(new Sphere(Material(192.0f, 192.0f, 192.0f, 0.0f), Vector3f(SIZE_WINDOW / 2, SIZE_WINDOW / 2, rayon_sph_murs + 500 * rapport), rayon_sph_murs)); // mur fond
-
-    // -- Cube
-    Material m_cube(255.0f, 255.0f, 0.0f,0.0f);
-    Vector3f A(700.0f*rapport, 700.0f*rapport, 20.0f*rapport) ;
-    Vector3f B(100.0f*rapport, 0.0f, 0.0f) ;
-    Vector3f C(0.0f, 700.0f*rapport, 0.0f) ;
-    shapes.push_back(new Quad(m_cube, A, B, C));
-
-    // La caméra est placé à z = -1000*rapport
-    // De ce fait, elle a assez de recul : la sphère n'est pas déformée
-    Camera camera = Camera(Vector3f(SIZE_WINDOW/2,SIZE_WINDOW/2,-1000*rapport),Vector3f(0,0,-1));
-	Ray3f source = Ray3f(Vector3f(SIZE_WINDOW / 2.0, 100.0f*rapport, 0.0f*rapport),Vector3f(0,1,0));
-
-    Scene scene(camera,shapes,source);
-
-    // Image produite et enregistrée
-    scene.render(SIZE_WINDOW, SIZE_WINDOW, "Ma Fenêtre SDL");
-
-    return 0;
-}
\ No newline at end of file
+    return ok ? 0 : 1 ;
+}